@@ -14,7 +14,7 @@
 #include "modules/TorchLoader.h"
 
 Application::Application()
-    : running(true), name("Image Editor")
+    : running(true), name("Image Editor"), job_event(0)
 {
     this->AddModule(this->input = new Input());
     this->AddModule(this->window = new Window("Image Editor", 1024, 768));
@@ -46,6 +46,8 @@ void Application::Run()
 
 void Application::Start()
 {
+    this->job_event = SDL_RegisterEvents(1);
+
     for (auto item = this->modules.begin(); item != this->modules.end(); ++item)
     {
         (*item)->Start();
@@ -73,8 +75,17 @@ void Application::Update()
 
     Uint64 end = SDL_GetPerformanceCounter();
 
-    float elapsed_ms = (end - start) / (float)SDL_GetPerformanceFrequency();
-    SDL_Delay(floor(16.666f - elapsed_ms));
+    float elapsed_ms = (end - start) * 1000.0f / SDL_GetPerformanceFrequency();
+
+    if (this->renderer->IsIdle() && this->input->IsMouseIdle())
+    {
+        /* Nothing left to draw, sleep until an event or a finished job arrives */
+        SDL_WaitEventTimeout(nullptr, APPLICATION_IDLE_TIMEOUT_MS);
+    }
+    else if (elapsed_ms < APPLICATION_FRAME_MS)
+    {
+        SDL_Delay((Uint32)(APPLICATION_FRAME_MS - elapsed_ms));
+    }
 }
 
 void Application::CleanUp()
@@ -90,6 +101,17 @@ void Application::RequestBrowser(const std::string& url) const
     ShellExecuteA(0, "open", url.c_str(), 0, 0, SW_SHOWNORMAL);
 }
 
+void Application::PostJobDone(const JOB& job) const
+{
+    SDL_Event e;
+    SDL_zero(e);
+
+    e.type = this->job_event;
+    e.user.code = (Sint32)job;
+
+    SDL_PushEvent(&e);
+}
+
 void Application::AddModule(Module* module)
 {
     this->modules.push_back(module);
@@ -4,6 +4,10 @@
 #include <iostream>
 #include <list>
 
+#define APPLICATION_FRAME_MS 16.666f
+/* Upper bound of an idle wait, a lost wake up only delays the next frame */
+#define APPLICATION_IDLE_TIMEOUT_MS 500
+
 class Module;
 class Window;
 class Renderer;
@@ -12,6 +16,12 @@ class Input;
 class Editor;
 class TorchLoader;
 
+/* Background work that hands its result back to the main thread */
+enum class JOB
+{
+    SUPER_RESOLUTION = 0
+};
+
 class Application
 {
 public:
@@ -26,6 +36,9 @@ public:
 
     void RequestBrowser(const std::string& url) const;
 
+    /* Safe from any thread, wakes the main loop and hands the job to the editor on the next frame */
+    void PostJobDone(const JOB& job) const;
+
 private:
     void AddModule(Module* module);
 
@@ -40,6 +53,8 @@ public:
     bool running;
     std::string name;
 
+    unsigned int job_event;
+
 private:
     std::list<Module*> modules;
 };
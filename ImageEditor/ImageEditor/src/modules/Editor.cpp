@@ -1,9 +1,22 @@
+#include <algorithm>
+#include <cmath>
+
 #include "SDL_image.h"
 #include "imgui.h"
 #include "portable-file-dialogs.h"
 
 #include "tools/ImageLoader.h"
+#include "tools/BrushEngine.h"
 #include "tools/Filters.h"
+#include "tools/Transform.h"
+#include "tools/ColorSpace.h"
+#include "tools/DistanceTransform.h"
+#include "tools/SeamCarving.h"
+#include "tools/Inpaint.h"
+#include "tools/ColorQuantization.h"
+#include "tools/ExpressionFilter.h"
+#include "tools/HistogramMatching.h"
+#include "tools/SpanRasterizer.h"
 #include "utils/Utils.h"
 #include "Application.h"
 #include "Editor.h"
@@ -14,7 +27,7 @@
 #include "TorchLoader.h"
 
 Editor::Editor()
-	: Module(), bg(nullptr)
+	: Module()
 {
 
 }
@@ -31,19 +44,54 @@ void Editor::Start()
 
 	this->preferences_panel = false;
 	this->anomaly_viewer_panel = false;
+	this->color_adjustment_panel = false;
+	this->domain_transform_panel = false;
+	this->local_laplacian_panel = false;
+	this->layers_panel = false;
 	this->load_hdr_image_popup = false;
 	this->super_resolution_popup = false;
 	this->style_transfer_popup = false;
+	this->unsharp_mask_popup = false;
+	this->high_boost_popup = false;
+	this->distance_transform_popup = false;
+	this->content_aware_resize_popup = false;
+	this->posterize_popup = false;
+	this->reduce_colors_popup = false;
+	this->expression_filter_popup = false;
+	this->match_histogram_popup = false;
+	this->wiener_popup = false;
+	this->lee_popup = false;
 
 	this->anomaly_viewer_texture = nullptr;
+
+	this->layers.Reset(App->window->width, App->window->height, 0xFFFFFFFF);
+	this->history_memory_limit = HISTORY_MEMORY_LIMIT_MB;
+	this->history.SetMemoryLimit((size_t)this->history_memory_limit << 20);
+	this->bg_rect = { 0, 0, App->window->width, App->window->height };
+	this->zoom = 1.0f;
+	this->shape_start = { 0, 0 };
+
+	this->color_adjustment_params = ColorAdjustment::DefaultParams();
+	this->brush_params = BrushEngine::DefaultParams();
+	this->fill_params = FloodFill::DefaultParams();
+	this->domain_transform_params = DomainTransform::DefaultParams();
+	this->local_laplacian_params = LocalLaplacian::DefaultParams();
+
+	this->component_params = { 128, 4, false, CONNECTIVITY::EIGHT };
+	this->components_from_canvas = false;
+
+	this->inpaint_region = { 0, 0, 0, 0 };
+	this->inpaint_mask_width = 0;
+	this->inpaint_radius = INPAINT_RADIUS;
+
+	this->super_resolution_process = nullptr;
+	this->super_resolution_running = false;
 }
 
 void Editor::Update()
 {
 	App->input->GetMousePosition(this->mouse_position_x, this->mouse_position_y);
 
-	App->renderer->SetRenderTarget(App->renderer->texture_target);
-
 	App->renderer->SetRenderDrawColor(
 		this->tools.GetColor().x,
 		this->tools.GetColor().y,
@@ -51,135 +99,197 @@ void Editor::Update()
 		this->tools.GetColor().w
 	);
 
-	switch (this->tools.current_tool)
+	/* The canvas only shows a partial result while a preview is running */
+	if (!this->preview.IsActive())
 	{
-		case TOOLS::STANDARD_BRUSH:
+		switch (this->tools.current_tool)
 		{
-			this->UseStandardBrush();
+			case TOOLS::STANDARD_BRUSH:
+			{
+				this->UseStandardBrush();
 
-			break;
-		}
-		case TOOLS::RUBBER:
-		{
-			this->UseRubber(SDL_BUTTON_LEFT);
+				break;
+			}
+			case TOOLS::RUBBER:
+			{
+				this->UseRubber(SDL_BUTTON_LEFT);
 
-			break;
-		}
-		case TOOLS::CIRCLE_BRUSH:
-		{
-			this->UseCirleBrush();
+				break;
+			}
+			case TOOLS::CIRCLE_BRUSH:
+			{
+				this->UseCirleBrush();
 
-			break;
-		}
-		case TOOLS::CIRCLE_BRUSH_FILL:
-		{
-			this->UseCirleBrushFill();
+				break;
+			}
+			case TOOLS::CIRCLE_BRUSH_FILL:
+			{
+				this->UseCirleBrushFill();
 
-			break;
-		}
-		case TOOLS::RECTANGLE_BRUSH:
-		{
-			this->UseRectangleBrush();
+				break;
+			}
+			case TOOLS::RECTANGLE_BRUSH:
+			{
+				this->UseRectangleBrush();
 
-			break;
-		}
-		case TOOLS::RECTANGLE_BRUSH_FILL:
-		{
-			this->UseRectangleBrushFill();
+				break;
+			}
+			case TOOLS::RECTANGLE_BRUSH_FILL:
+			{
+				this->UseRectangleBrushFill();
 
-			break;
-		}
-		case TOOLS::LINE:
-		{
-			this->UseLine();
+				break;
+			}
+			case TOOLS::LINE:
+			{
+				this->UseLine();
 
-			break;
-		}
-		case TOOLS::ELLIPSE:
-		{
-			this->UseEllipse();
+				break;
+			}
+			case TOOLS::ELLIPSE:
+			{
+				this->UseEllipse();
 
-			break;
-		}
-		case TOOLS::ELLIPSE_FILL:
-		{
-			this->UseEllipseFill();
+				break;
+			}
+			case TOOLS::ELLIPSE_FILL:
+			{
+				this->UseEllipseFill();
 
-			break;
-		}
-		case TOOLS::RECTANGLE:
-		{
-			this->UseRectangle();
+				break;
+			}
+			case TOOLS::RECTANGLE:
+			{
+				this->UseRectangle();
 
-			break;
-		}
-		case TOOLS::RECTANGLE_FILL:
-		{
-			this->UseRectangleFill();
+				break;
+			}
+			case TOOLS::RECTANGLE_FILL:
+			{
+				this->UseRectangleFill();
 
-			break;
-		}
-		default:
-		{
-			break;
+				break;
+			}
+			case TOOLS::INPAINT:
+			{
+				this->UseInpaint();
+
+				break;
+			}
+			case TOOLS::BUCKET_FILL:
+			{
+				this->UseBucketFill();
+
+				break;
+			}
+			default:
+			{
+				break;
+			}
 		}
+
+		this->UseRubber(SDL_BUTTON_RIGHT);
 	}
 
-	this->UseRubber(SDL_BUTTON_RIGHT);
-	
-	if (this->bg != nullptr)
-	{
-		static SDL_Point mouse_to_bg_initial_distance = { 0, 0 };
+	this->PanCanvas();
 
-		if (App->input->GetMouseButton(SDL_BUTTON_MIDDLE) == KEY_STATE::KEY_DOWN)
-		{
-			int mouse_position_x, mouse_position_y;
-			App->input->GetMousePosition(mouse_position_x, mouse_position_y);
+	if (App->input->GetMouseWheel() != 0)
+	{
+		this->SetZoom(this->zoom * std::pow(CANVAS_ZOOM_STEP, (float)App->input->GetMouseWheel()), this->mouse_position_x, this->mouse_position_y);
+	}
 
-			mouse_to_bg_initial_distance = {
-				mouse_position_x - this->bg_rect.x,
-				mouse_position_y - this->bg_rect.y
-			};
-		}
+	/* A stroke becomes one step once every button is up, a preview once it is applied or cancelled */
+	KEY_STATE left = App->input->GetMouseButton(SDL_BUTTON_LEFT);
+	KEY_STATE right = App->input->GetMouseButton(SDL_BUTTON_RIGHT);
 
-		if (App->input->GetMouseButton(SDL_BUTTON_MIDDLE) == KEY_STATE::KEY_REPEAT)
-		{
-			int mouse_position_x, mouse_position_y;
-			App->input->GetMousePosition(mouse_position_x, mouse_position_y);
+	bool drawing = left == KEY_STATE::KEY_DOWN || left == KEY_STATE::KEY_REPEAT || right == KEY_STATE::KEY_DOWN || right == KEY_STATE::KEY_REPEAT;
 
-			this->bg_rect = {
-				mouse_position_x - mouse_to_bg_initial_distance.x,
-				mouse_position_y - mouse_to_bg_initial_distance.y,
-				this->bg_rect.w, this->bg_rect.h
-			};
-		}
+	if (!this->preview.IsActive() && !drawing)
+	{
+		this->history.Commit(this->layers);
 	}
-	
-	App->renderer->SetRenderTarget(nullptr);
 
 	this->last_frame_mouse_position_x = this->mouse_position_x;
 	this->last_frame_mouse_position_y = this->mouse_position_y;
 }
 
+void Editor::PanCanvas()
+{
+	static SDL_Point mouse_to_bg_initial_distance = { 0, 0 };
+
+	if (App->input->GetMouseButton(SDL_BUTTON_MIDDLE) == KEY_STATE::KEY_DOWN)
+	{
+		int mouse_position_x, mouse_position_y;
+		App->input->GetMousePosition(mouse_position_x, mouse_position_y);
+
+		mouse_to_bg_initial_distance = {
+			mouse_position_x - this->bg_rect.x,
+			mouse_position_y - this->bg_rect.y
+		};
+	}
+
+	if (App->input->GetMouseButton(SDL_BUTTON_MIDDLE) == KEY_STATE::KEY_REPEAT)
+	{
+		int mouse_position_x, mouse_position_y;
+		App->input->GetMousePosition(mouse_position_x, mouse_position_y);
+
+		this->bg_rect = {
+			mouse_position_x - mouse_to_bg_initial_distance.x,
+			mouse_position_y - mouse_to_bg_initial_distance.y,
+			this->bg_rect.w, this->bg_rect.h
+		};
+	}
+}
+
 void Editor::CleanUp()
 {
+	if (this->super_resolution_running)
+	{
+		TerminateProcess((HANDLE)this->super_resolution_process, 1);
+
+		this->super_resolution_worker.join();
+		CloseHandle((HANDLE)this->super_resolution_process);
+	}
+
 	SDL_DestroyTexture(this->anomaly_viewer_texture);
-	SDL_DestroyTexture(this->bg);
+
+	this->history.Clear(this->layers);
+	this->layers.Clear();
 }
 
 void Editor::DrawGUI()
 {
+	this->Shortcuts();
 	this->MainMenuBar();
 	this->ToolSelection();
 	this->Panels();
 	this->PopUps();
+
+	this->DrawInpaintMask();
+}
+
+void Editor::OnJobDone(const JOB& job)
+{
+	switch (job)
+	{
+		case JOB::SUPER_RESOLUTION:
+		{
+			this->FinishSuperResolution();
+
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
 }
 
 void Editor::MainMenuBar()
 {
 	if (ImGui::BeginMainMenuBar())
 	{
-		if (ImGui::BeginMenu("File"))
+		if (ImGui::BeginMenu("File", !this->preview.IsActive()))
 		{
 			if (ImGui::MenuItem("Load image"))
 			{
@@ -192,8 +302,7 @@ void Editor::MainMenuBar()
 					std::string path = selection[0];
 					printf("User loaded file %s\n", path.c_str());
 
-					this->bg = this->LoadImg(path);
-					this->RenderImg(this->bg, App->renderer->texture_target);
+					this->LoadImg(path);
 				}
 			}
 
@@ -203,7 +312,7 @@ void Editor::MainMenuBar()
 					{ "Image Files", "*.png *.jpg *.bmp" },
 					pfd::opt::force_overwrite).result();
 
-				this->SaveImg(App->renderer->texture_target, destination);
+				this->SaveImg(destination);
 				printf("User saved file %s\n", destination.c_str());
 			}
 
@@ -215,35 +324,137 @@ void Editor::MainMenuBar()
 			ImGui::EndMenu();
 		}
 
-		if (ImGui::BeginMenu("Image"))
+		if (ImGui::BeginMenu("Edit", !this->preview.IsActive()))
+		{
+			if (ImGui::MenuItem("Undo", "Ctrl+Z", false, this->history.CanUndo()))
+			{
+				this->Undo();
+			}
+
+			if (ImGui::MenuItem("Redo", "Ctrl+Y", false, this->history.CanRedo()))
+			{
+				this->Redo();
+			}
+
+			ImGui::EndMenu();
+		}
+
+		if (ImGui::BeginMenu("Image", !this->preview.IsActive()))
 		{
+			if (ImGui::BeginMenu("Transform"))
+			{
+				if (ImGui::MenuItem("Rotate 90"))
+				{
+					Transform::ApplyTransform(TRANSFORM_TYPE::ROTATE_90);
+				}
+
+				if (ImGui::MenuItem("Rotate 180"))
+				{
+					Transform::ApplyTransform(TRANSFORM_TYPE::ROTATE_180);
+				}
+
+				if (ImGui::MenuItem("Rotate 270"))
+				{
+					Transform::ApplyTransform(TRANSFORM_TYPE::ROTATE_270);
+				}
+
+				ImGui::Separator();
+
+				if (ImGui::MenuItem("Flip Horizontal"))
+				{
+					Transform::ApplyTransform(TRANSFORM_TYPE::FLIP_HORIZONTAL);
+				}
+
+				if (ImGui::MenuItem("Flip Vertical"))
+				{
+					Transform::ApplyTransform(TRANSFORM_TYPE::FLIP_VERTICAL);
+				}
+
+				if (ImGui::MenuItem("Transpose"))
+				{
+					Transform::ApplyTransform(TRANSFORM_TYPE::TRANSPOSE);
+				}
+
+				ImGui::EndMenu();
+			}
+
+			if (ImGui::MenuItem("Content-Aware Resize"))
+			{
+				this->content_aware_resize_popup = true;
+			}
+
+			if (ImGui::MenuItem("Posterize"))
+			{
+				this->posterize_popup = true;
+			}
+
+			if (ImGui::MenuItem("Reduce Colors"))
+			{
+				this->reduce_colors_popup = true;
+			}
+
+			if (ImGui::MenuItem("Match Histogram"))
+			{
+				this->match_histogram_popup = true;
+			}
+
+			if (ImGui::BeginMenu("Adjustments"))
+			{
+				if (ImGui::MenuItem("Color Adjustment"))
+				{
+					this->color_adjustment_params = ColorAdjustment::DefaultParams();
+					this->color_adjustment_panel = true;
+
+					this->preview.Begin();
+				}
+
+				ImGui::EndMenu();
+			}
+
 			if (ImGui::BeginMenu("Filters"))
 			{
 				if (ImGui::MenuItem("Grayscale"))
 				{
-					Filters::ApplyGrayScale(App->renderer->texture_target, App->renderer->texture_filter);
+					Filters::ApplyGrayScale();
 				}
 
 				if (ImGui::MenuItem("Blur"))
 				{
-					Filters::ApplyBlur(App->renderer->texture_target, App->renderer->texture_filter, 3);
+					Filters::ApplyBlur(3);
 				}
 
 				if (ImGui::MenuItem("Gaussian Blur"))
 				{
-					Filters::ApplyGaussianBlur(App->renderer->texture_target, App->renderer->texture_filter, 5);
+					Filters::ApplyGaussianBlur(5);
 				}
 
 				if (ImGui::MenuItem("Negative"))
 				{
-					Filters::ApplyNegative(App->renderer->texture_target, App->renderer->texture_filter);
+					Filters::ApplyNegative();
 				}
 
 				if (ImGui::MenuItem("Laplace Operator"))
 				{
-					Filters::ApplyLaplace(App->renderer->texture_target, App->renderer->texture_filter);
+					Filters::ApplyLaplace();
+				}
+
+				if (ImGui::MenuItem("Expression"))
+				{
+					this->expression_filter_popup = true;
+				}
+
+				if (ImGui::MenuItem("Edge-Preserving Smoothing"))
+				{
+					this->domain_transform_params = DomainTransform::DefaultParams();
+					this->domain_transform_panel = true;
+
+					this->preview.Begin();
 				}
 
+				ImGui::Separator();
+
+				ImGui::MenuItem("Linear Light", nullptr, &Filters::params.LINEAR_LIGHT);
+
 				ImGui::EndMenu();
 			}
 
@@ -253,7 +464,17 @@ void Editor::MainMenuBar()
 				{
 					if (ImGui::MenuItem("Median Blur"))
 					{
-						Filters::ApplyMedianBlur(App->renderer->texture_target, App->renderer->texture_filter, 5);
+						Filters::ApplyMedianBlur(5);
+					}
+
+					if (ImGui::MenuItem("Wiener"))
+					{
+						this->wiener_popup = true;
+					}
+
+					if (ImGui::MenuItem("Lee"))
+					{
+						this->lee_popup = true;
 					}
 
 					ImGui::EndMenu();
@@ -263,17 +484,58 @@ void Editor::MainMenuBar()
 				{
 					if (ImGui::MenuItem("Laplace"))
 					{
-						Filters::ApplyLaplaceEnhancement(App->renderer->texture_target, App->renderer->texture_filter);
+						Filters::ApplyLaplaceEnhancement();
+					}
+
+					if (ImGui::MenuItem("Local Laplacian"))
+					{
+						this->local_laplacian_params = LocalLaplacian::DefaultParams();
+						this->local_laplacian_panel = true;
+
+						this->preview.Begin();
+					}
+
+					ImGui::EndMenu();
+				}
+
+				if (ImGui::BeginMenu("Sharpen"))
+				{
+					if (ImGui::MenuItem("Unsharp Mask"))
+					{
+						this->unsharp_mask_popup = true;
+					}
+
+					if (ImGui::MenuItem("High-Boost"))
+					{
+						this->high_boost_popup = true;
 					}
 
 					ImGui::EndMenu();
 				}
 
-				if (ImGui::MenuItem("Super Resolution"))
+				if (ImGui::MenuItem("Super Resolution", nullptr, false, !this->super_resolution_running))
 				{
 					this->super_resolution_popup = true;
 				}
 
+				ImGui::Separator();
+
+				ImGui::MenuItem("Luma Only", nullptr, &Filters::params.LUMA_ONLY);
+				if (ImGui::IsItemHovered())
+				{
+					ImGui::SetTooltip("Denoise, Laplace and Sharpen work on the YCbCr luma channel only, leaving chroma untouched");
+				}
+
+				ImGui::EndMenu();
+			}
+
+			if (ImGui::BeginMenu("Analysis"))
+			{
+				if (ImGui::MenuItem("Distance Transform"))
+				{
+					this->distance_transform_popup = true;
+				}
+
 				ImGui::EndMenu();
 			}
 
@@ -297,6 +559,33 @@ void Editor::MainMenuBar()
 
 		if (ImGui::BeginMenu("View"))
 		{
+			if (ImGui::MenuItem("Zoom In"))
+			{
+				this->SetZoom(this->zoom * CANVAS_ZOOM_STEP, App->window->width / 2, App->window->height / 2);
+			}
+
+			if (ImGui::MenuItem("Zoom Out"))
+			{
+				this->SetZoom(this->zoom / CANVAS_ZOOM_STEP, App->window->width / 2, App->window->height / 2);
+			}
+
+			if (ImGui::MenuItem("Actual Size"))
+			{
+				this->SetZoom(1.0f, App->window->width / 2, App->window->height / 2);
+			}
+
+			if (ImGui::MenuItem("Fit to Window"))
+			{
+				this->FitCanvasToWindow();
+			}
+
+			ImGui::Separator();
+
+			if (ImGui::MenuItem("Layers"))
+			{
+				this->layers_panel = true;
+			}
+
 			if (ImGui::MenuItem("Anomaly Viewer"))
 			{
 				this->anomaly_viewer_panel = true;
@@ -329,11 +618,36 @@ void Editor::MainMenuBar()
 	}
 }
 
+void Editor::Shortcuts()
+{
+	ImGuiIO& io = ImGui::GetIO();
+
+	/* Text fields keep Ctrl+Z for themselves, previews own the canvas until they end */
+	if (!io.KeyCtrl || io.WantTextInput || this->preview.IsActive())
+		return;
+
+	if (ImGui::IsKeyPressed(ImGuiKey_Z))
+	{
+		if (io.KeyShift)
+		{
+			this->Redo();
+		}
+		else
+		{
+			this->Undo();
+		}
+	}
+	else if (ImGui::IsKeyPressed(ImGuiKey_Y))
+	{
+		this->Redo();
+	}
+}
+
 void Editor::ToolSelection()
 {
 	ImGui::Begin("Tools");
 
-	static const char* items[11] = {
+	static const char* items[13] = {
 		"Standard Brush",
 		"Rubber",
 		"Circle Brush",
@@ -344,17 +658,44 @@ void Editor::ToolSelection()
 		"Ellipse",
 		"Ellipse Fill",
 		"Rectangle",
-		"Rectangle Fill"
+		"Rectangle Fill",
+		"Inpaint",
+		"Bucket Fill"
 	};
 
 	ImGui::Combo("Tool", (int*)&this->tools.current_tool, items, IM_ARRAYSIZE(items));
 	ImGui::ColorEdit4("Color", (float*)&this->tools.GetColorReference());
 	ImGui::SliderInt("Size", &this->tools.tool_size, 1, 100, "%d", ImGuiSliderFlags_AlwaysClamp);
 
-	ImGui::End();
-}
+	if (this->tools.current_tool == TOOLS::STANDARD_BRUSH)
+	{
+		ImGui::SliderFloat("Spacing", &this->brush_params.SPACING, 0.01f, 1.0f, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+		ImGui::SameLine(); App->gui->HelpMarker("Distance between stamps as a fraction of the brush size. Default: 0.1");
+		ImGui::SliderFloat("Hardness", &this->brush_params.HARDNESS, 0.0f, 1.0f, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+		ImGui::SameLine(); App->gui->HelpMarker("Part of the radius painted at full strength, the rest fades out. Default: 1");
+		ImGui::SliderFloat("Flow", &this->brush_params.FLOW, 0.01f, 1.0f, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+		ImGui::SameLine(); App->gui->HelpMarker("Opacity of a single stamp, overlapping stamps build up. Default: 1");
+	}
 
-void Editor::Panels()
+	if (this->tools.current_tool == TOOLS::INPAINT)
+	{
+		ImGui::SliderInt("Inpaint Radius", &this->inpaint_radius, 1, 20, "%d", ImGuiSliderFlags_AlwaysClamp);
+	}
+
+	if (this->tools.current_tool == TOOLS::BUCKET_FILL)
+	{
+		static const char* connectivities[] = { "4-connected", "8-connected" };
+
+		ImGui::SliderInt("Tolerance", &this->fill_params.TOLERANCE, 0, 255, "%d", ImGuiSliderFlags_AlwaysClamp);
+		ImGui::SameLine(); App->gui->HelpMarker("Largest difference in any channel from the clicked pixel that is still filled. Default: 32");
+		ImGui::Combo("Connectivity", (int*)&this->fill_params.CONNECTIVITY_TYPE, connectivities, IM_ARRAYSIZE(connectivities));
+		ImGui::SameLine(); App->gui->HelpMarker("8-connected fills also leak through diagonal gaps. Default: 4-connected");
+	}
+
+	ImGui::End();
+}
+
+void Editor::Panels()
 {
 	if (this->preferences_panel)
 	{
@@ -377,14 +718,26 @@ void Editor::Panels()
 				App->gui->SetUIStyle(item);
 			}
 
+			ImGui::Text("History");
+
+			ImGui::Separator();
+
+			if (ImGui::SliderInt("Undo Memory (MB)", &this->history_memory_limit, 64, 4096, "%d", ImGuiSliderFlags_AlwaysClamp))
+			{
+				this->history.SetMemoryLimit((size_t)this->history_memory_limit << 20);
+			}
+			ImGui::SameLine(); App->gui->HelpMarker("Changed tiles kept for undo and redo, the oldest steps are dropped first. Default: 512");
+
+			ImGui::Text("In use: %.1f MB", this->history.GetMemoryUsage() / (1024.0f * 1024.0f));
+
 			ImGui::End();
 		}
 	}
 
 	if (this->anomaly_viewer_panel)
 	{
-		ImGui::SetNextWindowSize(ImVec2(216, 238));
-		if (ImGui::Begin("Anomaly Viewer", &this->anomaly_viewer_panel, ImGuiWindowFlags_NoResize))
+		ImGui::SetNextWindowSize(ImVec2(420, 560), ImGuiCond_FirstUseEver);
+		if (ImGui::Begin("Anomaly Viewer", &this->anomaly_viewer_panel))
 		{
 			if (this->anomaly_viewer_texture)
 			{
@@ -395,13 +748,331 @@ void Editor::Panels()
 				App->renderer->SetRenderTarget(nullptr);
 
 				ImGui::Image(App->renderer->texture_anomaly_viewer_target, ImVec2(200, 200));
+
+				if (!this->components_from_canvas)
+				{
+					ImVec2 origin = ImGui::GetItemRectMin();
+					float scale_x = 200.0f / this->layers.GetWidth();
+					float scale_y = 200.0f / this->layers.GetHeight();
+
+					for (const ComponentStats& component : this->components)
+					{
+						ImGui::GetWindowDrawList()->AddRect(
+							ImVec2(origin.x + component.bbox.x * scale_x, origin.y + component.bbox.y * scale_y),
+							ImVec2(origin.x + (component.bbox.x + component.bbox.w) * scale_x, origin.y + (component.bbox.y + component.bbox.h) * scale_y),
+							IM_COL32(0, 255, 255, 255)
+						);
+					}
+				}
 			}
 			else
 			{
 				ImGui::Text("No anomaly detection has been executed");
 			}
 
-			ImGui::End();
+			ImGui::Separator();
+
+			ImGui::Text("Connected Components");
+			ImGui::SameLine(); App->gui->HelpMarker("Labels the thresholded anomaly map, or any mask thresholded from the canvas luma");
+
+			bool changed = false;
+
+			static const char* sources[] = { "Anomaly Map", "Canvas" };
+			static const char* connectivities[] = { "4-connected", "8-connected" };
+
+			int source = (int)this->components_from_canvas;
+			if (ImGui::Combo("Source", &source, sources, IM_ARRAYSIZE(sources)))
+			{
+				this->components_from_canvas = source == 1;
+				changed = true;
+			}
+
+			changed |= ImGui::SliderInt("Threshold", &this->component_params.THRESHOLD, 0, 255, "%d", ImGuiSliderFlags_AlwaysClamp);
+			changed |= ImGui::DragInt("Min Area", &this->component_params.MIN_AREA, 1.0f, 1, 100000);
+			changed |= ImGui::Combo("Connectivity", (int*)&this->component_params.CONNECTIVITY_TYPE, connectivities, IM_ARRAYSIZE(connectivities));
+			changed |= ImGui::Checkbox("Invert", &this->component_params.INVERT);
+
+			if (ImGui::Button("Analyze", ImVec2(100, 0)) || changed)
+			{
+				this->FindComponents();
+			}
+
+			ImGui::SameLine();
+			ImGui::Text("%d components", (int)this->components.size());
+
+			static ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY;
+
+			if (ImGui::BeginTable("##Components", 5, flags, ImVec2(0, 220)))
+			{
+				ImGui::TableSetupScrollFreeze(0, 1);
+				ImGui::TableSetupColumn("#");
+				ImGui::TableSetupColumn("Area");
+				ImGui::TableSetupColumn("Position");
+				ImGui::TableSetupColumn("Size");
+				ImGui::TableSetupColumn("Centroid");
+				ImGui::TableHeadersRow();
+
+				ImGuiListClipper clipper;
+				clipper.Begin((int)this->components.size());
+
+				while (clipper.Step())
+				{
+					for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+					{
+						const ComponentStats& component = this->components[i];
+
+						ImGui::TableNextRow();
+						ImGui::TableNextColumn(); ImGui::Text("%d", component.label);
+						ImGui::TableNextColumn(); ImGui::Text("%d", component.area);
+						ImGui::TableNextColumn(); ImGui::Text("%d, %d", component.bbox.x, component.bbox.y);
+						ImGui::TableNextColumn(); ImGui::Text("%d x %d", component.bbox.w, component.bbox.h);
+						ImGui::TableNextColumn(); ImGui::Text("%.1f, %.1f", component.centroid_x, component.centroid_y);
+					}
+				}
+
+				ImGui::EndTable();
+			}
+		}
+		ImGui::End();
+	}
+
+	if (this->layers_panel)
+	{
+		ImGui::SetNextWindowSize(ImVec2(260, 320), ImGuiCond_FirstUseEver);
+		if (ImGui::Begin("Layers", &this->layers_panel))
+		{
+			/* Filter previews write into the active layer, it cannot change under them */
+			ImGui::BeginDisabled(this->preview.IsActive());
+
+			Layer& current = this->layers.layers[this->layers.active];
+			bool changed = false;
+
+			static const char* modes[] = { "Normal", "Multiply", "Screen", "Overlay", "Add" };
+
+			changed |= ImGui::Combo("Blend", (int*)&current.blend_mode, modes, IM_ARRAYSIZE(modes));
+			changed |= ImGui::SliderFloat("Opacity", &current.opacity, 0.0f, 1.0f, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+
+			ImGui::Separator();
+
+			/* Listed top to bottom, as they are stacked */
+			for (int i = (int)this->layers.layers.size() - 1; i >= 0; --i)
+			{
+				Layer& layer = this->layers.layers[i];
+
+				ImGui::PushID(i);
+
+				changed |= ImGui::Checkbox("##Visible", &layer.visible);
+				ImGui::SameLine();
+				if (ImGui::Selectable(layer.name.c_str(), i == this->layers.active))
+				{
+					this->layers.active = i;
+				}
+
+				ImGui::PopID();
+			}
+
+			ImGui::Separator();
+
+			if (ImGui::Button("Add"))
+			{
+				this->layers.AddLayer();
+			}
+
+			ImGui::SameLine();
+			if (ImGui::Button("Remove"))
+			{
+				this->layers.RemoveLayer(this->layers.active);
+			}
+
+			ImGui::SameLine();
+			if (ImGui::Button("Up"))
+			{
+				this->layers.MoveLayer(this->layers.active, 1);
+			}
+
+			ImGui::SameLine();
+			if (ImGui::Button("Down"))
+			{
+				this->layers.MoveLayer(this->layers.active, -1);
+			}
+
+			if (changed)
+			{
+				this->layers.InvalidateComposite();
+			}
+
+			ImGui::EndDisabled();
+		}
+		ImGui::End();
+	}
+
+	if (this->color_adjustment_panel)
+	{
+		ImGui::SetNextWindowSize(ImVec2(340, 0), ImGuiCond_Appearing);
+		if (ImGui::Begin("Color Adjustment", &this->color_adjustment_panel))
+		{
+			ColorAdjustmentParams& params = this->color_adjustment_params;
+			bool changed = false;
+
+			static const char* models[] = { "HSV", "HSL" };
+
+			changed |= ImGui::Combo("Model", (int*)&params.MODEL, models, IM_ARRAYSIZE(models));
+			changed |= ImGui::SliderFloat("Hue", &params.HUE, -180.0f, 180.0f, "%.0f", ImGuiSliderFlags_AlwaysClamp);
+			changed |= ImGui::SliderFloat("Saturation", &params.SATURATION, -100.0f, 100.0f, "%.0f", ImGuiSliderFlags_AlwaysClamp);
+			changed |= ImGui::SliderFloat(params.MODEL == COLOR_MODEL::HSV ? "Value###Lightness" : "Lightness###Lightness", &params.LIGHTNESS, -100.0f, 100.0f, "%.0f", ImGuiSliderFlags_AlwaysClamp);
+
+			ImGui::Separator();
+
+			ImGui::Text("White Balance");
+			ImGui::SameLine(); App->gui->HelpMarker("Shifts the Lab chroma axes. Temperature moves blue-yellow, tint moves green-magenta");
+
+			changed |= ImGui::SliderFloat("Temperature", &params.TEMPERATURE, -100.0f, 100.0f, "%.0f", ImGuiSliderFlags_AlwaysClamp);
+			changed |= ImGui::SliderFloat("Tint", &params.TINT, -100.0f, 100.0f, "%.0f", ImGuiSliderFlags_AlwaysClamp);
+
+			ImGui::Separator();
+
+			PreviewFunction function = [&params](const Uint32* src, const ptrdiff_t& src_stride, Uint32* dst, const ptrdiff_t& dst_stride, const int& width, const int& height)
+			{
+				ColorAdjustment::Apply(src, src_stride, dst, dst_stride, width, height, params);
+			};
+
+			if (ImGui::Button("Apply", ImVec2(100, 0)))
+			{
+				this->preview.Commit(function);
+				this->color_adjustment_panel = false;
+			}
+
+			ImGui::SameLine();
+			if (ImGui::Button("Reset", ImVec2(100, 0)))
+			{
+				params = ColorAdjustment::DefaultParams();
+				changed = true;
+			}
+
+			ImGui::SameLine();
+			if (ImGui::Button("Cancel", ImVec2(100, 0)))
+			{
+				this->color_adjustment_panel = false;
+			}
+
+			this->preview.Update(function, changed);
+		}
+		ImGui::End();
+
+		if (!this->color_adjustment_panel)
+		{
+			this->preview.Cancel();
+		}
+	}
+
+	if (this->domain_transform_panel)
+	{
+		ImGui::SetNextWindowSize(ImVec2(340, 0), ImGuiCond_Appearing);
+		if (ImGui::Begin("Edge-Preserving Smoothing", &this->domain_transform_panel))
+		{
+			DomainTransformParams& params = this->domain_transform_params;
+			bool changed = false;
+
+			changed |= ImGui::SliderFloat("Spatial Sigma", &params.SIGMA_SPATIAL, 1.0f, 200.0f, "%.0f px", ImGuiSliderFlags_AlwaysClamp);
+			ImGui::SameLine(); App->gui->HelpMarker("Size of the smoothed areas. Default: 60");
+
+			changed |= ImGui::SliderFloat("Range Sigma", &params.SIGMA_RANGE, 0.01f, 2.0f, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+			ImGui::SameLine(); App->gui->HelpMarker("Color difference kept as an edge, lower values preserve more detail. Default: 0.4");
+
+			changed |= ImGui::SliderInt("Iterations", &params.ITERATIONS, 1, 5, "%d", ImGuiSliderFlags_AlwaysClamp);
+
+			ImGui::Separator();
+
+			PreviewFunction function = [&params](const Uint32* src, const ptrdiff_t& src_stride, Uint32* dst, const ptrdiff_t& dst_stride, const int& width, const int& height)
+			{
+				DomainTransform::Apply(src, src_stride, dst, dst_stride, width, height, params);
+			};
+
+			if (ImGui::Button("Apply", ImVec2(100, 0)))
+			{
+				this->preview.Commit(function);
+				this->domain_transform_panel = false;
+			}
+
+			ImGui::SameLine();
+			if (ImGui::Button("Reset", ImVec2(100, 0)))
+			{
+				params = DomainTransform::DefaultParams();
+				changed = true;
+			}
+
+			ImGui::SameLine();
+			if (ImGui::Button("Cancel", ImVec2(100, 0)))
+			{
+				this->domain_transform_panel = false;
+			}
+
+			this->preview.Update(function, changed);
+		}
+		ImGui::End();
+
+		if (!this->domain_transform_panel)
+		{
+			this->preview.Cancel();
+		}
+	}
+
+	if (this->local_laplacian_panel)
+	{
+		ImGui::SetNextWindowSize(ImVec2(340, 0), ImGuiCond_Appearing);
+		if (ImGui::Begin("Local Laplacian", &this->local_laplacian_panel))
+		{
+			LocalLaplacianParams& params = this->local_laplacian_params;
+			bool changed = false;
+
+			changed |= ImGui::SliderFloat("Detail", &params.DETAIL, -100.0f, 100.0f, "%.0f", ImGuiSliderFlags_AlwaysClamp);
+			ImGui::SameLine(); App->gui->HelpMarker("Boosts or smooths the small variations around every pixel. Default: 0");
+
+			changed |= ImGui::SliderFloat("Tone", &params.TONE, -100.0f, 100.0f, "%.0f", ImGuiSliderFlags_AlwaysClamp);
+			ImGui::SameLine(); App->gui->HelpMarker("Compresses or expands the large edges, without halos. Default: 0");
+
+			changed |= ImGui::SliderFloat("Edge", &params.EDGE, 0.01f, 0.5f, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+			ImGui::SameLine(); App->gui->HelpMarker("Luma difference that separates detail from edges. Default: 0.1");
+
+			ImGui::Separator();
+
+			/* Slider changes are previewed on a proxy of the visible region, Apply runs at full resolution */
+			PreviewFunction proxy = [&params](const Uint32* src, const ptrdiff_t& src_stride, Uint32* dst, const ptrdiff_t& dst_stride, const int& width, const int& height)
+			{
+				LocalLaplacian::ApplyProxy(src, src_stride, dst, dst_stride, width, height, params, LOCAL_LAPLACIAN_PROXY_PIXELS);
+			};
+
+			PreviewFunction function = [&params](const Uint32* src, const ptrdiff_t& src_stride, Uint32* dst, const ptrdiff_t& dst_stride, const int& width, const int& height)
+			{
+				LocalLaplacian::Apply(src, src_stride, dst, dst_stride, width, height, params);
+			};
+
+			if (ImGui::Button("Apply", ImVec2(100, 0)))
+			{
+				this->preview.Commit(function);
+				this->local_laplacian_panel = false;
+			}
+
+			ImGui::SameLine();
+			if (ImGui::Button("Reset", ImVec2(100, 0)))
+			{
+				params = LocalLaplacian::DefaultParams();
+				changed = true;
+			}
+
+			ImGui::SameLine();
+			if (ImGui::Button("Cancel", ImVec2(100, 0)))
+			{
+				this->local_laplacian_panel = false;
+			}
+
+			this->preview.Update(proxy, changed);
+		}
+		ImGui::End();
+
+		if (!this->local_laplacian_panel)
+		{
+			this->preview.Cancel();
 		}
 	}
 }
@@ -677,136 +1348,672 @@ void Editor::PopUps()
 			ImGui::EndPopup();
 		}
 	}
-}
 
-void Editor::UseStandardBrush()
-{
-	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_DOWN
-		|| App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_REPEAT)
+	if (this->unsharp_mask_popup)
 	{
-		App->renderer->DrawLine(
-			this->last_frame_mouse_position_x - this->bg_rect.x, this->last_frame_mouse_position_y - this->bg_rect.y,
-			this->mouse_position_x - this->bg_rect.x, this->mouse_position_y - this->bg_rect.y,
-			this->tools.tool_size,
-			this->tools.GetColor()
-		);
-	}
-}
+		ImGui::OpenPopup("Unsharp Mask");
 
-void Editor::UseRubber(const int& button)
-{
-	if (App->input->GetMouseButton(button) == KEY_STATE::KEY_DOWN
-		|| App->input->GetMouseButton(button) == KEY_STATE::KEY_REPEAT)
-	{
-		App->renderer->DrawCircleFill(
-			mouse_position_x - this->bg_rect.x, mouse_position_y - this->bg_rect.y,
-			this->tools.tool_size,
-			ImVec4(255, 255, 255, 255)
-		);
-	}
-}
+		ImVec2 center = ImGui::GetMainViewport()->GetCenter();
+		ImGui::SetNextWindowPos(center, ImGuiCond_Appearing, ImVec2(0.5f, 0.5f));
 
-void Editor::UseCirleBrush()
-{
-	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_DOWN
-		|| App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_REPEAT)
-	{
-		App->renderer->DrawCircle(
-			mouse_position_x - this->bg_rect.x, mouse_position_y - this->bg_rect.y,
-			this->tools.tool_size,
-			this->tools.GetColor()
-		);
-	}
-}
+		if (ImGui::BeginPopupModal("Unsharp Mask", NULL, ImGuiWindowFlags_AlwaysAutoResize))
+		{
+			ImGui::Text("Options");
 
-void Editor::UseCirleBrushFill()
-{
-	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_DOWN
-		|| App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_REPEAT)
-	{
-		App->renderer->DrawCircleFill(
-			mouse_position_x - this->bg_rect.x, mouse_position_y - this->bg_rect.y,
-			this->tools.tool_size,
-			this->tools.GetColor()
-		);
-	}
-}
+			ImGui::Separator();
 
-void Editor::UseRectangleBrush()
-{
-	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_DOWN
-		|| App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_REPEAT)
-	{
-		App->renderer->DrawRectangle(
-			mouse_position_x - this->tools.tool_size / 2 - this->bg_rect.x, mouse_position_y - this->tools.tool_size / 2 - this->bg_rect.y,
-			this->tools.tool_size, this->tools.tool_size,
-			this->tools.GetColor()
-		);
-	}
-}
+			static float amount = 100.0f;
+			static float radius = 2.0f;
+			static int threshold = 0;
 
-void Editor::UseRectangleBrushFill()
-{
-	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_DOWN
-		|| App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_REPEAT)
-	{
-		App->renderer->DrawRectangleFill(
-			mouse_position_x - this->tools.tool_size / 2 - this->bg_rect.x, mouse_position_y - this->tools.tool_size / 2 - this->bg_rect.y,
-			this->tools.tool_size, this->tools.tool_size,
-			this->tools.GetColor()
-		);
-	}
-}
+			ImGui::SliderFloat("Amount", &amount, 0.0f, 500.0f, "%.0f%%", ImGuiSliderFlags_AlwaysClamp);
+			ImGui::SameLine(); App->gui->HelpMarker("Strength of the added detail. Default: 100%");
+			ImGui::SliderFloat("Radius", &radius, 0.5f, 50.0f, "%.1f px", ImGuiSliderFlags_AlwaysClamp);
+			ImGui::SameLine(); App->gui->HelpMarker("Standard deviation of the blur. Default: 2");
+			ImGui::SliderInt("Threshold", &threshold, 0, 255, "%d", ImGuiSliderFlags_AlwaysClamp);
+			ImGui::SameLine(); App->gui->HelpMarker("Differences below this level are left untouched. Default: 0");
 
-void Editor::UseLine()
-{
-	static SDL_Point initial_mouse_position = { 0, 0 };
-	static SDL_Point final_mouse_position = { 0, 0 };
+			ImGui::Separator();
 
-	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_DOWN)
-	{
-		int mouse_position_x, mouse_position_y;
-		App->input->GetMousePosition(mouse_position_x, mouse_position_y);
+			if (ImGui::Button("OK", ImVec2(100, 0)))
+			{
+				Filters::ApplyUnsharpMask(amount, radius, threshold);
 
-		initial_mouse_position = {
-			mouse_position_x,
-			mouse_position_y
-		};
-	}
+				this->unsharp_mask_popup = false;
 
-	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_UP)
-	{
-		int mouse_position_x, mouse_position_y;
-		App->input->GetMousePosition(mouse_position_x, mouse_position_y);
+				ImGui::CloseCurrentPopup();
+			}
 
-		final_mouse_position = {
-			mouse_position_x,
-			mouse_position_y
-		};
+			ImGui::SetItemDefaultFocus();
+			ImGui::SameLine();
+			if (ImGui::Button("Cancel", ImVec2(100, 0)))
+			{
+				this->unsharp_mask_popup = false;
 
-		App->renderer->DrawLine(
-			initial_mouse_position.x - this->bg_rect.x, initial_mouse_position.y - this->bg_rect.y,
-			final_mouse_position.x - this->bg_rect.x, final_mouse_position.y - this->bg_rect.y,
-			this->tools.tool_size,
-			this->tools.GetColor()
+				ImGui::CloseCurrentPopup();
+			}
+
+			ImGui::EndPopup();
+		}
+	}
+
+	if (this->high_boost_popup)
+	{
+		ImGui::OpenPopup("High-Boost");
+
+		ImVec2 center = ImGui::GetMainViewport()->GetCenter();
+		ImGui::SetNextWindowPos(center, ImGuiCond_Appearing, ImVec2(0.5f, 0.5f));
+
+		if (ImGui::BeginPopupModal("High-Boost", NULL, ImGuiWindowFlags_AlwaysAutoResize))
+		{
+			ImGui::Text("Options");
+
+			ImGui::Separator();
+
+			static float boost = 1.2f;
+			static float radius = 2.0f;
+
+			ImGui::SliderFloat("Boost", &boost, 1.0f, 3.0f, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+			ImGui::SameLine(); App->gui->HelpMarker("Result is A * image - blur. A = 1 keeps only the high-pass detail. Default: 1.2");
+			ImGui::SliderFloat("Radius", &radius, 0.5f, 50.0f, "%.1f px", ImGuiSliderFlags_AlwaysClamp);
+			ImGui::SameLine(); App->gui->HelpMarker("Standard deviation of the blur. Default: 2");
+
+			ImGui::Separator();
+
+			if (ImGui::Button("OK", ImVec2(100, 0)))
+			{
+				Filters::ApplyHighBoost(boost, radius);
+
+				this->high_boost_popup = false;
+
+				ImGui::CloseCurrentPopup();
+			}
+
+			ImGui::SetItemDefaultFocus();
+			ImGui::SameLine();
+			if (ImGui::Button("Cancel", ImVec2(100, 0)))
+			{
+				this->high_boost_popup = false;
+
+				ImGui::CloseCurrentPopup();
+			}
+
+			ImGui::EndPopup();
+		}
+	}
+
+	if (this->distance_transform_popup)
+	{
+		ImGui::OpenPopup("Distance Transform");
+
+		ImVec2 center = ImGui::GetMainViewport()->GetCenter();
+		ImGui::SetNextWindowPos(center, ImGuiCond_Appearing, ImVec2(0.5f, 0.5f));
+
+		if (ImGui::BeginPopupModal("Distance Transform", NULL, ImGuiWindowFlags_AlwaysAutoResize))
+		{
+			ImGui::Text("Mask");
+
+			ImGui::Separator();
+
+			static int threshold = 128;
+			static bool invert = true;
+			static float max_distance = 0.0f;
+
+			ImGui::SliderInt("Threshold", &threshold, 0, 255, "%d", ImGuiSliderFlags_AlwaysClamp);
+			ImGui::SameLine(); App->gui->HelpMarker("Pixels whose luma is at or above the threshold belong to the mask");
+			ImGui::Checkbox("Invert", &invert);
+			ImGui::SameLine(); App->gui->HelpMarker("Use the pixels below the threshold instead, e.g. dark strokes on a white canvas. Default: on");
+			ImGui::DragFloat("Max Distance", &max_distance, 1.0f, 0.0f, 10000.0f, "%.0f px");
+			ImGui::SameLine(); App->gui->HelpMarker("Distance mapped to white. Default: 0, meaning the largest distance in the image");
+
+			ImGui::Separator();
+
+			if (ImGui::Button("OK", ImVec2(100, 0)))
+			{
+				this->ApplyDistanceTransform(threshold, invert, max_distance);
+
+				this->distance_transform_popup = false;
+
+				ImGui::CloseCurrentPopup();
+			}
+
+			ImGui::SetItemDefaultFocus();
+			ImGui::SameLine();
+			if (ImGui::Button("Cancel", ImVec2(100, 0)))
+			{
+				this->distance_transform_popup = false;
+
+				ImGui::CloseCurrentPopup();
+			}
+
+			ImGui::EndPopup();
+		}
+	}
+
+	if (this->content_aware_resize_popup)
+	{
+		ImGui::OpenPopup("Content-Aware Resize");
+
+		ImVec2 center = ImGui::GetMainViewport()->GetCenter();
+		ImGui::SetNextWindowPos(center, ImGuiCond_Appearing, ImVec2(0.5f, 0.5f));
+
+		if (ImGui::BeginPopupModal("Content-Aware Resize", NULL, ImGuiWindowFlags_AlwaysAutoResize))
+		{
+			ImGui::Text("Target size");
+
+			ImGui::Separator();
+
+			static int target_width = 0;
+			static int target_height = 0;
+
+			if (ImGui::IsWindowAppearing())
+			{
+				target_width = this->layers.GetWidth();
+				target_height = this->layers.GetHeight();
+			}
+
+			ImGui::SliderInt("Width", &target_width, 1, this->layers.GetWidth(), "%d", ImGuiSliderFlags_AlwaysClamp);
+			ImGui::SliderInt("Height", &target_height, 1, this->layers.GetHeight(), "%d", ImGuiSliderFlags_AlwaysClamp);
+			ImGui::SameLine(); App->gui->HelpMarker("Seam carving removes the least noticeable paths of pixels. The image can only shrink");
+
+			ImGui::Separator();
+
+			if (ImGui::Button("OK", ImVec2(100, 0)))
+			{
+				SeamCarving::ApplyContentAwareResize(target_width, target_height);
+
+				this->content_aware_resize_popup = false;
+
+				ImGui::CloseCurrentPopup();
+			}
+
+			ImGui::SetItemDefaultFocus();
+			ImGui::SameLine();
+			if (ImGui::Button("Cancel", ImVec2(100, 0)))
+			{
+				this->content_aware_resize_popup = false;
+
+				ImGui::CloseCurrentPopup();
+			}
+
+			ImGui::EndPopup();
+		}
+	}
+
+	if (this->posterize_popup)
+	{
+		ImGui::OpenPopup("Posterize");
+
+		ImVec2 center = ImGui::GetMainViewport()->GetCenter();
+		ImGui::SetNextWindowPos(center, ImGuiCond_Appearing, ImVec2(0.5f, 0.5f));
+
+		if (ImGui::BeginPopupModal("Posterize", NULL, ImGuiWindowFlags_AlwaysAutoResize))
+		{
+			ImGui::Text("Options");
+
+			ImGui::Separator();
+
+			static int levels = 4;
+
+			ImGui::SliderInt("Levels", &levels, 2, 32, "%d", ImGuiSliderFlags_AlwaysClamp);
+			ImGui::SameLine(); App->gui->HelpMarker("Number of evenly spaced values kept per channel. Default: 4");
+
+			ImGui::Separator();
+
+			if (ImGui::Button("OK", ImVec2(100, 0)))
+			{
+				ColorQuantization::ApplyPosterize(levels);
+
+				this->posterize_popup = false;
+
+				ImGui::CloseCurrentPopup();
+			}
+
+			ImGui::SetItemDefaultFocus();
+			ImGui::SameLine();
+			if (ImGui::Button("Cancel", ImVec2(100, 0)))
+			{
+				this->posterize_popup = false;
+
+				ImGui::CloseCurrentPopup();
+			}
+
+			ImGui::EndPopup();
+		}
+	}
+
+	if (this->reduce_colors_popup)
+	{
+		ImGui::OpenPopup("Reduce Colors");
+
+		ImVec2 center = ImGui::GetMainViewport()->GetCenter();
+		ImGui::SetNextWindowPos(center, ImGuiCond_Appearing, ImVec2(0.5f, 0.5f));
+
+		if (ImGui::BeginPopupModal("Reduce Colors", NULL, ImGuiWindowFlags_AlwaysAutoResize))
+		{
+			ImGui::Text("Options");
+
+			ImGui::Separator();
+
+			static int colors = 16;
+			static int iterations = 4;
+
+			ImGui::SliderInt("Colors", &colors, 2, COLOR_QUANTIZATION_MAX_COLORS, "%d", ImGuiSliderFlags_AlwaysClamp);
+			ImGui::SameLine(); App->gui->HelpMarker("Maximum palette size. Default: 16");
+
+			ImGui::SliderInt("K-Means Iterations", &iterations, 0, 16, "%d", ImGuiSliderFlags_AlwaysClamp);
+			ImGui::SameLine(); App->gui->HelpMarker("Refinement passes over the octree palette, 0 keeps the octree colors. Default: 4");
+
+			ImGui::Separator();
+
+			if (ImGui::Button("OK", ImVec2(100, 0)))
+			{
+				ColorQuantization::ApplyReduceColors(colors, iterations);
+
+				this->reduce_colors_popup = false;
+
+				ImGui::CloseCurrentPopup();
+			}
+
+			ImGui::SetItemDefaultFocus();
+			ImGui::SameLine();
+			if (ImGui::Button("Cancel", ImVec2(100, 0)))
+			{
+				this->reduce_colors_popup = false;
+
+				ImGui::CloseCurrentPopup();
+			}
+
+			ImGui::EndPopup();
+		}
+	}
+
+	if (this->expression_filter_popup)
+	{
+		ImGui::OpenPopup("Expression Filter");
+
+		ImVec2 center = ImGui::GetMainViewport()->GetCenter();
+		ImGui::SetNextWindowPos(center, ImGuiCond_Appearing, ImVec2(0.5f, 0.5f));
+
+		if (ImGui::BeginPopupModal("Expression Filter", NULL, ImGuiWindowFlags_AlwaysAutoResize))
+		{
+			ImGui::Text("Expression");
+
+			ImGui::Separator();
+
+			static char expression[1024] = "r = 255 - r; g = 255 - g; b = 255 - b";
+			static std::string error;
+
+			ImGui::InputTextMultiline("##expression", expression, IM_ARRAYSIZE(expression), ImVec2(400, ImGui::GetTextLineHeight() * 6));
+			ImGui::SameLine(); App->gui->HelpMarker(
+				"Statements run in order for every pixel, separated by ';' or new lines.\n"
+				"r, g, b and a hold the channels in [0, 255], x, y, w and h are read-only.\n"
+				"Operators: + - * / < <= > >= == != ?:\n"
+				"Functions: min, max, clamp, abs, sqrt, floor"
+			);
+
+			if (!error.empty())
+			{
+				ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", error.c_str());
+			}
+
+			ImGui::Separator();
+
+			if (ImGui::Button("OK", ImVec2(100, 0)))
+			{
+				if (ExpressionFilter::ApplyExpression(expression, error))
+				{
+					error.clear();
+
+					this->expression_filter_popup = false;
+
+					ImGui::CloseCurrentPopup();
+				}
+			}
+
+			ImGui::SetItemDefaultFocus();
+			ImGui::SameLine();
+			if (ImGui::Button("Cancel", ImVec2(100, 0)))
+			{
+				error.clear();
+
+				this->expression_filter_popup = false;
+
+				ImGui::CloseCurrentPopup();
+			}
+
+			ImGui::EndPopup();
+		}
+	}
+
+	if (this->match_histogram_popup)
+	{
+		ImGui::OpenPopup("Match Histogram");
+
+		ImVec2 center = ImGui::GetMainViewport()->GetCenter();
+		ImGui::SetNextWindowPos(center, ImGuiCond_Appearing, ImVec2(0.5f, 0.5f));
+
+		if (ImGui::BeginPopupModal("Match Histogram", NULL, ImGuiWindowFlags_AlwaysAutoResize))
+		{
+			ImGui::Text("Setup");
+
+			ImGui::Separator();
+
+			static char reference_image_path[MAX_PATH];
+			static HISTOGRAM_MATCHING_MODE mode = HISTOGRAM_MATCHING_MODE::RGB;
+			static std::string error;
+
+			ImGui::InputTextWithHint("##ReferenceImage", "Reference image path", reference_image_path, IM_ARRAYSIZE(reference_image_path));
+			ImGui::SameLine();
+			if (ImGui::Button("...##ReferenceImageButton"))
+			{
+				auto selection = pfd::open_file("Select a file", ".",
+					{ "Image Files", "*.png *.jpg *.bmp" })
+					.result();
+
+				if (!selection.empty())
+				{
+					std::string res = selection[0];
+					strcpy_s(reference_image_path, res.c_str());
+				}
+			}
+			ImGui::SameLine();
+			ImGui::Text("Reference path");
+
+			static const char* modes[] = { "RGB", "Luma" };
+
+			ImGui::Combo("Mode", (int*)&mode, modes, IM_ARRAYSIZE(modes));
+			ImGui::SameLine(); App->gui->HelpMarker("RGB matches every channel on its own. Luma matches the YCbCr luma only and keeps the colors");
+
+			if (!error.empty())
+			{
+				ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", error.c_str());
+			}
+
+			ImGui::Separator();
+
+			if (ImGui::Button("OK", ImVec2(100, 0)))
+			{
+				if (HistogramMatching::ApplyMatchHistogram(reference_image_path, mode))
+				{
+					error.clear();
+
+					this->match_histogram_popup = false;
+
+					ImGui::CloseCurrentPopup();
+				}
+				else
+				{
+					error = "The reference image can't be read";
+				}
+			}
+
+			ImGui::SetItemDefaultFocus();
+			ImGui::SameLine();
+			if (ImGui::Button("Cancel", ImVec2(100, 0)))
+			{
+				error.clear();
+
+				this->match_histogram_popup = false;
+
+				ImGui::CloseCurrentPopup();
+			}
+
+			ImGui::EndPopup();
+		}
+	}
+
+	if (this->wiener_popup)
+	{
+		ImGui::OpenPopup("Wiener");
+
+		ImVec2 center = ImGui::GetMainViewport()->GetCenter();
+		ImGui::SetNextWindowPos(center, ImGuiCond_Appearing, ImVec2(0.5f, 0.5f));
+
+		if (ImGui::BeginPopupModal("Wiener", NULL, ImGuiWindowFlags_AlwaysAutoResize))
+		{
+			ImGui::Text("Options");
+
+			ImGui::Separator();
+
+			static int window_size = 5;
+			static float noise_variance = 0.0f;
+
+			if (ImGui::SliderInt("Window Size", &window_size, 3, 51, "%d px", ImGuiSliderFlags_AlwaysClamp))
+			{
+				window_size |= 1;
+			}
+			ImGui::SameLine(); App->gui->HelpMarker("Side of the square window the local mean and variance are measured over. The cost does not depend on it. Default: 5");
+			ImGui::SliderFloat("Noise Variance", &noise_variance, 0.0f, 1000.0f, "%.1f", ImGuiSliderFlags_AlwaysClamp);
+			ImGui::SameLine(); App->gui->HelpMarker("Variance of the noise in squared 8-bit levels. 0 estimates it as the mean local variance. Default: 0");
+
+			ImGui::Separator();
+
+			if (ImGui::Button("OK", ImVec2(100, 0)))
+			{
+				Filters::ApplyWienerFilter(window_size, noise_variance);
+
+				this->wiener_popup = false;
+
+				ImGui::CloseCurrentPopup();
+			}
+
+			ImGui::SetItemDefaultFocus();
+			ImGui::SameLine();
+			if (ImGui::Button("Cancel", ImVec2(100, 0)))
+			{
+				this->wiener_popup = false;
+
+				ImGui::CloseCurrentPopup();
+			}
+
+			ImGui::EndPopup();
+		}
+	}
+
+	if (this->lee_popup)
+	{
+		ImGui::OpenPopup("Lee");
+
+		ImVec2 center = ImGui::GetMainViewport()->GetCenter();
+		ImGui::SetNextWindowPos(center, ImGuiCond_Appearing, ImVec2(0.5f, 0.5f));
+
+		if (ImGui::BeginPopupModal("Lee", NULL, ImGuiWindowFlags_AlwaysAutoResize))
+		{
+			ImGui::Text("Options");
+
+			ImGui::Separator();
+
+			static int window_size = 5;
+			static float noise_level = 0.25f;
+
+			if (ImGui::SliderInt("Window Size", &window_size, 3, 51, "%d px", ImGuiSliderFlags_AlwaysClamp))
+			{
+				window_size |= 1;
+			}
+			ImGui::SameLine(); App->gui->HelpMarker("Side of the square window the local mean and variance are measured over. The cost does not depend on it. Default: 5");
+			ImGui::SliderFloat("Noise Level", &noise_level, 0.01f, 1.0f, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+			ImGui::SameLine(); App->gui->HelpMarker("Deviation of the multiplicative speckle relative to the local mean. Default: 0.25");
+
+			ImGui::Separator();
+
+			if (ImGui::Button("OK", ImVec2(100, 0)))
+			{
+				Filters::ApplyLeeFilter(window_size, noise_level);
+
+				this->lee_popup = false;
+
+				ImGui::CloseCurrentPopup();
+			}
+
+			ImGui::SetItemDefaultFocus();
+			ImGui::SameLine();
+			if (ImGui::Button("Cancel", ImVec2(100, 0)))
+			{
+				this->lee_popup = false;
+
+				ImGui::CloseCurrentPopup();
+			}
+
+			ImGui::EndPopup();
+		}
+	}
+}
+
+void Editor::UseStandardBrush()
+{
+	KEY_STATE state = App->input->GetMouseButton(SDL_BUTTON_LEFT);
+
+	float x = (this->mouse_position_x - this->bg_rect.x) / this->zoom;
+	float y = (this->mouse_position_y - this->bg_rect.y) / this->zoom;
+
+	if (state == KEY_STATE::KEY_DOWN)
+	{
+		this->brush.BeginStroke(this->layers.GetActive(), x, y, this->tools.tool_size, this->tools.GetColorPixel(), this->brush_params);
+	}
+	else if (state == KEY_STATE::KEY_REPEAT)
+	{
+		this->brush.StrokeTo(this->layers.GetActive(), x, y);
+	}
+	else if (this->brush.IsStroking())
+	{
+		this->brush.EndStroke();
+	}
+}
+
+void Editor::UseRubber(const int& button)
+{
+	if (App->input->GetMouseButton(button) == KEY_STATE::KEY_DOWN
+		|| App->input->GetMouseButton(button) == KEY_STATE::KEY_REPEAT)
+	{
+		int x, y;
+		this->ScreenToCanvas(mouse_position_x, mouse_position_y, x, y);
+
+		SpanRasterizer::Circle(x, y, this->tools.tool_size, this->brush_spans);
+		this->layers.GetActive().FillSpans(this->brush_spans, this->layers.GetActive().GetBackground());
+	}
+}
+
+void Editor::UseCirleBrush()
+{
+	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_DOWN
+		|| App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_REPEAT)
+	{
+		int x, y;
+		this->ScreenToCanvas(mouse_position_x, mouse_position_y, x, y);
+
+		this->layers.GetActive().Draw(this->GetCanvasBounds(x, y, x, y, this->tools.tool_size + 1), [&](const int& origin_x, const int& origin_y)
+		{
+			App->renderer->DrawCircle(
+				x - origin_x, y - origin_y,
+				this->tools.tool_size,
+				this->tools.GetColor()
+			);
+		});
+	}
+}
+
+void Editor::UseCirleBrushFill()
+{
+	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_DOWN
+		|| App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_REPEAT)
+	{
+		int x, y;
+		this->ScreenToCanvas(mouse_position_x, mouse_position_y, x, y);
+
+		SpanRasterizer::Circle(x, y, this->tools.tool_size, this->brush_spans);
+		this->layers.GetActive().FillSpans(this->brush_spans, this->tools.GetColorPixel());
+	}
+}
+
+void Editor::UseRectangleBrush()
+{
+	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_DOWN
+		|| App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_REPEAT)
+	{
+		int x, y;
+		this->ScreenToCanvas(mouse_position_x, mouse_position_y, x, y);
+
+		x -= this->tools.tool_size / 2;
+		y -= this->tools.tool_size / 2;
+
+		this->layers.GetActive().Draw(this->GetCanvasBounds(x, y, x + this->tools.tool_size, y + this->tools.tool_size, 1), [&](const int& origin_x, const int& origin_y)
+		{
+			App->renderer->DrawRectangle(
+				x - origin_x, y - origin_y,
+				this->tools.tool_size, this->tools.tool_size,
+				this->tools.GetColor()
+			);
+		});
+	}
+}
+
+void Editor::UseRectangleBrushFill()
+{
+	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_DOWN
+		|| App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_REPEAT)
+	{
+		int x, y;
+		this->ScreenToCanvas(mouse_position_x, mouse_position_y, x, y);
+
+		x -= this->tools.tool_size / 2;
+		y -= this->tools.tool_size / 2;
+
+		this->layers.GetActive().Draw(this->GetCanvasBounds(x, y, x + this->tools.tool_size, y + this->tools.tool_size, 1), [&](const int& origin_x, const int& origin_y)
+		{
+			App->renderer->DrawRectangleFill(
+				x - origin_x, y - origin_y,
+				this->tools.tool_size, this->tools.tool_size,
+				this->tools.GetColor()
+			);
+		});
+	}
+}
+
+void Editor::UseLine()
+{
+	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_DOWN)
+	{
+		int mouse_position_x, mouse_position_y;
+		App->input->GetMousePosition(mouse_position_x, mouse_position_y);
+
+		this->ScreenToCanvas(mouse_position_x, mouse_position_y, this->shape_start.x, this->shape_start.y);
+	}
+
+	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_UP)
+	{
+		int mouse_position_x, mouse_position_y;
+		App->input->GetMousePosition(mouse_position_x, mouse_position_y);
+
+		SDL_Point final_mouse_position;
+		this->ScreenToCanvas(mouse_position_x, mouse_position_y, final_mouse_position.x, final_mouse_position.y);
+
+		SDL_Rect bounds = this->GetCanvasBounds(
+			this->shape_start.x, this->shape_start.y,
+			final_mouse_position.x, final_mouse_position.y,
+			this->tools.tool_size
 		);
+
+		this->layers.GetActive().Draw(bounds, [&](const int& origin_x, const int& origin_y)
+		{
+			App->renderer->DrawLine(
+				this->shape_start.x - origin_x, this->shape_start.y - origin_y,
+				final_mouse_position.x - origin_x, final_mouse_position.y - origin_y,
+				this->tools.tool_size,
+				this->tools.GetColor()
+			);
+		});
 	}
 }
 
 void Editor::UseEllipse()
 {
-	static SDL_Point initial_mouse_position = { 0, 0 };
-	static SDL_Point final_mouse_position = { 0, 0 };
-
 	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_DOWN)
 	{
 		int mouse_position_x, mouse_position_y;
 		App->input->GetMousePosition(mouse_position_x, mouse_position_y);
 
-		initial_mouse_position = {
-			mouse_position_x,
-			mouse_position_y
-		};
+		this->ScreenToCanvas(mouse_position_x, mouse_position_y, this->shape_start.x, this->shape_start.y);
 	}
 
 	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_UP)
@@ -814,43 +2021,40 @@ void Editor::UseEllipse()
 		int mouse_position_x, mouse_position_y;
 		App->input->GetMousePosition(mouse_position_x, mouse_position_y);
 
-		final_mouse_position = {
-			mouse_position_x,
-			mouse_position_y
-		};
+		SDL_Point final_mouse_position;
+		this->ScreenToCanvas(mouse_position_x, mouse_position_y, final_mouse_position.x, final_mouse_position.y);
 
 		SDL_Point mid_point = {
-			(final_mouse_position.x - initial_mouse_position.x) / 2 + initial_mouse_position.x,
-			(final_mouse_position.y - initial_mouse_position.y) / 2 + initial_mouse_position.y
+			(final_mouse_position.x - this->shape_start.x) / 2 + this->shape_start.x,
+			(final_mouse_position.y - this->shape_start.y) / 2 + this->shape_start.y
 		};
 
 		SDL_Point radius = {
-			abs((final_mouse_position.x - initial_mouse_position.x) / 2),
-			abs((final_mouse_position.y - initial_mouse_position.y) / 2)
+			abs((final_mouse_position.x - this->shape_start.x) / 2),
+			abs((final_mouse_position.y - this->shape_start.y) / 2)
 		};
 
-		App->renderer->DrawEllipse(
-			mid_point.x - this->bg_rect.x, mid_point.y - this->bg_rect.y,
-			radius.x, radius.y,
-			this->tools.GetColor()
-		);
+		SDL_Rect bounds = this->GetCanvasBounds(mid_point.x - radius.x, mid_point.y - radius.y, mid_point.x + radius.x, mid_point.y + radius.y, 1);
+
+		this->layers.GetActive().Draw(bounds, [&](const int& origin_x, const int& origin_y)
+		{
+			App->renderer->DrawEllipse(
+				mid_point.x - origin_x, mid_point.y - origin_y,
+				radius.x, radius.y,
+				this->tools.GetColor()
+			);
+		});
 	}
 }
 
 void Editor::UseEllipseFill()
 {
-	static SDL_Point initial_mouse_position = { 0, 0 };
-	static SDL_Point final_mouse_position = { 0, 0 };
-
 	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_DOWN)
 	{
 		int mouse_position_x, mouse_position_y;
 		App->input->GetMousePosition(mouse_position_x, mouse_position_y);
 
-		initial_mouse_position = {
-			mouse_position_x,
-			mouse_position_y
-		};
+		this->ScreenToCanvas(mouse_position_x, mouse_position_y, this->shape_start.x, this->shape_start.y);
 	}
 
 	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_UP)
@@ -858,43 +2062,40 @@ void Editor::UseEllipseFill()
 		int mouse_position_x, mouse_position_y;
 		App->input->GetMousePosition(mouse_position_x, mouse_position_y);
 
-		final_mouse_position = {
-			mouse_position_x,
-			mouse_position_y
-		};
+		SDL_Point final_mouse_position;
+		this->ScreenToCanvas(mouse_position_x, mouse_position_y, final_mouse_position.x, final_mouse_position.y);
 
 		SDL_Point mid_point = {
-			(final_mouse_position.x - initial_mouse_position.x) / 2 + initial_mouse_position.x,
-			(final_mouse_position.y - initial_mouse_position.y) / 2 + initial_mouse_position.y
+			(final_mouse_position.x - this->shape_start.x) / 2 + this->shape_start.x,
+			(final_mouse_position.y - this->shape_start.y) / 2 + this->shape_start.y
 		};
 
 		SDL_Point radius = {
-			abs((final_mouse_position.x - initial_mouse_position.x) / 2),
-			abs((final_mouse_position.y - initial_mouse_position.y) / 2)
+			abs((final_mouse_position.x - this->shape_start.x) / 2),
+			abs((final_mouse_position.y - this->shape_start.y) / 2)
 		};
 
-		App->renderer->DrawEllipseFill(
-			mid_point.x - this->bg_rect.x, mid_point.y - this->bg_rect.y,
-			radius.x, radius.y,
-			this->tools.GetColor()
-		);
+		SDL_Rect bounds = this->GetCanvasBounds(mid_point.x - radius.x, mid_point.y - radius.y, mid_point.x + radius.x, mid_point.y + radius.y, 1);
+
+		this->layers.GetActive().Draw(bounds, [&](const int& origin_x, const int& origin_y)
+		{
+			App->renderer->DrawEllipseFill(
+				mid_point.x - origin_x, mid_point.y - origin_y,
+				radius.x, radius.y,
+				this->tools.GetColor()
+			);
+		});
 	}
 }
 
 void Editor::UseRectangle()
 {
-	static SDL_Point initial_mouse_position = { 0, 0 };
-	static SDL_Point final_mouse_position = { 0, 0 };
-
 	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_DOWN)
 	{
 		int mouse_position_x, mouse_position_y;
 		App->input->GetMousePosition(mouse_position_x, mouse_position_y);
 
-		initial_mouse_position = {
-			mouse_position_x,
-			mouse_position_y
-		};
+		this->ScreenToCanvas(mouse_position_x, mouse_position_y, this->shape_start.x, this->shape_start.y);
 	}
 
 	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_UP)
@@ -902,38 +2103,35 @@ void Editor::UseRectangle()
 		int mouse_position_x, mouse_position_y;
 		App->input->GetMousePosition(mouse_position_x, mouse_position_y);
 
-		final_mouse_position = {
-			mouse_position_x,
-			mouse_position_y
-		};
+		SDL_Point final_mouse_position;
+		this->ScreenToCanvas(mouse_position_x, mouse_position_y, final_mouse_position.x, final_mouse_position.y);
 
 		SDL_Point diff_point = {
-			final_mouse_position.x - initial_mouse_position.x,
-			final_mouse_position.y - initial_mouse_position.y
+			final_mouse_position.x - this->shape_start.x,
+			final_mouse_position.y - this->shape_start.y
 		};
 
-		App->renderer->DrawRectangle(
-			initial_mouse_position.x - this->bg_rect.x, initial_mouse_position.y - this->bg_rect.y,
-			diff_point.x, diff_point.y,
-			this->tools.GetColor()
-		);
+		SDL_Rect bounds = this->GetCanvasBounds(this->shape_start.x, this->shape_start.y, final_mouse_position.x, final_mouse_position.y, 1);
+
+		this->layers.GetActive().Draw(bounds, [&](const int& origin_x, const int& origin_y)
+		{
+			App->renderer->DrawRectangle(
+				this->shape_start.x - origin_x, this->shape_start.y - origin_y,
+				diff_point.x, diff_point.y,
+				this->tools.GetColor()
+			);
+		});
 	}
 }
 
 void Editor::UseRectangleFill()
 {
-	static SDL_Point initial_mouse_position = { 0, 0 };
-	static SDL_Point final_mouse_position = { 0, 0 };
-
 	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_DOWN)
 	{
 		int mouse_position_x, mouse_position_y;
 		App->input->GetMousePosition(mouse_position_x, mouse_position_y);
 
-		initial_mouse_position = {
-			mouse_position_x,
-			mouse_position_y
-		};
+		this->ScreenToCanvas(mouse_position_x, mouse_position_y, this->shape_start.x, this->shape_start.y);
 	}
 
 	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_UP)
@@ -941,28 +2139,198 @@ void Editor::UseRectangleFill()
 		int mouse_position_x, mouse_position_y;
 		App->input->GetMousePosition(mouse_position_x, mouse_position_y);
 
-		final_mouse_position = {
-			mouse_position_x,
-			mouse_position_y
-		};
+		SDL_Point final_mouse_position;
+		this->ScreenToCanvas(mouse_position_x, mouse_position_y, final_mouse_position.x, final_mouse_position.y);
 
 		SDL_Point diff_point = {
-			final_mouse_position.x - initial_mouse_position.x,
-			final_mouse_position.y - initial_mouse_position.y
+			final_mouse_position.x - this->shape_start.x,
+			final_mouse_position.y - this->shape_start.y
 		};
 
-		App->renderer->DrawRectangleFill(
-			initial_mouse_position.x - this->bg_rect.x, initial_mouse_position.y - this->bg_rect.y,
-			diff_point.x, diff_point.y,
-			this->tools.GetColor()
+		SDL_Rect bounds = this->GetCanvasBounds(this->shape_start.x, this->shape_start.y, final_mouse_position.x, final_mouse_position.y, 1);
+
+		this->layers.GetActive().Draw(bounds, [&](const int& origin_x, const int& origin_y)
+		{
+			App->renderer->DrawRectangleFill(
+				this->shape_start.x - origin_x, this->shape_start.y - origin_y,
+				diff_point.x, diff_point.y,
+				this->tools.GetColor()
+			);
+		});
+	}
+}
+
+void Editor::UseInpaint()
+{
+	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_DOWN)
+	{
+		this->inpaint_mask_width = this->layers.GetWidth();
+		this->inpaint_mask.assign((size_t)this->layers.GetWidth() * this->layers.GetHeight(), 0);
+		this->inpaint_stamps.clear();
+		this->inpaint_region = { 0, 0, 0, 0 };
+
+		this->last_frame_mouse_position_x = this->mouse_position_x;
+		this->last_frame_mouse_position_y = this->mouse_position_y;
+	}
+
+	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_DOWN
+		|| App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_REPEAT)
+	{
+		int radius = SDL_max(this->tools.tool_size / 2, 1);
+
+		int x0, y0, x1, y1;
+		this->ScreenToCanvas(this->last_frame_mouse_position_x, this->last_frame_mouse_position_y, x0, y0);
+		this->ScreenToCanvas(this->mouse_position_x, this->mouse_position_y, x1, y1);
+
+		/* Stamps are spaced half a radius apart so fast strokes leave no gaps */
+		int steps = SDL_max(SDL_abs(x1 - x0), SDL_abs(y1 - y0)) * 2 / radius + 1;
+
+		for (int step = 1; step <= steps; ++step)
+		{
+			this->StampInpaintMask(x0 + (x1 - x0) * step / steps, y0 + (y1 - y0) * step / steps, radius);
+		}
+	}
+
+	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_UP && !this->inpaint_mask.empty())
+	{
+		Inpaint::ApplyToCanvas(this->inpaint_mask, this->inpaint_mask_width, this->inpaint_region, this->inpaint_radius);
+
+		this->inpaint_mask.clear();
+		this->inpaint_stamps.clear();
+	}
+}
+
+void Editor::DrawShapePreview() const
+{
+	if (this->preview.IsActive() || App->input->GetMouseButton(SDL_BUTTON_LEFT) != KEY_STATE::KEY_REPEAT)
+		return;
+
+	/* Canvas points to screen, the shape follows the cursor until the button is released */
+	float x0 = this->bg_rect.x + this->shape_start.x * this->zoom;
+	float y0 = this->bg_rect.y + this->shape_start.y * this->zoom;
+
+	int x1, y1;
+	this->ScreenToCanvas(this->mouse_position_x, this->mouse_position_y, x1, y1);
+
+	float dx = (x1 - this->shape_start.x) * this->zoom;
+	float dy = (y1 - this->shape_start.y) * this->zoom;
+
+	ImVec4 color = this->tools.GetColor();
+
+	switch (this->tools.current_tool)
+	{
+		case TOOLS::LINE:
+		{
+			App->renderer->DrawLine((int)x0, (int)y0, (int)(x0 + dx), (int)(y0 + dy), (int)(this->tools.tool_size * this->zoom), color);
+
+			break;
+		}
+		case TOOLS::ELLIPSE:
+		{
+			App->renderer->DrawEllipse((int)(x0 + dx / 2), (int)(y0 + dy / 2), (int)std::abs(dx / 2), (int)std::abs(dy / 2), color);
+
+			break;
+		}
+		case TOOLS::ELLIPSE_FILL:
+		{
+			App->renderer->DrawEllipseFill((int)(x0 + dx / 2), (int)(y0 + dy / 2), (int)std::abs(dx / 2), (int)std::abs(dy / 2), color);
+
+			break;
+		}
+		case TOOLS::RECTANGLE:
+		{
+			App->renderer->DrawRectangle((int)x0, (int)y0, (int)dx, (int)dy, color);
+
+			break;
+		}
+		case TOOLS::RECTANGLE_FILL:
+		{
+			App->renderer->DrawRectangleFill((int)x0, (int)y0, (int)dx, (int)dy, color);
+
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
+}
+
+void Editor::UseBucketFill()
+{
+	if (App->input->GetMouseButton(SDL_BUTTON_LEFT) == KEY_STATE::KEY_DOWN)
+	{
+		int x, y;
+		this->ScreenToCanvas(mouse_position_x, mouse_position_y, x, y);
+
+		/* Only the tiles under the filled spans are written and uploaded again */
+		FloodFill::Fill(this->layers.GetActive(), x, y, this->fill_params, this->brush_spans);
+		this->layers.GetActive().FillSpans(this->brush_spans, this->tools.GetColorPixel());
+	}
+}
+
+void Editor::StampInpaintMask(const int& x, const int& y, const int& radius)
+{
+	if (this->inpaint_mask.empty())
+		return;
+
+	if (!this->inpaint_stamps.empty() && this->inpaint_stamps.back().x == x && this->inpaint_stamps.back().y == y)
+		return;
+
+	int mask_height = (int)(this->inpaint_mask.size() / this->inpaint_mask_width);
+
+	SDL_Rect canvas = { 0, 0, this->inpaint_mask_width, mask_height };
+	SDL_Rect stamp = { x - radius, y - radius, 2 * radius + 1, 2 * radius + 1 };
+	SDL_Rect clipped;
+
+	if (!SDL_IntersectRect(&canvas, &stamp, &clipped))
+		return;
+
+	for (int row = clipped.y; row < clipped.y + clipped.h; ++row)
+	{
+		Uint8* line = this->inpaint_mask.data() + (size_t)row * this->inpaint_mask_width;
+
+		for (int col = clipped.x; col < clipped.x + clipped.w; ++col)
+		{
+			if ((col - x) * (col - x) + (row - y) * (row - y) <= radius * radius)
+			{
+				line[col] = 1;
+			}
+		}
+	}
+
+	if (SDL_RectEmpty(&this->inpaint_region))
+	{
+		this->inpaint_region = clipped;
+	}
+	else
+	{
+		SDL_UnionRect(&this->inpaint_region, &clipped, &this->inpaint_region);
+	}
+
+	this->inpaint_stamps.push_back({ x, y });
+}
+
+void Editor::DrawInpaintMask() const
+{
+	if (this->inpaint_stamps.empty())
+		return;
+
+	ImDrawList* draw_list = ImGui::GetBackgroundDrawList();
+	float radius = SDL_max(this->tools.tool_size / 2, 1) * this->zoom;
+
+	for (const SDL_Point& stamp : this->inpaint_stamps)
+	{
+		draw_list->AddCircleFilled(
+			ImVec2(this->bg_rect.x + (stamp.x + 0.5f) * this->zoom, this->bg_rect.y + (stamp.y + 0.5f) * this->zoom),
+			radius,
+			IM_COL32(255, 0, 0, 96)
 		);
 	}
 }
 
 void Editor::ApplySuperResolution()
 {
-	App->renderer->SetRenderTarget(App->renderer->texture_target);
-
 	std::string extension = ".jpg";
 
 	std::string input_path;
@@ -972,7 +2340,7 @@ void Editor::ApplySuperResolution()
 
 	input_path.append(temp_filename).append(extension);
 
-	ImageLoader::SaveTexture(App->renderer->renderer, App->renderer->texture_target, input_path);
+	this->SaveImg(input_path);
 
 	std::string out_path;
 
@@ -1001,18 +2369,40 @@ void Editor::ApplySuperResolution()
 	printf("Loading...\n");
 
 	ShellExecuteEx(&ShExecInfo);
-	if (ShExecInfo.hProcess != NULL)
+
+	delete cmd;
+
+	if (ShExecInfo.hProcess == NULL)
 	{
-		WaitForSingleObject(ShExecInfo.hProcess, INFINITE);
-		CloseHandle(ShExecInfo.hProcess);
+		printf("Super resolution can't be started\n");
+		return;
 	}
 
-	delete cmd;
+	this->super_resolution_process = ShExecInfo.hProcess;
+	this->super_resolution_output = out_path;
+	this->super_resolution_running = true;
+
+	/* The main loop keeps drawing, or sleeps, until the worker reports the process exit */
+	HANDLE process = ShExecInfo.hProcess;
+	this->super_resolution_worker = std::thread([process]()
+	{
+		WaitForSingleObject(process, INFINITE);
+		App->PostJobDone(JOB::SUPER_RESOLUTION);
+	});
+}
+
+void Editor::FinishSuperResolution()
+{
+	if (!this->super_resolution_running)
+		return;
 
-	App->renderer->SetRenderTarget(nullptr);
+	this->super_resolution_worker.join();
+	CloseHandle((HANDLE)this->super_resolution_process);
 
-	this->bg = this->LoadImg(out_path);
-	this->RenderImg(this->bg, App->renderer->texture_target);
+	this->super_resolution_process = nullptr;
+	this->super_resolution_running = false;
+
+	this->LoadImg(this->super_resolution_output);
 }
 
 void Editor::ApplyLoadHDRImage(const std::vector<std::string>& image_paths, const std::vector<float>& exposure_times, const TONEMAP_TYPE& tonemap_type)
@@ -1022,8 +2412,6 @@ void Editor::ApplyLoadHDRImage(const std::vector<std::string>& image_paths, cons
 
 void Editor::ApplyFastFlowInferenceLeather()
 {
-	App->renderer->SetRenderTarget(App->renderer->texture_target);
-
 	std::string input_extension = ".png";
 	std::string input_path;
 
@@ -1032,7 +2420,7 @@ void Editor::ApplyFastFlowInferenceLeather()
 
 	input_path.append(input_temp_filename).append(input_extension);
 
-	ImageLoader::SaveTexture(App->renderer->renderer, App->renderer->texture_target, input_path);
+	this->SaveImg(input_path);
 
 	cv::Mat result = App->torch_loader->FastFlowInference(input_path);
 
@@ -1052,9 +2440,121 @@ void Editor::ApplyFastFlowInferenceLeather()
 	this->anomaly_viewer_texture = ImageLoader::LoadTexture(App->renderer->renderer, output_path);
 	this->anomaly_viewer_panel = true;
 
+	this->components_from_canvas = false;
+	this->FindComponents();
+
 	result.release();
 }
 
+void Editor::ApplyDistanceTransform(const int& threshold, const bool& invert, const float& max_distance)
+{
+	std::vector<Uint32> pixels;
+	int width, height;
+
+	this->ReadCanvasPixels(pixels, width, height);
+
+	std::vector<Uint8> luma(pixels.size());
+	std::vector<Uint8> mask(pixels.size());
+
+	for (int row = 0; row < height; ++row)
+	{
+		ColorSpace::LumaRow(pixels.data() + (size_t)row * width, width, luma.data() + (size_t)row * width);
+	}
+
+	ConnectedComponents::Threshold(luma.data(), (int)luma.size(), threshold, invert, mask.data());
+
+	if (std::find(mask.begin(), mask.end(), 1) == mask.end())
+	{
+		printf("Distance transform: no pixel passes the threshold\n");
+		return;
+	}
+
+	std::vector<float> distance;
+	DistanceTransform::Compute(mask.data(), width, height, distance);
+
+	float scale = max_distance;
+
+	/* The mask is not empty, so every distance is finite */
+	if (scale <= 0.0f)
+	{
+		scale = *std::max_element(distance.begin(), distance.end());
+	}
+
+	scale = scale > 0.0f ? 255.0f / scale : 0.0f;
+
+	for (size_t i = 0; i < pixels.size(); ++i)
+	{
+		Uint32 value = (Uint32)SDL_min(distance[i] * scale + 0.5f, 255.0f);
+
+		pixels[i] = (value << 24) | (value << 16) | (value << 8) | (pixels[i] & 0xFF);
+	}
+
+	this->WriteCanvasPixels(pixels, width, height);
+}
+
+void Editor::FindComponents()
+{
+	std::vector<Uint8> values;
+	int width = 0, height = 0;
+
+	if (this->components_from_canvas)
+	{
+		std::vector<Uint32> pixels;
+		this->ReadCanvasPixels(pixels, width, height);
+
+		values.resize(pixels.size());
+
+		for (int row = 0; row < height; ++row)
+		{
+			ColorSpace::LumaRow(pixels.data() + (size_t)row * width, width, values.data() + (size_t)row * width);
+		}
+	}
+	else if (!App->torch_loader->anomaly_map.empty())
+	{
+		const cv::Mat& map = App->torch_loader->anomaly_map;
+
+		width = map.cols;
+		height = map.rows;
+		values.assign(map.data, map.data + map.total());
+	}
+
+	this->components.clear();
+
+	if (values.empty())
+		return;
+
+	std::vector<Uint8> mask(values.size());
+	ConnectedComponents::Threshold(values.data(), (int)values.size(), this->component_params.THRESHOLD, this->component_params.INVERT, mask.data());
+
+	std::vector<int> labels;
+	std::vector<ComponentStats> stats;
+	ConnectedComponents::Label(mask.data(), width, height, this->component_params.CONNECTIVITY_TYPE, labels, stats);
+
+	/* The anomaly map is computed on a downscaled copy, report everything in canvas pixels */
+	float scale_x = (float)this->layers.GetWidth() / width;
+	float scale_y = (float)this->layers.GetHeight() / height;
+
+	for (ComponentStats& component : stats)
+	{
+		if (component.area < this->component_params.MIN_AREA)
+			continue;
+
+		if (!this->components_from_canvas)
+		{
+			component.area = (int)(component.area * scale_x * scale_y + 0.5f);
+			component.bbox = {
+				(int)(component.bbox.x * scale_x), (int)(component.bbox.y * scale_y),
+				(int)(component.bbox.w * scale_x + 0.5f), (int)(component.bbox.h * scale_y + 0.5f)
+			};
+			component.centroid_x = (component.centroid_x + 0.5f) * scale_x - 0.5f;
+			component.centroid_y = (component.centroid_y + 0.5f) * scale_y - 0.5f;
+		}
+
+		component.label = (int)this->components.size() + 1;
+		this->components.push_back(component);
+	}
+}
+
 void Editor::ApplyStyleTransferInference(const std::string& content_path, const std::string& style_path)
 {
 	cv::Mat result = App->torch_loader->StyleTransferInference(content_path, style_path);
@@ -1064,61 +2564,174 @@ void Editor::ApplyStyleTransferInference(const std::string& content_path, const
 	result.release();
 }
 
-SDL_Texture* Editor::LoadImg(const std::string& path) const
+bool Editor::LoadImg(const std::string& path)
 {
-	SDL_Texture* texture = ImageLoader::LoadTexture(App->renderer->renderer, path);
-	
+	std::vector<Uint32> pixels;
 	int width, height;
-	ImageLoader::GetTextureDimensions(texture, &width, &height);
 
-	if (App->renderer->texture_workbench_target) SDL_DestroyTexture(App->renderer->texture_workbench_target);
-	if (App->renderer->texture_filter) SDL_DestroyTexture(App->renderer->texture_filter);
-	if (App->renderer->texture_target) SDL_DestroyTexture(App->renderer->texture_target);
+	if (!ImageLoader::LoadPixels(path, pixels, width, height))
+		return false;
 
-	App->renderer->texture_workbench_target = App->renderer->CreateTexture(
-		App->renderer->texture_format,
-		SDL_TEXTUREACCESS_STREAMING,
-		width, height
-	);
+	this->layers.Reset(width, height, 0xFFFFFFFF);
+	this->WriteCanvasPixels(pixels, width, height);
 
-	App->renderer->texture_filter = App->renderer->CreateTexture(
-		App->renderer->texture_format,
-		SDL_TEXTUREACCESS_STREAMING,
-		width, height
-	);
+	/* A new image starts a new history */
+	this->history.Clear(this->layers);
 
-	App->renderer->texture_target = App->renderer->CreateTexture(
-		App->renderer->texture_format,
-		SDL_TEXTUREACCESS_TARGET,
-		width, height
-	);
+	this->zoom = 1.0f;
+	this->bg_rect = { 0, 0, width, height };
+
+	return true;
+}
+
+void Editor::SaveImg(const std::string& path)
+{
+	std::vector<Uint32> pixels;
+	int width = this->layers.GetWidth();
+	int height = this->layers.GetHeight();
+
+	/* Files get what is on screen, every layer flattened */
+	this->layers.Composite();
+
+	pixels.resize((size_t)width * height);
+	this->layers.GetComposite().ReadRegion(pixels.data(), width, { 0, 0, width, height });
+
+	ImageLoader::SavePixels(path, pixels, width, height);
+}
 
-	App->renderer->texture_target_width = width;
-	App->renderer->texture_target_height = height;
+void Editor::Undo()
+{
+	if (this->history.Undo(this->layers))
+	{
+		/* The step may have resized the canvas */
+		this->ResizeCanvas(this->layers.GetWidth(), this->layers.GetHeight());
+	}
+}
 
-	return texture;
+void Editor::Redo()
+{
+	if (this->history.Redo(this->layers))
+	{
+		this->ResizeCanvas(this->layers.GetWidth(), this->layers.GetHeight());
+	}
 }
 
-void Editor::SaveImg(SDL_Texture* texture, const std::string& path) const
+void Editor::ResizeCanvas(const int& width, const int& height)
 {
-	App->renderer->SetRenderTarget(texture);
-	ImageLoader::SaveTexture(App->renderer->renderer, texture, path);
+	this->layers.Resize(width, height);
+
+	this->bg_rect.w = (int)std::floor(width * this->zoom + 0.5f);
+	this->bg_rect.h = (int)std::floor(height * this->zoom + 0.5f);
 }
 
-void Editor::RenderImg(SDL_Texture* texture, SDL_Texture* target, const bool& assign_new_bg_rect)
+void Editor::ReadCanvasPixels(std::vector<Uint32>& pixels, int& width, int& height) const
 {
-	App->renderer->SetRenderTarget(target);
+	width = this->layers.GetWidth();
+	height = this->layers.GetHeight();
 
-	int w, h;
-	ImageLoader::GetTextureDimensions(texture, &w, &h);
+	pixels.resize((size_t)width * height);
 
-	if(assign_new_bg_rect)
-		this->bg_rect = { 0, 0, w, h };
+	this->layers.GetActive().ReadRegion(pixels.data(), width, { 0, 0, width, height });
+}
+
+void Editor::ReadCanvasRegion(std::vector<Uint32>& pixels, const SDL_Rect& region) const
+{
+	pixels.resize((size_t)region.w * region.h);
+
+	this->layers.GetActive().ReadRegion(pixels.data(), region.w, region);
+}
 
-	if (texture)
+void Editor::WriteCanvasPixels(const std::vector<Uint32>& pixels, const int& width, const int& height)
+{
+	if (this->layers.GetWidth() != width || this->layers.GetHeight() != height)
 	{
-		App->renderer->RenderTexture(texture, nullptr, nullptr);
+		this->ResizeCanvas(width, height);
 	}
 
-	App->renderer->SetRenderTarget(nullptr);
+	this->layers.GetActive().WriteRegion(pixels.data(), width, { 0, 0, width, height });
+}
+
+void Editor::WriteCanvasRegion(const std::vector<Uint32>& pixels, const SDL_Rect& region)
+{
+	this->layers.GetActive().WriteRegion(pixels.data(), region.w, region);
+}
+
+void Editor::TransformCanvasPixels(const CanvasPixelFunction& function)
+{
+	this->layers.GetActive().TransformPixels(function);
+}
+
+SDL_Rect Editor::GetVisibleCanvasRect() const
+{
+	SDL_Rect screen = { 0, 0, App->window->width, App->window->height };
+
+	SDL_Rect visible;
+	if (!SDL_IntersectRect(&screen, &this->bg_rect, &visible))
+		return { 0, 0, 0, 0 };
+
+	int x0 = (int)std::floor((visible.x - this->bg_rect.x) / this->zoom);
+	int y0 = (int)std::floor((visible.y - this->bg_rect.y) / this->zoom);
+	int x1 = (int)std::ceil((visible.x + visible.w - this->bg_rect.x) / this->zoom);
+	int y1 = (int)std::ceil((visible.y + visible.h - this->bg_rect.y) / this->zoom);
+
+	x0 = SDL_clamp(x0, 0, this->layers.GetWidth());
+	y0 = SDL_clamp(y0, 0, this->layers.GetHeight());
+	x1 = SDL_clamp(x1, x0, this->layers.GetWidth());
+	y1 = SDL_clamp(y1, y0, this->layers.GetHeight());
+
+	return { x0, y0, x1 - x0, y1 - y0 };
+}
+
+void Editor::ScreenToCanvas(const int& screen_x, const int& screen_y, int& canvas_x, int& canvas_y) const
+{
+	canvas_x = (int)std::floor((screen_x - this->bg_rect.x) / this->zoom);
+	canvas_y = (int)std::floor((screen_y - this->bg_rect.y) / this->zoom);
+}
+
+SDL_Rect Editor::CanvasToScreen(const SDL_Rect& region) const
+{
+	int x0 = this->bg_rect.x + (int)std::floor(region.x * this->zoom);
+	int y0 = this->bg_rect.y + (int)std::floor(region.y * this->zoom);
+	int x1 = this->bg_rect.x + (int)std::ceil((region.x + region.w) * this->zoom);
+	int y1 = this->bg_rect.y + (int)std::ceil((region.y + region.h) * this->zoom);
+
+	return { x0, y0, x1 - x0, y1 - y0 };
+}
+
+void Editor::SetZoom(const float& zoom, const int& pivot_x, const int& pivot_y)
+{
+	float new_zoom = SDL_clamp(zoom, CANVAS_MIN_ZOOM, CANVAS_MAX_ZOOM);
+
+	/* The canvas point under the pivot stays under it */
+	double canvas_x = (pivot_x - this->bg_rect.x) / (double)this->zoom;
+	double canvas_y = (pivot_y - this->bg_rect.y) / (double)this->zoom;
+
+	this->zoom = new_zoom;
+	this->bg_rect = {
+		pivot_x - (int)std::floor(canvas_x * new_zoom + 0.5),
+		pivot_y - (int)std::floor(canvas_y * new_zoom + 0.5),
+		(int)std::floor(this->layers.GetWidth() * new_zoom + 0.5f),
+		(int)std::floor(this->layers.GetHeight() * new_zoom + 0.5f)
+	};
+}
+
+void Editor::FitCanvasToWindow()
+{
+	if (this->layers.GetWidth() == 0 || this->layers.GetHeight() == 0)
+		return;
+
+	float zoom = SDL_min((float)App->window->width / this->layers.GetWidth(), (float)App->window->height / this->layers.GetHeight());
+
+	this->SetZoom(zoom, 0, 0);
+
+	this->bg_rect.x = (App->window->width - this->bg_rect.w) / 2;
+	this->bg_rect.y = (App->window->height - this->bg_rect.h) / 2;
+}
+
+SDL_Rect Editor::GetCanvasBounds(const int& x0, const int& y0, const int& x1, const int& y1, const int& margin) const
+{
+	return {
+		SDL_min(x0, x1) - margin, SDL_min(y0, y1) - margin,
+		SDL_abs(x1 - x0) + 2 * margin + 1, SDL_abs(y1 - y0) + 2 * margin + 1
+	};
 }
\ No newline at end of file
@@ -1,12 +1,29 @@
 #ifndef __EDITOR_H__
 #define __EDITOR_H__
 
+#include <string>
+#include <thread>
+
 #include "tools/EditorToolSelector.h"
+#include "tools/BrushEngine.h"
+#include "tools/ColorAdjustment.h"
+#include "tools/ConnectedComponents.h"
+#include "tools/DomainTransform.h"
+#include "tools/FilterPreview.h"
+#include "tools/FloodFill.h"
 #include "tools/HDRLoader.h"
+#include "tools/History.h"
+#include "tools/LocalLaplacian.h"
+#include "tools/LayerStack.h"
 #include "Module.h"
+#include "Application.h"
 
 #include "SDL.h"
 
+#define CANVAS_MIN_ZOOM 0.01f
+#define CANVAS_MAX_ZOOM 32.0f
+#define CANVAS_ZOOM_STEP 1.25f
+
 class Editor : public Module
 {
 public:
@@ -19,18 +36,40 @@ public:
 
 public:
 	void DrawGUI();
+	void OnJobDone(const JOB& job);
+
+	bool LoadImg(const std::string& path);
+	void SaveImg(const std::string& path);
+
+	void Undo();
+	void Redo();
+
+	void ResizeCanvas(const int& width, const int& height);
+	void ReadCanvasPixels(std::vector<Uint32>& pixels, int& width, int& height) const;
+	void ReadCanvasRegion(std::vector<Uint32>& pixels, const SDL_Rect& region) const;
+	void WriteCanvasPixels(const std::vector<Uint32>& pixels, const int& width, const int& height);
+	void WriteCanvasRegion(const std::vector<Uint32>& pixels, const SDL_Rect& region);
+	void TransformCanvasPixels(const CanvasPixelFunction& function);
 
-	SDL_Texture* LoadImg(const std::string& path) const;
-	void SaveImg(SDL_Texture* texture, const std::string& path) const;
+	SDL_Rect GetVisibleCanvasRect() const;
+	void ScreenToCanvas(const int& screen_x, const int& screen_y, int& canvas_x, int& canvas_y) const;
+	SDL_Rect CanvasToScreen(const SDL_Rect& region) const;
 
-	void RenderImg(SDL_Texture* texture, SDL_Texture* target, const bool& assign_new_bg_rect=true);
+	/* Outline of the line, ellipse or rectangle being dragged, in screen space */
+	void DrawShapePreview() const;
 
 private:
 	void MainMenuBar();
+	void Shortcuts();
 	void ToolSelection();
 	void Panels();
 	void PopUps();
 
+	void PanCanvas();
+	void SetZoom(const float& zoom, const int& pivot_x, const int& pivot_y);
+	void FitCanvasToWindow();
+	SDL_Rect GetCanvasBounds(const int& x0, const int& y0, const int& x1, const int& y1, const int& margin) const;
+
 	void UseStandardBrush();
 	void UseRubber(const int& button);
 	void UseCirleBrush();
@@ -42,17 +81,29 @@ private:
 	void UseEllipseFill();
 	void UseRectangle();
 	void UseRectangleFill();
+	void UseInpaint();
+	void UseBucketFill();
+
+	void StampInpaintMask(const int& x, const int& y, const int& radius);
+	void DrawInpaintMask() const;
 
 	void ApplySuperResolution();
+	void FinishSuperResolution();
 	void ApplyLoadHDRImage(const std::vector<std::string>& image_paths, const std::vector<float>& exposure_times, const TONEMAP_TYPE& tonemap_type);
 	void ApplyFastFlowInferenceLeather();
 	void ApplyStyleTransferInference(const std::string& content_path, const std::string& style_path);
 
+	void FindComponents();
+	void ApplyDistanceTransform(const int& threshold, const bool& invert, const float& max_distance);
+
 public:
 	EditorToolSelector tools;
-	SDL_Texture* bg;
+	FilterPreview preview;
+	LayerStack layers;
+	History history;
 	SDL_Texture* anomaly_viewer_texture;
 	SDL_Rect bg_rect;
+	float zoom;
 
 private:
 	int mouse_position_x;
@@ -63,9 +114,57 @@ private:
 
 	bool preferences_panel;
 	bool anomaly_viewer_panel;
+	bool color_adjustment_panel;
+	bool domain_transform_panel;
+	bool local_laplacian_panel;
+	bool layers_panel;
+
+	int history_memory_limit;
 	bool load_hdr_image_popup;
 	bool super_resolution_popup;
+
 	bool style_transfer_popup;
+	bool unsharp_mask_popup;
+	bool high_boost_popup;
+	bool distance_transform_popup;
+	bool content_aware_resize_popup;
+	bool posterize_popup;
+	bool reduce_colors_popup;
+	bool expression_filter_popup;
+	bool match_histogram_popup;
+	bool wiener_popup;
+	bool lee_popup;
+
+	ColorAdjustmentParams color_adjustment_params;
+	DomainTransformParams domain_transform_params;
+	LocalLaplacianParams local_laplacian_params;
+
+	ComponentParams component_params;
+	std::vector<ComponentStats> components;
+	bool components_from_canvas;
+
+	/* Canvas point where the current line, ellipse or rectangle drag started */
+	SDL_Point shape_start;
+
+	BrushEngine brush;
+	BrushParams brush_params;
+	FloodFillParams fill_params;
+
+	/* Reused by the span brushes so painting does not allocate every frame */
+	std::vector<Span> brush_spans;
+
+	/* Inpaint strokes are painted into a CPU mask and filled when the button is released */
+	std::vector<Uint8> inpaint_mask;
+	std::vector<SDL_Point> inpaint_stamps;
+	SDL_Rect inpaint_region;
+	int inpaint_mask_width;
+	int inpaint_radius;
+
+	/* The upscaler runs as a separate process, a worker waits for it and wakes the main loop */
+	std::thread super_resolution_worker;
+	void* super_resolution_process;
+	std::string super_resolution_output;
+	bool super_resolution_running;
 };
 
 #endif /* __EDITOR_H__ */
\ No newline at end of file
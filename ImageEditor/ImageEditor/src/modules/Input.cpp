@@ -26,16 +26,31 @@ void Input::Start()
 	}
 
 	memset(this->mouse_buttons, (int)KEY_STATE::KEY_IDLE, sizeof(KEY_STATE) * NUM_MOUSE_BUTTONS);
+
+	this->mouse_wheel_y = 0;
 }
 
 void Input::PreUpdate()
 {
 	this->UpdateMouseState();
+	this->mouse_wheel_y = 0;
 
 	SDL_Event e;
 	while (SDL_PollEvent(&e) != 0)
 	{
 		ImGui_ImplSDL2_ProcessEvent(&e);
+		App->renderer->RequestRedraw();
+
+		/* Render target contents are gone after a device or target reset */
+		if (e.type == SDL_RENDER_TARGETS_RESET || e.type == SDL_RENDER_DEVICE_RESET)
+		{
+			App->renderer->InvalidateWorkbench();
+		}
+
+		if (e.type == App->job_event)
+		{
+			App->editor->OnJobDone((JOB)e.user.code);
+		}
 
 		ImGuiIO& io = ImGui::GetIO();
 		if (!io.WantCaptureMouse)
@@ -60,6 +75,12 @@ void Input::PreUpdate()
 
 					break;
 				}
+				case SDL_MOUSEWHEEL:
+				{
+					this->mouse_wheel_y += e.wheel.y;
+
+					break;
+				}
 				case SDL_MOUSEMOTION:
 				{
 					this->mouse_position_x = e.motion.x;
@@ -75,8 +96,7 @@ void Input::PreUpdate()
 					std::string dropped_file_path = e.drop.file;
 					printf("User loaded file %s\n", dropped_file_path.c_str());
 
-					App->editor->bg = App->editor->LoadImg(dropped_file_path);
-					App->editor->RenderImg(App->editor->bg, App->renderer->texture_target);
+					App->editor->LoadImg(dropped_file_path);
 
 					break;
 				}
@@ -121,6 +141,22 @@ void Input::GetMouseMotion(int& x, int& y) const
 	y = mouse_motion_y;
 }
 
+int Input::GetMouseWheel() const
+{
+	return this->mouse_wheel_y;
+}
+
+bool Input::IsMouseIdle() const
+{
+	for (int i = 0; i < NUM_MOUSE_BUTTONS; ++i)
+	{
+		if (this->mouse_buttons[i] != KEY_STATE::KEY_IDLE)
+			return false;
+	}
+
+	return true;
+}
+
 void Input::UpdateMouseState()
 {
 	for (int i = 0; i < NUM_MOUSE_BUTTONS; ++i)
@@ -29,6 +29,8 @@ public:
 	KEY_STATE GetMouseButton(const int& id) const;
 	void GetMousePosition(int& x, int& y) const;
 	void GetMouseMotion(int& x, int& y) const;
+	int GetMouseWheel() const;
+	bool IsMouseIdle() const;
 
 private:
 	void UpdateMouseState();
@@ -41,6 +43,7 @@ private:
 	int mouse_position_y;
 	int mouse_motion_x;
 	int mouse_motion_y;
+	int mouse_wheel_y;
 };
 
 #endif /* __INPUT_H__ */
\ No newline at end of file
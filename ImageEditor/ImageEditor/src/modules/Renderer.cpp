@@ -1,7 +1,8 @@
 #include <iostream>
 #include <cmath>
+#include <vector>
 
-#include "SDL2_gfxPrimitives.h"
+#include "tools/SpanRasterizer.h"
 
 #include "Application.h"
 #include "Renderer.h"
@@ -10,7 +11,7 @@
 #include "Gui.h"
 
 Renderer::Renderer()
-	: Module(), renderer(nullptr), texture_target(nullptr), texture_format(SDL_PIXELFORMAT_RGBA8888)
+	: Module(), renderer(nullptr), texture_format(SDL_PIXELFORMAT_RGBA8888), presented_view({ 0, 0, 0, 0 }), workbench_valid(false), redraw_frames(RENDERER_SETTLE_FRAMES)
 {
 
 }
@@ -30,34 +31,13 @@ void Renderer::Start()
 		printf("Renderer can't be created. SDL_GetError: %s\n", SDL_GetError());
 	}
 
-	this->texture_target_width = App->window->width;
-	this->texture_target_height = App->window->height;
-
 	this->texture_anomaly_viewer_target = SDL_CreateTexture(this->renderer, this->texture_format, SDL_TEXTUREACCESS_TARGET, 200, 200);
 	this->texture_workbench_target = SDL_CreateTexture(this->renderer, this->texture_format, SDL_TEXTUREACCESS_TARGET, App->window->width, App->window->height);
-	this->texture_filter = SDL_CreateTexture(this->renderer, this->texture_format, SDL_TEXTUREACCESS_STREAMING, App->window->width, App->window->height);
-	this->texture_target = SDL_CreateTexture(this->renderer, this->texture_format, SDL_TEXTUREACCESS_TARGET, App->window->width, App->window->height);
-
-	SDL_SetRenderTarget(App->renderer->renderer, App->renderer->texture_target);
-
-	SDL_Rect rect_screen = { 0, 0, App->window->width, App->window->height };
-	SDL_SetRenderDrawColor(App->renderer->renderer, 255, 255, 255, 255);
-	SDL_RenderFillRect(App->renderer->renderer, &rect_screen);
-
-	SDL_SetRenderTarget(App->renderer->renderer, nullptr);
 }
 
 void Renderer::PreUpdate()
 {
-	SDL_SetRenderTarget(App->renderer->renderer, this->texture_workbench_target);
 
-	SDL_Rect rect_screen = { 0, 0, App->window->width, App->window->height };
-	SDL_SetRenderDrawColor(App->renderer->renderer, 175, 175, 175, 255);
-	SDL_RenderFillRect(App->renderer->renderer, &rect_screen);
-
-	SDL_SetRenderTarget(App->renderer->renderer, nullptr);
-
-	SDL_SetRenderTarget(App->renderer->renderer, this->texture_target);
 }
 
 void Renderer::Update()
@@ -67,17 +47,47 @@ void Renderer::Update()
 
 void Renderer::PostUpdate()
 {
-	if (App->editor->bg == nullptr)
+	SDL_Rect screen = { 0, 0, App->window->width, App->window->height };
+	SDL_Rect damage;
+
+	/* Only the tiles changed in some layer are blended again */
+	App->editor->layers.Composite();
+
+	bool damaged = App->editor->layers.GetComposite().TakeDamage(damage);
+
+	/* Panning or zooming moves every pixel of the view */
+	if (!this->workbench_valid || !SDL_RectEquals(&this->presented_view, &App->editor->bg_rect))
+	{
+		this->ComposeCanvas(screen);
+
+		this->presented_view = App->editor->bg_rect;
+		this->workbench_valid = true;
+	}
+	else if (damaged)
 	{
-		SDL_Rect target_texture_rect = { 0, 0, this->texture_target_width, this->texture_target_height };
-		SDL_RenderCopy(App->renderer->renderer, this->texture_target, nullptr, &target_texture_rect);
+		/* Linear filtering reaches one screen pixel past the changed area */
+		SDL_Rect region = App->editor->CanvasToScreen(damage);
+		region = { region.x - 1, region.y - 1, region.w + 2, region.h + 2 };
+
+		if (SDL_IntersectRect(&screen, &region, &region))
+		{
+			this->ComposeCanvas(region);
+		}
 	}
-	else
+	else if (this->redraw_frames == 0)
 	{
-		SDL_RenderCopy(App->renderer->renderer, this->texture_target, nullptr, &App->editor->bg_rect);
+		/* Idle, the last presented frame is still correct */
+		return;
 	}
 
-	SDL_SetRenderTarget(App->renderer->renderer, nullptr);
+	this->redraw_frames = SDL_max(this->redraw_frames - 1, 0);
+
+	SDL_SetRenderTarget(this->renderer, nullptr);
+	SDL_RenderCopy(this->renderer, this->texture_workbench_target, nullptr, nullptr);
+
+	/* Overlays go on top of the cached view and never touch the workbench */
+	App->editor->DrawShapePreview();
+	this->FlushPrimitives();
 
 	App->gui->Draw();
 
@@ -88,98 +98,97 @@ void Renderer::CleanUp()
 {
 	SDL_DestroyTexture(this->texture_anomaly_viewer_target);
 	SDL_DestroyTexture(this->texture_workbench_target);
-	SDL_DestroyTexture(this->texture_filter);
-	SDL_DestroyTexture(this->texture_target);
+
+	/* Canvas tiles outlive the renderer, their textures must go first */
+	App->editor->layers.ReleaseTextures();
 
 	SDL_DestroyRenderer(this->renderer);
 }
 
-void Renderer::DrawLine(const int& x1, const int& y1, const int& x2, const int& y2, const int& size, const ImVec4& color)
+void Renderer::RequestRedraw()
 {
-	thickLineRGBA(
-		App->renderer->renderer,
-		x1, y1,
-		x2, y2,
-		size,
-		color.x, color.y, color.z, color.w
-	);
+	this->redraw_frames = RENDERER_SETTLE_FRAMES;
 }
 
-void Renderer::DrawCircle(const int& x, const int& y, const int& radius, const ImVec4& color)
+void Renderer::InvalidateWorkbench()
 {
-	App->renderer->SetRenderDrawColor(color.x, color.y, color.z, color.w);
+	this->workbench_valid = false;
+}
 
-	SDL_Point points[360];
-	float factor = (float)M_PI / 180.0f;
+bool Renderer::IsIdle() const
+{
+	return this->workbench_valid && this->redraw_frames == 0;
+}
 
-	for (int i = 0; i < 360; ++i)
-	{
-		points[i].x = (int)(x + radius * cos(i * factor));
-		points[i].y = (int)(y + radius * sin(i * factor));
-	}
+void Renderer::ComposeCanvas(const SDL_Rect& region)
+{
+	SDL_SetRenderTarget(this->renderer, this->texture_workbench_target);
+	SDL_RenderSetClipRect(this->renderer, &region);
+
+	Uint8 r, g, b, a;
+	SDL_GetRenderDrawColor(this->renderer, &r, &g, &b, &a);
+
+	SDL_SetRenderDrawColor(this->renderer, 175, 175, 175, 255);
+	SDL_RenderFillRect(this->renderer, &region);
+	SDL_SetRenderDrawColor(this->renderer, r, g, b, a);
+
+	App->editor->layers.GetComposite().Render(App->editor->bg_rect, region);
+
+	SDL_RenderSetClipRect(this->renderer, nullptr);
+	SDL_SetRenderTarget(this->renderer, nullptr);
+}
 
-	SDL_RenderDrawPoints(this->renderer, points, 360);
+void Renderer::DrawLine(const int& x1, const int& y1, const int& x2, const int& y2, const int& size, const ImVec4& color)
+{
+	this->primitives.AddLine(x1, y1, x2, y2, size, Renderer::ToColor(color));
+}
+
+void Renderer::DrawCircle(const int& x, const int& y, const int& radius, const ImVec4& color)
+{
+	this->primitives.AddEllipse(x, y, radius, radius, Renderer::ToColor(color));
 }
 
 void Renderer::DrawCircleFill(const int& x, const int& y, const int& radius, const ImVec4& color)
 {
 	App->renderer->SetRenderDrawColor(color.x, color.y, color.z, color.w);
 
-	for (int w = 0; w < radius * 2; ++w)
-	{
-		for (int h = 0; h < radius * 2; ++h)
-		{
-			int dx = radius - w;
-			int dy = radius - h;
+	std::vector<Span> spans;
+	SpanRasterizer::Circle(x, y, radius, spans);
 
-			if ((dx * dx + dy * dy) <= (radius * radius))
-			{
-				SDL_RenderDrawPoint(this->renderer, x + dx, y + dy);
-			}
-		}
+	/* One rect per scanline, submitted as a single batch */
+	std::vector<SDL_Rect> rects(spans.size());
+
+	for (size_t i = 0; i < spans.size(); ++i)
+	{
+		rects[i] = { spans[i].x0, spans[i].y, spans[i].x1 - spans[i].x0, 1 };
 	}
+
+	SDL_RenderFillRects(this->renderer, rects.data(), (int)rects.size());
 }
 
 void Renderer::DrawRectangle(const int& x, const int& y, const int& width, const int& height, const ImVec4& color)
 {
-	rectangleRGBA(
-		this->renderer,
-		x, y,
-		x + width,
-		y + height,
-		color.x, color.y, color.z, color.w
-	);
+	this->primitives.AddRectangle(x, y, width, height, Renderer::ToColor(color));
 }
 
 void Renderer::DrawRectangleFill(const int& x, const int& y, const int& width, const int& height, const ImVec4& color)
 {
-	boxRGBA(
-		this->renderer,
-		x, y,
-		x + width,
-		y + height,
-		color.x, color.y, color.z, color.w
-	);
+	this->primitives.AddRectangleFill(x, y, width, height, Renderer::ToColor(color));
 }
 
 void Renderer::DrawEllipse(const int& x, const int& y, const int& radius_x, const int& radius_y, const ImVec4& color)
 {
-	ellipseRGBA(
-		this->renderer,
-		x, y,
-		radius_x, radius_y,
-		color.x, color.y, color.z, color.w
-	);
+	this->primitives.AddEllipse(x, y, radius_x, radius_y, Renderer::ToColor(color));
 }
 
 void Renderer::DrawEllipseFill(const int& x, const int& y, const int& radius_x, const int& radius_y, const ImVec4& color)
 {
-	filledEllipseRGBA(
-		this->renderer,
-		x, y,
-		radius_x, radius_y,
-		color.x, color.y, color.z, color.w
-	);
+	this->primitives.AddEllipseFill(x, y, radius_x, radius_y, Renderer::ToColor(color));
+}
+
+void Renderer::FlushPrimitives()
+{
+	this->primitives.Flush(this->renderer);
 }
 
 void Renderer::SetRenderTarget(SDL_Texture* texture) const
@@ -208,4 +217,9 @@ void Renderer::RenderTexture(SDL_Texture* texture, SDL_Rect* source_rect, SDL_Re
 	{
 		printf("Render copy can't be performed. SDL_GetError(): %s\n", SDL_GetError());
 	}
+}
+
+SDL_Color Renderer::ToColor(const ImVec4& color)
+{
+	return { (Uint8)color.x, (Uint8)color.y, (Uint8)color.z, (Uint8)color.w };
 }
\ No newline at end of file
@@ -4,8 +4,12 @@
 #include "SDL.h"
 #include "imgui.h"
 
+#include "tools/PrimitiveBatcher.h"
 #include "Module.h"
 
+/* Frames still presented after the last event, ImGui needs a few to settle hover states and popups */
+#define RENDERER_SETTLE_FRAMES 3
+
 class Renderer : public Module
 {
 public:
@@ -25,6 +29,8 @@ public:
 	void DrawRectangleFill(const int& x, const int& y, const int& width, const int& height, const ImVec4& color);
 	void DrawEllipse(const int& x, const int& y, const int& radius_x, const int& radius_y, const ImVec4& color);
 	void DrawEllipseFill(const int& x, const int& y, const int& radius_x, const int& radius_y, const ImVec4& color);
+	/* Shapes are queued and submitted together, this must run before the render target changes */
+	void FlushPrimitives();
 
 	void SetRenderTarget(SDL_Texture* texture) const;
 	void SetRenderDrawColor(const int& r, const int& g, const int& b, const int& a) const;
@@ -33,17 +39,32 @@ public:
 
 	void RenderTexture(SDL_Texture* texture, SDL_Rect* source_rect, SDL_Rect* destination_rect);
 
+	/* Presents the next frames even when the canvas did not change */
+	void RequestRedraw();
+	/* Recomposes the whole canvas view, the workbench contents were lost */
+	void InvalidateWorkbench();
+	/* Nothing changed and the last frame has settled */
+	bool IsIdle() const;
+
+private:
+	void ComposeCanvas(const SDL_Rect& region);
+
+	static SDL_Color ToColor(const ImVec4& color);
+
 public:
 	SDL_Renderer* renderer;
-	SDL_Texture* texture_target;
-	SDL_Texture* texture_filter;
 	SDL_Texture* texture_workbench_target;
 	SDL_Texture* texture_anomaly_viewer_target;
 
-	int texture_target_width;
-	int texture_target_height;
-
 	Uint32 texture_format;
+
+private:
+	/* The workbench caches the composed canvas view, it is only redrawn where the canvas changed */
+	PrimitiveBatcher primitives;
+
+	SDL_Rect presented_view;
+	bool workbench_valid;
+	int redraw_frames;
 };
 
 #endif /* __RENDERER_H__ */
\ No newline at end of file
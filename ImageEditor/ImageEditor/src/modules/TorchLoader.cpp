@@ -69,6 +69,9 @@ cv::Mat TorchLoader::FastFlowInference(const std::string& path)
 		.at("anomaly_map").toTensor().data();
 	c10::cuda::CUDACachingAllocator::emptyCache();
 	t = t.mul(-255).clamp(0, 255).to(torch::kU8).to(torch::kCPU).detach().squeeze(0);
+
+	this->anomaly_map = cv::Mat((int)t.size(1), (int)t.size(2), CV_8UC1, t.contiguous().data_ptr()).clone();
+
 	t = t.repeat({ 3, 1, 1 });
 
 	img.release();
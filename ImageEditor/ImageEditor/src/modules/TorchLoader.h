@@ -59,6 +59,9 @@ private:
 public:
 	StyleTransferParams style_transfer_params;
 
+	/* Raw single channel output of the last FastFlow inference, before the color map */
+	cv::Mat anomaly_map;
+
 private:
 	/* FastFlow */
 	torch::jit::script::Module fastflow_model;
@@ -0,0 +1,126 @@
+#include <cmath>
+
+#include "TiledCanvas.h"
+#include "BrushEngine.h"
+
+BrushEngine::BrushEngine()
+	: stamp_diameter(0), stamp_hardness(-1.0f), stamp_flow(-1.0f), params(BrushEngine::DefaultParams()), diameter(1), color(0x000000FF),
+	last_x(0.0f), last_y(0.0f), distance_to_next(0.0f), stroking(false)
+{
+
+}
+
+BrushEngine::~BrushEngine()
+{
+
+}
+
+void BrushEngine::BeginStroke(TiledCanvas& canvas, const float& x, const float& y, const int& diameter, const Uint32& color, const BrushParams& params)
+{
+	this->params = params;
+	this->diameter = SDL_max(diameter, 1);
+	this->color = color;
+
+	this->BuildStamp();
+
+	this->stroking = true;
+	this->last_x = x;
+	this->last_y = y;
+
+	this->PlaceStamp(canvas, x, y);
+
+	this->distance_to_next = SDL_max(this->params.SPACING * this->diameter, 1.0f);
+}
+
+void BrushEngine::StrokeTo(TiledCanvas& canvas, const float& x, const float& y)
+{
+	if (!this->stroking)
+		return;
+
+	float dx = x - this->last_x;
+	float dy = y - this->last_y;
+	float length = std::sqrt(dx * dx + dy * dy);
+	float spacing = SDL_max(this->params.SPACING * this->diameter, 1.0f);
+
+	while (this->distance_to_next <= length)
+	{
+		float t = this->distance_to_next / length;
+
+		this->PlaceStamp(canvas, this->last_x + dx * t, this->last_y + dy * t);
+		this->distance_to_next += spacing;
+	}
+
+	this->distance_to_next -= length;
+	this->last_x = x;
+	this->last_y = y;
+}
+
+void BrushEngine::EndStroke()
+{
+	this->stroking = false;
+}
+
+bool BrushEngine::IsStroking() const
+{
+	return this->stroking;
+}
+
+BrushParams BrushEngine::DefaultParams()
+{
+	BrushParams params;
+	params.SPACING = 0.1f;
+	params.HARDNESS = 1.0f;
+	params.FLOW = 1.0f;
+
+	return params;
+}
+
+void BrushEngine::BuildStamp()
+{
+	if (this->stamp_diameter == this->diameter && this->stamp_hardness == this->params.HARDNESS && this->stamp_flow == this->params.FLOW)
+		return;
+
+	int size = this->diameter;
+	float radius = size * 0.5f;
+	float hardness = SDL_clamp(this->params.HARDNESS, 0.0f, 1.0f);
+	float flow = SDL_clamp(this->params.FLOW, 0.0f, 1.0f);
+
+	this->stamp.resize((size_t)size * size);
+
+	for (int y = 0; y < size; ++y)
+	{
+		for (int x = 0; x < size; ++x)
+		{
+			float dx = x + 0.5f - radius;
+			float dy = y + 0.5f - radius;
+			float distance = std::sqrt(dx * dx + dy * dy);
+
+			/* One pixel of antialiasing at the rim, then a linear falloff from the hard core */
+			float coverage = SDL_clamp(radius - distance + 0.5f, 0.0f, 1.0f);
+			float normalized = distance / radius;
+
+			if (hardness < 1.0f && normalized > hardness)
+			{
+				coverage *= SDL_clamp((1.0f - normalized) / (1.0f - hardness), 0.0f, 1.0f);
+			}
+
+			this->stamp[(size_t)y * size + x] = (Uint8)(coverage * flow * 255.0f + 0.5f);
+		}
+	}
+
+	this->stamp_diameter = this->diameter;
+	this->stamp_hardness = this->params.HARDNESS;
+	this->stamp_flow = this->params.FLOW;
+}
+
+void BrushEngine::PlaceStamp(TiledCanvas& canvas, const float& x, const float& y)
+{
+	SDL_Rect rect = {
+		(int)std::floor(x - this->diameter * 0.5f + 0.5f),
+		(int)std::floor(y - this->diameter * 0.5f + 0.5f),
+		this->diameter,
+		this->diameter
+	};
+
+	canvas.BlendMask(this->stamp.data(), this->diameter, rect, this->color);
+}
\ No newline at end of file
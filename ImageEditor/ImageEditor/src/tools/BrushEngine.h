@@ -0,0 +1,55 @@
+#ifndef __BRUSH_ENGINE_H__
+#define __BRUSH_ENGINE_H__
+
+#include <vector>
+
+#include "SDL.h"
+
+class TiledCanvas;
+
+struct BrushParams
+{
+	float SPACING;
+	float HARDNESS;
+	float FLOW;
+};
+
+class BrushEngine
+{
+public:
+	BrushEngine();
+	~BrushEngine();
+
+	/* Positions are in canvas pixels and may fall between pixels. The first stamp lands on the starting point */
+	void BeginStroke(TiledCanvas& canvas, const float& x, const float& y, const int& diameter, const Uint32& color, const BrushParams& params);
+	/* Places stamps every SPACING * diameter pixels along the segment, the leftover distance carries over to the next call */
+	void StrokeTo(TiledCanvas& canvas, const float& x, const float& y);
+	void EndStroke();
+
+	bool IsStroking() const;
+
+	static BrushParams DefaultParams();
+
+private:
+	void BuildStamp();
+	void PlaceStamp(TiledCanvas& canvas, const float& x, const float& y);
+
+private:
+	/* Coverage of a single dab, rebuilt only when the diameter, hardness or flow change */
+	std::vector<Uint8> stamp;
+	int stamp_diameter;
+	float stamp_hardness;
+	float stamp_flow;
+
+	BrushParams params;
+	int diameter;
+	Uint32 color;
+
+	float last_x;
+	float last_y;
+	float distance_to_next;
+
+	bool stroking;
+};
+
+#endif /* __BRUSH_ENGINE_H__ */
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include <cstring>
+
+#include "utils/Parallel.h"
+#include "ColorSpace.h"
+#include "ColorAdjustment.h"
+
+#define COLOR_ADJUSTMENT_CHUNK 512
+
+void ColorAdjustment::Apply(const Uint32* src, const ptrdiff_t& src_stride, Uint32* dst, const ptrdiff_t& dst_stride, const int& width, const int& height, const ColorAdjustmentParams& params)
+{
+	ParallelFor(0, height, 16, [&](const int& first, const int& last)
+	{
+		for (int row = first; row < last; ++row)
+		{
+			Uint32* dst_row = dst + row * dst_stride;
+
+			memcpy(dst_row, src + row * src_stride, width * sizeof(Uint32));
+			ColorAdjustment::AdjustRow(dst_row, width, params);
+		}
+	});
+}
+
+ColorAdjustmentParams ColorAdjustment::DefaultParams()
+{
+	return { COLOR_MODEL::HSV, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+}
+
+void ColorAdjustment::AdjustRow(Uint32* pixels, const int& count, const ColorAdjustmentParams& params)
+{
+	alignas(16) float x[COLOR_ADJUSTMENT_CHUNK];
+	alignas(16) float y[COLOR_ADJUSTMENT_CHUNK];
+	alignas(16) float z[COLOR_ADJUSTMENT_CHUNK];
+
+	bool white_balance = params.TEMPERATURE != 0.0f || params.TINT != 0.0f;
+	bool hue_saturation = params.HUE != 0.0f || params.SATURATION != 0.0f || params.LIGHTNESS != 0.0f;
+
+	for (int offset = 0; offset < count; offset += COLOR_ADJUSTMENT_CHUNK)
+	{
+		int chunk = SDL_min(COLOR_ADJUSTMENT_CHUNK, count - offset);
+
+		if (white_balance)
+		{
+			ColorAdjustment::AdjustWhiteBalance(pixels + offset, chunk, params, x, y, z);
+		}
+
+		if (hue_saturation)
+		{
+			ColorAdjustment::AdjustHueSaturation(pixels + offset, chunk, params, x, y, z);
+		}
+	}
+}
+
+void ColorAdjustment::AdjustWhiteBalance(Uint32* pixels, const int& count, const ColorAdjustmentParams& params, float* x, float* y, float* z)
+{
+	/* Shift the chroma axes in Lab, scaled by lightness so that black stays neutral */
+	float a_shift = params.TINT * 0.25f / 100.0f;
+	float b_shift = params.TEMPERATURE * 0.25f / 100.0f;
+
+	ColorSpace::DecodeRow(pixels, count, x, y, z, true);
+	ColorSpace::LinearRGBToLabRow(x, y, z, count);
+
+	for (int i = 0; i < count; ++i)
+	{
+		y[i] += a_shift * x[i];
+		z[i] += b_shift * x[i];
+	}
+
+	ColorSpace::LabToLinearRGBRow(x, y, z, count);
+	ColorSpace::EncodeRow(x, y, z, pixels, count, true);
+}
+
+void ColorAdjustment::AdjustHueSaturation(Uint32* pixels, const int& count, const ColorAdjustmentParams& params, float* x, float* y, float* z)
+{
+	float hue_shift = params.HUE / 360.0f;
+	float saturation_scale = 1.0f + params.SATURATION / 100.0f;
+	float lightness = params.LIGHTNESS / 100.0f;
+
+	ColorSpace::DecodeRow(pixels, count, x, y, z, false);
+
+	if (params.MODEL == COLOR_MODEL::HSV)
+		ColorSpace::RGBToHSVRow(x, y, z, count);
+	else
+		ColorSpace::RGBToHSLRow(x, y, z, count);
+
+	for (int i = 0; i < count; ++i)
+	{
+		x[i] += hue_shift;
+		y[i] = SDL_clamp(y[i] * saturation_scale, 0.0f, 1.0f);
+		z[i] = lightness > 0.0f ? z[i] + (1.0f - z[i]) * lightness : z[i] * (1.0f + lightness);
+	}
+
+	if (params.MODEL == COLOR_MODEL::HSV)
+		ColorSpace::HSVToRGBRow(x, y, z, count);
+	else
+		ColorSpace::HSLToRGBRow(x, y, z, count);
+
+	ColorSpace::EncodeRow(x, y, z, pixels, count, false);
+}
\ No newline at end of file
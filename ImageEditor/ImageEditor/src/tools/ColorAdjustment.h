@@ -0,0 +1,38 @@
+#ifndef __COLOR_ADJUSTMENT_H__
+#define __COLOR_ADJUSTMENT_H__
+
+#include <cstddef>
+
+#include "SDL.h"
+
+enum class COLOR_MODEL
+{
+	HSV = 0,
+	HSL
+};
+
+struct ColorAdjustmentParams
+{
+	COLOR_MODEL MODEL;
+	float HUE;
+	float SATURATION;
+	float LIGHTNESS;
+	float TEMPERATURE;
+	float TINT;
+};
+
+class ColorAdjustment
+{
+public:
+	/* Hue is expressed in degrees, every other parameter as a percentage in [-100, 100] */
+	static void Apply(const Uint32* src, const ptrdiff_t& src_stride, Uint32* dst, const ptrdiff_t& dst_stride, const int& width, const int& height, const ColorAdjustmentParams& params);
+
+	static ColorAdjustmentParams DefaultParams();
+
+private:
+	static void AdjustRow(Uint32* pixels, const int& count, const ColorAdjustmentParams& params);
+	static void AdjustWhiteBalance(Uint32* pixels, const int& count, const ColorAdjustmentParams& params, float* x, float* y, float* z);
+	static void AdjustHueSaturation(Uint32* pixels, const int& count, const ColorAdjustmentParams& params, float* x, float* y, float* z);
+};
+
+#endif /* __COLOR_ADJUSTMENT_H__ */
\ No newline at end of file
@@ -0,0 +1,366 @@
+#include <algorithm>
+#include <cfloat>
+#include <mutex>
+#include <emmintrin.h>
+
+#include "modules/Editor.h"
+#include "utils/Parallel.h"
+#include "Application.h"
+#include "ColorQuantization.h"
+
+#define COLOR_QUANTIZATION_OCTREE_DEPTH 5
+#define COLOR_QUANTIZATION_PADDING 1e9f
+
+void ColorQuantization::ApplyReduceColors(const int& colors, const int& iterations)
+{
+	std::vector<Uint32> pixels;
+	int width, height;
+
+	App->editor->ReadCanvasPixels(pixels, width, height);
+
+	ColorQuantization::ReduceColors(pixels.data(), pixels.size(), colors, iterations);
+
+	App->editor->WriteCanvasPixels(pixels, width, height);
+}
+
+void ColorQuantization::ApplyPosterize(const int& levels)
+{
+	App->editor->TransformCanvasPixels([&](Uint32* pixels, const int& count)
+	{
+		ColorQuantization::Posterize(pixels, count, levels);
+	});
+}
+
+void ColorQuantization::ReduceColors(Uint32* pixels, const size_t& count, const int& colors, const int& iterations)
+{
+	if (count == 0)
+		return;
+
+	Histogram histogram;
+	ColorQuantization::BuildHistogram(pixels, count, histogram);
+
+	std::vector<int> bins;
+	for (int bin = 0; bin < COLOR_QUANTIZATION_BINS; ++bin)
+	{
+		if (histogram.count[bin] != 0)
+		{
+			bins.push_back(bin);
+		}
+	}
+
+	Palette palette;
+	ColorQuantization::BuildOctreePalette(histogram, SDL_clamp(colors, 1, COLOR_QUANTIZATION_MAX_COLORS), palette);
+	ColorQuantization::RefinePalette(histogram, bins, iterations, palette);
+
+	/* Every pixel of a bin maps to the palette entry nearest to the bin mean */
+	std::vector<Uint32> lut(COLOR_QUANTIZATION_BINS, 0);
+
+	for (const int& bin : bins)
+	{
+		float n = (float)histogram.count[bin];
+		int nearest = ColorQuantization::FindNearest(palette,
+			histogram.sum[bin * 3 + 0] / n, histogram.sum[bin * 3 + 1] / n, histogram.sum[bin * 3 + 2] / n);
+
+		Uint32 r = (Uint32)SDL_clamp(palette.r[nearest] + 0.5f, 0.0f, 255.0f);
+		Uint32 g = (Uint32)SDL_clamp(palette.g[nearest] + 0.5f, 0.0f, 255.0f);
+		Uint32 b = (Uint32)SDL_clamp(palette.b[nearest] + 0.5f, 0.0f, 255.0f);
+
+		lut[bin] = (r << 24) | (g << 16) | (b << 8);
+	}
+
+	ParallelFor(0, (int)((count + 4095) / 4096), 64, [&](const int& first, const int& last)
+	{
+		size_t end = SDL_min((size_t)last * 4096, count);
+
+		for (size_t i = (size_t)first * 4096; i < end; ++i)
+		{
+			pixels[i] = lut[ColorQuantization::BinIndex(pixels[i])] | (pixels[i] & 0xFF);
+		}
+	});
+}
+
+void ColorQuantization::Posterize(Uint32* pixels, const size_t& count, const int& levels)
+{
+	int steps = SDL_max(levels, 2) - 1;
+
+	Uint32 lut[256];
+	for (int value = 0; value < 256; ++value)
+	{
+		lut[value] = (Uint32)(((value * steps + 127) / 255) * 255 / steps);
+	}
+
+	ParallelFor(0, (int)((count + 4095) / 4096), 64, [&](const int& first, const int& last)
+	{
+		size_t end = SDL_min((size_t)last * 4096, count);
+
+		for (size_t i = (size_t)first * 4096; i < end; ++i)
+		{
+			Uint32 pixel = pixels[i];
+
+			pixels[i] = (lut[pixel >> 24] << 24) | (lut[(pixel >> 16) & 0xFF] << 16) | (lut[(pixel >> 8) & 0xFF] << 8) | (pixel & 0xFF);
+		}
+	});
+}
+
+void ColorQuantization::BuildHistogram(const Uint32* pixels, const size_t& count, Histogram& histogram)
+{
+	histogram.count.assign(COLOR_QUANTIZATION_BINS, 0);
+	histogram.sum.assign(COLOR_QUANTIZATION_BINS * 3, 0);
+
+	std::mutex merge_mutex;
+
+	/* Each chunk fills a private histogram and merges it once */
+	ParallelFor(0, (int)((count + 65535) / 65536), 16, [&](const int& first, const int& last)
+	{
+		std::vector<Uint32> local_count(COLOR_QUANTIZATION_BINS, 0);
+		std::vector<Uint64> local_sum(COLOR_QUANTIZATION_BINS * 3, 0);
+
+		size_t end = SDL_min((size_t)last * 65536, count);
+
+		for (size_t i = (size_t)first * 65536; i < end; ++i)
+		{
+			Uint32 pixel = pixels[i];
+			int bin = ColorQuantization::BinIndex(pixel);
+
+			local_count[bin]++;
+			local_sum[bin * 3 + 0] += pixel >> 24;
+			local_sum[bin * 3 + 1] += (pixel >> 16) & 0xFF;
+			local_sum[bin * 3 + 2] += (pixel >> 8) & 0xFF;
+		}
+
+		std::lock_guard<std::mutex> lock(merge_mutex);
+
+		for (int bin = 0; bin < COLOR_QUANTIZATION_BINS; ++bin)
+		{
+			histogram.count[bin] += local_count[bin];
+			histogram.sum[bin * 3 + 0] += local_sum[bin * 3 + 0];
+			histogram.sum[bin * 3 + 1] += local_sum[bin * 3 + 1];
+			histogram.sum[bin * 3 + 2] += local_sum[bin * 3 + 2];
+		}
+	});
+}
+
+void ColorQuantization::BuildOctreePalette(const Histogram& histogram, const int& colors, Palette& palette)
+{
+	struct Node
+	{
+		int children[8];
+		Uint64 count;
+		Uint64 sum[3];
+		bool leaf;
+	};
+
+	std::vector<Node> nodes(1, Node{ { -1, -1, -1, -1, -1, -1, -1, -1 }, 0, { 0, 0, 0 }, false });
+	std::vector<std::vector<int>> levels(COLOR_QUANTIZATION_OCTREE_DEPTH);
+	int leaf_count = 0;
+
+	levels[0].push_back(0);
+
+	/* A bin is a full path of the tree, one bit of each 5 bit channel per level */
+	for (int bin = 0; bin < COLOR_QUANTIZATION_BINS; ++bin)
+	{
+		if (histogram.count[bin] == 0)
+			continue;
+
+		int r = bin >> 10, g = (bin >> 5) & 31, b = bin & 31;
+		int node = 0;
+
+		for (int level = 0; level <= COLOR_QUANTIZATION_OCTREE_DEPTH; ++level)
+		{
+			nodes[node].count += histogram.count[bin];
+			nodes[node].sum[0] += histogram.sum[bin * 3 + 0];
+			nodes[node].sum[1] += histogram.sum[bin * 3 + 1];
+			nodes[node].sum[2] += histogram.sum[bin * 3 + 2];
+
+			if (level == COLOR_QUANTIZATION_OCTREE_DEPTH)
+				break;
+
+			int shift = COLOR_QUANTIZATION_OCTREE_DEPTH - 1 - level;
+			int child = (((r >> shift) & 1) << 2) | (((g >> shift) & 1) << 1) | ((b >> shift) & 1);
+
+			if (nodes[node].children[child] < 0)
+			{
+				bool leaf = level + 1 == COLOR_QUANTIZATION_OCTREE_DEPTH;
+
+				nodes[node].children[child] = (int)nodes.size();
+				nodes.push_back(Node{ { -1, -1, -1, -1, -1, -1, -1, -1 }, 0, { 0, 0, 0 }, leaf });
+
+				if (leaf)
+					leaf_count++;
+				else
+					levels[level + 1].push_back(nodes[node].children[child]);
+			}
+
+			node = nodes[node].children[child];
+		}
+	}
+
+	/* Fold the lightest nodes of the deepest level first, their children are always leaves */
+	for (int level = COLOR_QUANTIZATION_OCTREE_DEPTH - 1; level >= 0 && leaf_count > colors; --level)
+	{
+		std::vector<int>& candidates = levels[level];
+
+		std::sort(candidates.begin(), candidates.end(), [&](const int& a, const int& b)
+		{
+			return nodes[a].count < nodes[b].count;
+		});
+
+		for (size_t i = 0; i < candidates.size() && leaf_count > colors; ++i)
+		{
+			Node& node = nodes[candidates[i]];
+			int children = 0;
+
+			for (int& child : node.children)
+			{
+				if (child >= 0)
+				{
+					children++;
+					child = -1;
+				}
+			}
+
+			node.leaf = true;
+			leaf_count -= children - 1;
+		}
+	}
+
+	std::vector<int> leaves;
+	std::vector<int> stack(1, 0);
+
+	while (!stack.empty())
+	{
+		int node = stack.back();
+		stack.pop_back();
+
+		if (nodes[node].leaf)
+		{
+			leaves.push_back(node);
+			continue;
+		}
+
+		for (const int& child : nodes[node].children)
+		{
+			if (child >= 0)
+			{
+				stack.push_back(child);
+			}
+		}
+	}
+
+	ColorQuantization::SetPaletteSize(palette, SDL_max((int)leaves.size(), 1));
+
+	for (size_t i = 0; i < leaves.size(); ++i)
+	{
+		const Node& node = nodes[leaves[i]];
+
+		palette.r[i] = (float)node.sum[0] / node.count;
+		palette.g[i] = (float)node.sum[1] / node.count;
+		palette.b[i] = (float)node.sum[2] / node.count;
+	}
+}
+
+void ColorQuantization::RefinePalette(const Histogram& histogram, const std::vector<int>& bins, const int& iterations, Palette& palette)
+{
+	std::vector<double> sums((size_t)palette.size * 3);
+	std::vector<Uint64> counts(palette.size);
+
+	/* Lloyd iterations over the histogram bins weighted by their pixel counts, so the cost does not depend on the image size */
+	for (int iteration = 0; iteration < iterations; ++iteration)
+	{
+		std::fill(sums.begin(), sums.end(), 0.0);
+		std::fill(counts.begin(), counts.end(), 0);
+
+		for (const int& bin : bins)
+		{
+			double n = histogram.count[bin];
+			double r = histogram.sum[bin * 3 + 0], g = histogram.sum[bin * 3 + 1], b = histogram.sum[bin * 3 + 2];
+
+			int nearest = ColorQuantization::FindNearest(palette, (float)(r / n), (float)(g / n), (float)(b / n));
+
+			sums[nearest * 3 + 0] += r;
+			sums[nearest * 3 + 1] += g;
+			sums[nearest * 3 + 2] += b;
+			counts[nearest] += histogram.count[bin];
+		}
+
+		bool changed = false;
+
+		for (int i = 0; i < palette.size; ++i)
+		{
+			if (counts[i] == 0)
+				continue;
+
+			float r = (float)(sums[i * 3 + 0] / counts[i]);
+			float g = (float)(sums[i * 3 + 1] / counts[i]);
+			float b = (float)(sums[i * 3 + 2] / counts[i]);
+
+			changed |= r != palette.r[i] || g != palette.g[i] || b != palette.b[i];
+
+			palette.r[i] = r;
+			palette.g[i] = g;
+			palette.b[i] = b;
+		}
+
+		if (!changed)
+			break;
+	}
+}
+
+void ColorQuantization::SetPaletteSize(Palette& palette, const int& size)
+{
+	size_t padded = ((size_t)size + 3) & ~(size_t)3;
+
+	palette.r.assign(padded, COLOR_QUANTIZATION_PADDING);
+	palette.g.assign(padded, COLOR_QUANTIZATION_PADDING);
+	palette.b.assign(padded, COLOR_QUANTIZATION_PADDING);
+	palette.size = size;
+}
+
+int ColorQuantization::FindNearest(const Palette& palette, const float& r, const float& g, const float& b)
+{
+	const __m128 vr = _mm_set1_ps(r);
+	const __m128 vg = _mm_set1_ps(g);
+	const __m128 vb = _mm_set1_ps(b);
+	const __m128i four = _mm_set1_epi32(4);
+
+	__m128 best_distance = _mm_set1_ps(FLT_MAX);
+	__m128i best_index = _mm_setzero_si128();
+	__m128i index = _mm_setr_epi32(0, 1, 2, 3);
+
+	/* Four palette entries per step, each lane keeps its own best candidate */
+	for (size_t i = 0; i < palette.r.size(); i += 4)
+	{
+		__m128 dr = _mm_sub_ps(_mm_loadu_ps(palette.r.data() + i), vr);
+		__m128 dg = _mm_sub_ps(_mm_loadu_ps(palette.g.data() + i), vg);
+		__m128 db = _mm_sub_ps(_mm_loadu_ps(palette.b.data() + i), vb);
+
+		__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db));
+		__m128i closer = _mm_castps_si128(_mm_cmplt_ps(distance, best_distance));
+
+		best_distance = _mm_min_ps(distance, best_distance);
+		best_index = _mm_or_si128(_mm_and_si128(closer, index), _mm_andnot_si128(closer, best_index));
+		index = _mm_add_epi32(index, four);
+	}
+
+	alignas(16) float distances[4];
+	alignas(16) int indices[4];
+
+	_mm_store_ps(distances, best_distance);
+	_mm_store_si128((__m128i*)indices, best_index);
+
+	int nearest = 0;
+	for (int lane = 1; lane < 4; ++lane)
+	{
+		if (distances[lane] < distances[nearest])
+		{
+			nearest = lane;
+		}
+	}
+
+	return indices[nearest];
+}
+
+int ColorQuantization::BinIndex(const Uint32& pixel)
+{
+	return (int)(((pixel >> 17) & 0x7C00) | ((pixel >> 14) & 0x03E0) | ((pixel >> 11) & 0x001F));
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef __COLOR_QUANTIZATION_H__
+#define __COLOR_QUANTIZATION_H__
+
+#include <cstddef>
+#include <vector>
+
+#include "SDL.h"
+
+#define COLOR_QUANTIZATION_BINS 32768
+#define COLOR_QUANTIZATION_MAX_COLORS 256
+
+class ColorQuantization
+{
+public:
+	static void ApplyReduceColors(const int& colors, const int& iterations);
+	static void ApplyPosterize(const int& levels);
+
+	/* Octree palette over an RGB555 histogram, refined by k-means on the histogram bins. Alpha is preserved */
+	static void ReduceColors(Uint32* pixels, const size_t& count, const int& colors, const int& iterations);
+	static void Posterize(Uint32* pixels, const size_t& count, const int& levels);
+
+private:
+	struct Histogram
+	{
+		std::vector<Uint32> count;
+		std::vector<Uint64> sum;
+	};
+
+	/* Channels are stored apart and padded to a multiple of 4 with entries no color is ever close to */
+	struct Palette
+	{
+		std::vector<float> r;
+		std::vector<float> g;
+		std::vector<float> b;
+		int size;
+	};
+
+	static void BuildHistogram(const Uint32* pixels, const size_t& count, Histogram& histogram);
+	static void BuildOctreePalette(const Histogram& histogram, const int& colors, Palette& palette);
+	static void RefinePalette(const Histogram& histogram, const std::vector<int>& bins, const int& iterations, Palette& palette);
+
+	static void SetPaletteSize(Palette& palette, const int& size);
+	static int FindNearest(const Palette& palette, const float& r, const float& g, const float& b);
+
+	static int BinIndex(const Uint32& pixel);
+};
+
+#endif /* __COLOR_QUANTIZATION_H__ */
\ No newline at end of file
@@ -0,0 +1,479 @@
+#include <cmath>
+
+#include "ColorSpace.h"
+
+void ColorSpace::DecodeRow(const Uint32* pixels, const int& count, float* r, float* g, float* b, const bool& linear)
+{
+	const std::array<float, 256>& lut = ColorSpace::GetDecodeLUT();
+
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i p = _mm_loadu_si128((const __m128i*)(pixels + i));
+
+		__m128i pr = _mm_srli_epi32(p, 24);
+		__m128i pg = _mm_and_si128(_mm_srli_epi32(p, 16), mask);
+		__m128i pb = _mm_and_si128(_mm_srli_epi32(p, 8), mask);
+
+		if (linear)
+		{
+			alignas(16) int index_r[4], index_g[4], index_b[4];
+			_mm_store_si128((__m128i*)index_r, pr);
+			_mm_store_si128((__m128i*)index_g, pg);
+			_mm_store_si128((__m128i*)index_b, pb);
+
+			_mm_storeu_ps(r + i, _mm_setr_ps(lut[index_r[0]], lut[index_r[1]], lut[index_r[2]], lut[index_r[3]]));
+			_mm_storeu_ps(g + i, _mm_setr_ps(lut[index_g[0]], lut[index_g[1]], lut[index_g[2]], lut[index_g[3]]));
+			_mm_storeu_ps(b + i, _mm_setr_ps(lut[index_b[0]], lut[index_b[1]], lut[index_b[2]], lut[index_b[3]]));
+		}
+		else
+		{
+			_mm_storeu_ps(r + i, _mm_mul_ps(_mm_cvtepi32_ps(pr), scale));
+			_mm_storeu_ps(g + i, _mm_mul_ps(_mm_cvtepi32_ps(pg), scale));
+			_mm_storeu_ps(b + i, _mm_mul_ps(_mm_cvtepi32_ps(pb), scale));
+		}
+	}
+
+	for (; i < count; ++i)
+	{
+		Uint32 index_r = (pixels[i] >> 24) & 0xFF;
+		Uint32 index_g = (pixels[i] >> 16) & 0xFF;
+		Uint32 index_b = (pixels[i] >> 8) & 0xFF;
+
+		r[i] = linear ? lut[index_r] : index_r / 255.0f;
+		g[i] = linear ? lut[index_g] : index_g / 255.0f;
+		b[i] = linear ? lut[index_b] : index_b / 255.0f;
+	}
+}
+
+void ColorSpace::EncodeRow(const float* r, const float* g, const float* b, Uint32* pixels, const int& count, const bool& linear)
+{
+	const std::array<Uint8, SRGB_ENCODE_LUT_SIZE>& lut = ColorSpace::GetEncodeLUT();
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set1_ps(linear ? (float)(SRGB_ENCODE_LUT_SIZE - 1) : 255.0f);
+	const __m128i alpha_mask = _mm_set1_epi32(0xFF);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i ir = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(r + i), zero), one), scale));
+		__m128i ig = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(g + i), zero), one), scale));
+		__m128i ib = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(b + i), zero), one), scale));
+
+		if (linear)
+		{
+			alignas(16) int index_r[4], index_g[4], index_b[4];
+			_mm_store_si128((__m128i*)index_r, ir);
+			_mm_store_si128((__m128i*)index_g, ig);
+			_mm_store_si128((__m128i*)index_b, ib);
+
+			ir = _mm_setr_epi32(lut[index_r[0]], lut[index_r[1]], lut[index_r[2]], lut[index_r[3]]);
+			ig = _mm_setr_epi32(lut[index_g[0]], lut[index_g[1]], lut[index_g[2]], lut[index_g[3]]);
+			ib = _mm_setr_epi32(lut[index_b[0]], lut[index_b[1]], lut[index_b[2]], lut[index_b[3]]);
+		}
+
+		__m128i alpha = _mm_and_si128(_mm_loadu_si128((const __m128i*)(pixels + i)), alpha_mask);
+
+		__m128i packed = _mm_or_si128(
+			_mm_or_si128(_mm_slli_epi32(ir, 24), _mm_slli_epi32(ig, 16)),
+			_mm_or_si128(_mm_slli_epi32(ib, 8), alpha)
+		);
+
+		_mm_storeu_si128((__m128i*)(pixels + i), packed);
+	}
+
+	for (; i < count; ++i)
+	{
+		Uint8 out_r, out_g, out_b;
+
+		if (linear)
+		{
+			out_r = ColorSpace::LinearToSRGB(r[i]);
+			out_g = ColorSpace::LinearToSRGB(g[i]);
+			out_b = ColorSpace::LinearToSRGB(b[i]);
+		}
+		else
+		{
+			out_r = (Uint8)(SDL_clamp(r[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+			out_g = (Uint8)(SDL_clamp(g[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+			out_b = (Uint8)(SDL_clamp(b[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+		}
+
+		pixels[i] = ((Uint32)out_r << 24) | ((Uint32)out_g << 16) | ((Uint32)out_b << 8) | (pixels[i] & 0xFF);
+	}
+}
+
+void ColorSpace::LumaRow(const Uint32* pixels, const int& count, Uint8* luma)
+{
+	for (int i = 0; i < count; ++i)
+	{
+		Uint32 r = (pixels[i] >> 24) & 0xFF;
+		Uint32 g = (pixels[i] >> 16) & 0xFF;
+		Uint32 b = (pixels[i] >> 8) & 0xFF;
+
+		luma[i] = (Uint8)((77 * r + 150 * g + 29 * b + 128) >> 8);
+	}
+}
+
+void ColorSpace::ShiftLumaRow(Uint32* pixels, const Uint8* luma, const Uint8* new_luma, const int& count)
+{
+	const __m128i color_mask = _mm_set1_epi32((int)0xFFFFFF00);
+
+	int i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m128i before = _mm_loadu_si128((const __m128i*)(luma + i));
+		__m128i after = _mm_loadu_si128((const __m128i*)(new_luma + i));
+
+		__m128i increase = _mm_subs_epu8(after, before);
+		__m128i decrease = _mm_subs_epu8(before, after);
+
+		/* Broadcast every byte to the R, G and B bytes of its pixel */
+		__m128i increase_16[2] = { _mm_unpacklo_epi8(increase, increase), _mm_unpackhi_epi8(increase, increase) };
+		__m128i decrease_16[2] = { _mm_unpacklo_epi8(decrease, decrease), _mm_unpackhi_epi8(decrease, decrease) };
+
+		for (int half = 0; half < 2; ++half)
+		{
+			for (int quarter = 0; quarter < 2; ++quarter)
+			{
+				__m128i up = quarter == 0 ? _mm_unpacklo_epi16(increase_16[half], increase_16[half]) : _mm_unpackhi_epi16(increase_16[half], increase_16[half]);
+				__m128i down = quarter == 0 ? _mm_unpacklo_epi16(decrease_16[half], decrease_16[half]) : _mm_unpackhi_epi16(decrease_16[half], decrease_16[half]);
+
+				Uint32* block = pixels + i + half * 8 + quarter * 4;
+				__m128i p = _mm_loadu_si128((const __m128i*)block);
+
+				p = _mm_adds_epu8(p, _mm_and_si128(up, color_mask));
+				p = _mm_subs_epu8(p, _mm_and_si128(down, color_mask));
+
+				_mm_storeu_si128((__m128i*)block, p);
+			}
+		}
+	}
+
+	for (; i < count; ++i)
+	{
+		int delta = (int)new_luma[i] - (int)luma[i];
+
+		int r = SDL_clamp((int)((pixels[i] >> 24) & 0xFF) + delta, 0, 255);
+		int g = SDL_clamp((int)((pixels[i] >> 16) & 0xFF) + delta, 0, 255);
+		int b = SDL_clamp((int)((pixels[i] >> 8) & 0xFF) + delta, 0, 255);
+
+		pixels[i] = ((Uint32)r << 24) | ((Uint32)g << 16) | ((Uint32)b << 8) | (pixels[i] & 0xFF);
+	}
+}
+
+void ColorSpace::RGBToHSVRow(float* r, float* g, float* b, const int& count)
+{
+	ColorSpace::ProcessRow(r, g, b, count, [](__m128& x, __m128& y, __m128& z)
+	{
+		__m128 max = _mm_max_ps(_mm_max_ps(x, y), z);
+		__m128 min = _mm_min_ps(_mm_min_ps(x, y), z);
+		__m128 delta = _mm_sub_ps(max, min);
+
+		__m128 h = ColorSpace::Hue(x, y, z, max, delta);
+		__m128 s = _mm_and_ps(_mm_cmpgt_ps(max, _mm_setzero_ps()), _mm_div_ps(delta, _mm_max_ps(max, _mm_set1_ps(1e-6f))));
+
+		x = h;
+		y = s;
+		z = max;
+	});
+}
+
+void ColorSpace::HSVToRGBRow(float* h, float* s, float* v, const int& count)
+{
+	ColorSpace::ProcessRow(h, s, v, count, [](__m128& x, __m128& y, __m128& z)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 four = _mm_set1_ps(4.0f);
+		const __m128 six = _mm_set1_ps(6.0f);
+
+		__m128 hue = _mm_mul_ps(_mm_sub_ps(x, ColorSpace::Floor(x)), six);
+		__m128 chroma = _mm_mul_ps(z, y);
+
+		__m128 channels[3];
+		const float offsets[3] = { 5.0f, 3.0f, 1.0f };
+
+		for (int c = 0; c < 3; ++c)
+		{
+			__m128 k = _mm_add_ps(hue, _mm_set1_ps(offsets[c]));
+			k = _mm_sub_ps(k, _mm_mul_ps(six, ColorSpace::Floor(_mm_mul_ps(k, _mm_set1_ps(1.0f / 6.0f)))));
+
+			__m128 t = _mm_max_ps(zero, _mm_min_ps(_mm_min_ps(k, _mm_sub_ps(four, k)), one));
+			channels[c] = _mm_sub_ps(z, _mm_mul_ps(chroma, t));
+		}
+
+		x = channels[0];
+		y = channels[1];
+		z = channels[2];
+	});
+}
+
+void ColorSpace::RGBToHSLRow(float* r, float* g, float* b, const int& count)
+{
+	ColorSpace::ProcessRow(r, g, b, count, [](__m128& x, __m128& y, __m128& z)
+	{
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 sign = _mm_set1_ps(-0.0f);
+
+		__m128 max = _mm_max_ps(_mm_max_ps(x, y), z);
+		__m128 min = _mm_min_ps(_mm_min_ps(x, y), z);
+		__m128 delta = _mm_sub_ps(max, min);
+
+		__m128 l = _mm_mul_ps(_mm_add_ps(max, min), _mm_set1_ps(0.5f));
+		__m128 denominator = _mm_sub_ps(one, _mm_andnot_ps(sign, _mm_sub_ps(_mm_add_ps(l, l), one)));
+		__m128 s = _mm_and_ps(_mm_cmpgt_ps(delta, _mm_setzero_ps()), _mm_div_ps(delta, _mm_max_ps(denominator, _mm_set1_ps(1e-6f))));
+
+		x = ColorSpace::Hue(x, y, z, max, delta);
+		y = _mm_min_ps(s, one);
+		z = l;
+	});
+}
+
+void ColorSpace::HSLToRGBRow(float* h, float* s, float* l, const int& count)
+{
+	ColorSpace::ProcessRow(h, s, l, count, [](__m128& x, __m128& y, __m128& z)
+	{
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 minus_one = _mm_set1_ps(-1.0f);
+		const __m128 three = _mm_set1_ps(3.0f);
+		const __m128 nine = _mm_set1_ps(9.0f);
+		const __m128 twelve = _mm_set1_ps(12.0f);
+
+		__m128 hue = _mm_mul_ps(_mm_sub_ps(x, ColorSpace::Floor(x)), twelve);
+		__m128 amplitude = _mm_mul_ps(y, _mm_min_ps(z, _mm_sub_ps(one, z)));
+
+		__m128 channels[3];
+		const float offsets[3] = { 0.0f, 8.0f, 4.0f };
+
+		for (int c = 0; c < 3; ++c)
+		{
+			__m128 k = _mm_add_ps(hue, _mm_set1_ps(offsets[c]));
+			k = _mm_sub_ps(k, _mm_mul_ps(twelve, ColorSpace::Floor(_mm_mul_ps(k, _mm_set1_ps(1.0f / 12.0f)))));
+
+			__m128 t = _mm_max_ps(minus_one, _mm_min_ps(_mm_min_ps(_mm_sub_ps(k, three), _mm_sub_ps(nine, k)), one));
+			channels[c] = _mm_sub_ps(z, _mm_mul_ps(amplitude, t));
+		}
+
+		x = channels[0];
+		y = channels[1];
+		z = channels[2];
+	});
+}
+
+void ColorSpace::LinearRGBToLabRow(float* r, float* g, float* b, const int& count)
+{
+	ColorSpace::ProcessRow(r, g, b, count, [](__m128& x, __m128& y, __m128& z)
+	{
+		const __m128 epsilon = _mm_set1_ps(216.0f / 24389.0f);
+		const __m128 kappa = _mm_set1_ps(24389.0f / 27.0f / 116.0f);
+		const __m128 offset = _mm_set1_ps(16.0f / 116.0f);
+
+		/* sRGB to XYZ, rows already divided by the D65 white point */
+		__m128 t[3] = {
+			_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(0.4124564f / 0.95047f)), _mm_mul_ps(y, _mm_set1_ps(0.3575761f / 0.95047f))), _mm_mul_ps(z, _mm_set1_ps(0.1804375f / 0.95047f))),
+			_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(0.2126729f)), _mm_mul_ps(y, _mm_set1_ps(0.7151522f))), _mm_mul_ps(z, _mm_set1_ps(0.0721750f))),
+			_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(0.0193339f / 1.08883f)), _mm_mul_ps(y, _mm_set1_ps(0.1191920f / 1.08883f))), _mm_mul_ps(z, _mm_set1_ps(0.9503041f / 1.08883f)))
+		};
+
+		for (int c = 0; c < 3; ++c)
+		{
+			__m128 cube_root = ColorSpace::Cbrt(t[c]);
+			__m128 linear = _mm_add_ps(_mm_mul_ps(t[c], kappa), offset);
+
+			t[c] = ColorSpace::Select(_mm_cmpgt_ps(t[c], epsilon), cube_root, linear);
+		}
+
+		x = _mm_sub_ps(_mm_mul_ps(t[1], _mm_set1_ps(116.0f)), _mm_set1_ps(16.0f));
+		y = _mm_mul_ps(_mm_sub_ps(t[0], t[1]), _mm_set1_ps(500.0f));
+		z = _mm_mul_ps(_mm_sub_ps(t[1], t[2]), _mm_set1_ps(200.0f));
+	});
+}
+
+void ColorSpace::LabToLinearRGBRow(float* l, float* a, float* b, const int& count)
+{
+	ColorSpace::ProcessRow(l, a, b, count, [](__m128& x, __m128& y, __m128& z)
+	{
+		const __m128 epsilon = _mm_set1_ps(216.0f / 24389.0f);
+		const __m128 inverse_kappa = _mm_set1_ps(27.0f / 24389.0f);
+
+		__m128 fy = _mm_mul_ps(_mm_add_ps(x, _mm_set1_ps(16.0f)), _mm_set1_ps(1.0f / 116.0f));
+		__m128 f[3] = {
+			_mm_add_ps(fy, _mm_mul_ps(y, _mm_set1_ps(1.0f / 500.0f))),
+			fy,
+			_mm_sub_ps(fy, _mm_mul_ps(z, _mm_set1_ps(1.0f / 200.0f)))
+		};
+
+		for (int c = 0; c < 3; ++c)
+		{
+			__m128 cube = _mm_mul_ps(_mm_mul_ps(f[c], f[c]), f[c]);
+			__m128 linear = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(f[c], _mm_set1_ps(116.0f)), _mm_set1_ps(16.0f)), inverse_kappa);
+
+			f[c] = ColorSpace::Select(_mm_cmpgt_ps(cube, epsilon), cube, linear);
+		}
+
+		/* XYZ to sRGB, columns already multiplied by the D65 white point */
+		__m128 fx = _mm_mul_ps(f[0], _mm_set1_ps(0.95047f));
+		__m128 fz = _mm_mul_ps(f[2], _mm_set1_ps(1.08883f));
+
+		x = _mm_add_ps(_mm_add_ps(_mm_mul_ps(fx, _mm_set1_ps(3.2404542f)), _mm_mul_ps(f[1], _mm_set1_ps(-1.5371385f))), _mm_mul_ps(fz, _mm_set1_ps(-0.4985314f)));
+		y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(fx, _mm_set1_ps(-0.9692660f)), _mm_mul_ps(f[1], _mm_set1_ps(1.8760108f))), _mm_mul_ps(fz, _mm_set1_ps(0.0415560f)));
+		z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(fx, _mm_set1_ps(0.0556434f)), _mm_mul_ps(f[1], _mm_set1_ps(-0.2040259f))), _mm_mul_ps(fz, _mm_set1_ps(1.0572252f)));
+	});
+}
+
+float ColorSpace::SRGBToLinear(const Uint8& value)
+{
+	return ColorSpace::GetDecodeLUT()[value];
+}
+
+Uint8 ColorSpace::LinearToSRGB(const float& value)
+{
+	int index = (int)(SDL_clamp(value, 0.0f, 1.0f) * (SRGB_ENCODE_LUT_SIZE - 1) + 0.5f);
+
+	return ColorSpace::GetEncodeLUT()[index];
+}
+
+const std::array<float, 256>& ColorSpace::GetDecodeLUT()
+{
+	static const std::array<float, 256> lut = []()
+	{
+		std::array<float, 256> table;
+
+		for (int i = 0; i < 256; ++i)
+		{
+			float c = i / 255.0f;
+			table[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+		}
+
+		return table;
+	}();
+
+	return lut;
+}
+
+const std::array<Uint8, SRGB_ENCODE_LUT_SIZE>& ColorSpace::GetEncodeLUT()
+{
+	static const std::array<Uint8, SRGB_ENCODE_LUT_SIZE> lut = []()
+	{
+		std::array<Uint8, SRGB_ENCODE_LUT_SIZE> table;
+
+		for (int i = 0; i < SRGB_ENCODE_LUT_SIZE; ++i)
+		{
+			float l = i / (float)(SRGB_ENCODE_LUT_SIZE - 1);
+			float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+			table[i] = (Uint8)(SDL_clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+		}
+
+		return table;
+	}();
+
+	return lut;
+}
+
+template<typename Kernel>
+void ColorSpace::ProcessRow(float* x, float* y, float* z, const int& count, const Kernel& kernel)
+{
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 vx = _mm_loadu_ps(x + i);
+		__m128 vy = _mm_loadu_ps(y + i);
+		__m128 vz = _mm_loadu_ps(z + i);
+
+		kernel(vx, vy, vz);
+
+		_mm_storeu_ps(x + i, vx);
+		_mm_storeu_ps(y + i, vy);
+		_mm_storeu_ps(z + i, vz);
+	}
+
+	if (i < count)
+	{
+		alignas(16) float tail_x[4] = { 0.0f }, tail_y[4] = { 0.0f }, tail_z[4] = { 0.0f };
+
+		for (int j = i; j < count; ++j)
+		{
+			tail_x[j - i] = x[j];
+			tail_y[j - i] = y[j];
+			tail_z[j - i] = z[j];
+		}
+
+		__m128 vx = _mm_load_ps(tail_x);
+		__m128 vy = _mm_load_ps(tail_y);
+		__m128 vz = _mm_load_ps(tail_z);
+
+		kernel(vx, vy, vz);
+
+		_mm_store_ps(tail_x, vx);
+		_mm_store_ps(tail_y, vy);
+		_mm_store_ps(tail_z, vz);
+
+		for (int j = i; j < count; ++j)
+		{
+			x[j] = tail_x[j - i];
+			y[j] = tail_y[j - i];
+			z[j] = tail_z[j - i];
+		}
+	}
+}
+
+__m128 ColorSpace::Floor(const __m128& x)
+{
+	__m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+
+	return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, x), _mm_set1_ps(1.0f)));
+}
+
+__m128 ColorSpace::Cbrt(const __m128& x)
+{
+	/* Two range reductions by 8 bring every input above the Lab threshold into [0.125, 1.1], where a cubic plus one Newton step stays below 1e-4 */
+	const __m128 threshold = _mm_set1_ps(0.125f);
+	const __m128 eight = _mm_set1_ps(8.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	__m128 value = _mm_max_ps(x, _mm_setzero_ps());
+	__m128 scale = one;
+
+	for (int i = 0; i < 2; ++i)
+	{
+		__m128 mask = _mm_cmplt_ps(value, threshold);
+		value = ColorSpace::Select(mask, _mm_mul_ps(value, eight), value);
+		scale = _mm_mul_ps(scale, ColorSpace::Select(mask, half, one));
+	}
+
+	__m128 y = _mm_set1_ps(0.3860414572579788f);
+	y = _mm_add_ps(_mm_mul_ps(y, value), _mm_set1_ps(-1.0546234067349631f));
+	y = _mm_add_ps(_mm_mul_ps(y, value), _mm_set1_ps(1.3083834675876758f));
+	y = _mm_add_ps(_mm_mul_ps(y, value), _mm_set1_ps(0.3580398529805216f));
+
+	y = _mm_mul_ps(_mm_add_ps(_mm_add_ps(y, y), _mm_div_ps(value, _mm_mul_ps(y, y))), _mm_set1_ps(1.0f / 3.0f));
+
+	return _mm_mul_ps(y, scale);
+}
+
+__m128 ColorSpace::Select(const __m128& mask, const __m128& a, const __m128& b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+__m128 ColorSpace::Hue(const __m128& r, const __m128& g, const __m128& b, const __m128& max, const __m128& delta)
+{
+	const __m128 zero = _mm_setzero_ps();
+	__m128 inverse = _mm_div_ps(_mm_set1_ps(1.0f / 6.0f), _mm_max_ps(delta, _mm_set1_ps(1e-6f)));
+
+	__m128 hue_r = _mm_mul_ps(_mm_sub_ps(g, b), inverse);
+	__m128 hue_g = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(b, r), inverse), _mm_set1_ps(2.0f / 6.0f));
+	__m128 hue_b = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(r, g), inverse), _mm_set1_ps(4.0f / 6.0f));
+
+	__m128 hue = ColorSpace::Select(_mm_cmpeq_ps(max, r), hue_r, ColorSpace::Select(_mm_cmpeq_ps(max, g), hue_g, hue_b));
+	hue = _mm_add_ps(hue, _mm_and_ps(_mm_cmplt_ps(hue, zero), _mm_set1_ps(1.0f)));
+
+	return _mm_and_ps(_mm_cmpgt_ps(delta, zero), hue);
+}
\ No newline at end of file
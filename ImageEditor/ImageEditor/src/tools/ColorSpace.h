@@ -0,0 +1,48 @@
+#ifndef __COLOR_SPACE_H__
+#define __COLOR_SPACE_H__
+
+#include <array>
+#include <emmintrin.h>
+
+#include "SDL.h"
+
+#define SRGB_ENCODE_LUT_SIZE 4096
+
+class ColorSpace
+{
+public:
+	/* Pixels are packed as Renderer::texture_format (SDL_PIXELFORMAT_RGBA8888), planes hold values in [0, 1] */
+	static void DecodeRow(const Uint32* pixels, const int& count, float* r, float* g, float* b, const bool& linear);
+	static void EncodeRow(const float* r, const float* g, const float* b, Uint32* pixels, const int& count, const bool& linear);
+
+	/* Full range BT.601 luma. Moving Y with Cb and Cr fixed adds the same delta to R, G and B, so chroma is never stored */
+	static void LumaRow(const Uint32* pixels, const int& count, Uint8* luma);
+	static void ShiftLumaRow(Uint32* pixels, const Uint8* luma, const Uint8* new_luma, const int& count);
+
+	/* Conversions run in place over three planes. Hue, saturation and lightness/value are kept in [0, 1] */
+	static void RGBToHSVRow(float* r, float* g, float* b, const int& count);
+	static void HSVToRGBRow(float* h, float* s, float* v, const int& count);
+	static void RGBToHSLRow(float* r, float* g, float* b, const int& count);
+	static void HSLToRGBRow(float* h, float* s, float* l, const int& count);
+
+	/* CIE Lab relative to the D65 white point, the RGB planes must hold linear light */
+	static void LinearRGBToLabRow(float* r, float* g, float* b, const int& count);
+	static void LabToLinearRGBRow(float* l, float* a, float* b, const int& count);
+
+	static float SRGBToLinear(const Uint8& value);
+	static Uint8 LinearToSRGB(const float& value);
+
+private:
+	template<typename Kernel>
+	static void ProcessRow(float* x, float* y, float* z, const int& count, const Kernel& kernel);
+
+	static __m128 Floor(const __m128& x);
+	static __m128 Cbrt(const __m128& x);
+	static __m128 Select(const __m128& mask, const __m128& a, const __m128& b);
+	static __m128 Hue(const __m128& r, const __m128& g, const __m128& b, const __m128& max, const __m128& delta);
+
+	static const std::array<float, 256>& GetDecodeLUT();
+	static const std::array<Uint8, SRGB_ENCODE_LUT_SIZE>& GetEncodeLUT();
+};
+
+#endif /* __COLOR_SPACE_H__ */
\ No newline at end of file
@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <thread>
+
+#include "utils/Parallel.h"
+#include "ConnectedComponents.h"
+
+int ConnectedComponents::Label(const Uint8* mask, const int& width, const int& height, const CONNECTIVITY& connectivity, std::vector<int>& labels, std::vector<ComponentStats>& stats)
+{
+	size_t size = (size_t)width * height;
+
+	std::vector<int> parent(size);
+	labels.assign(size, 0);
+	stats.clear();
+
+	if (size == 0)
+		return 0;
+
+	/* Each band is labelled independently, provisional labels are pixel indices so bands never collide */
+	int band_count = SDL_max(1, SDL_min((int)std::thread::hardware_concurrency() * 4, height / 16));
+	int band_height = (height + band_count - 1) / band_count;
+	band_count = (height + band_height - 1) / band_height;
+
+	ParallelFor(0, band_count, 1, [&](const int& first, const int& last)
+	{
+		for (int band = first; band < last; ++band)
+		{
+			int first_row = band * band_height;
+			int last_row = SDL_min(first_row + band_height, height);
+
+			ConnectedComponents::LabelBand(mask, width, first_row, last_row, connectivity, parent.data());
+		}
+	});
+
+	for (int band = 1; band < band_count; ++band)
+	{
+		ConnectedComponents::MergeBandBorder(mask, width, band * band_height, connectivity, parent.data());
+	}
+
+	ParallelFor(0, height, 64, [&](const int& first, const int& last)
+	{
+		for (size_t i = (size_t)first * width; i < (size_t)last * width; ++i)
+		{
+			labels[i] = mask[i] ? ConnectedComponents::FindRootReadOnly(parent.data(), (int)i) : -1;
+		}
+	});
+
+	/* Roots become compact labels in scan order, parent is reused as the remap table */
+	int count = 0;
+
+	for (size_t i = 0; i < size; ++i)
+	{
+		if (labels[i] == (int)i)
+		{
+			parent[i] = ++count;
+		}
+	}
+
+	stats.resize(count);
+
+	for (int i = 0; i < count; ++i)
+	{
+		stats[i] = { i + 1, 0, { 0, 0, 0, 0 }, 0.0f, 0.0f };
+	}
+
+	std::vector<SDL_Rect> extents(count, { width, height, -1, -1 });
+	std::vector<double> sum_x(count, 0.0), sum_y(count, 0.0);
+
+	for (int row = 0; row < height; ++row)
+	{
+		for (int col = 0; col < width; ++col)
+		{
+			size_t i = (size_t)row * width + col;
+
+			if (labels[i] < 0)
+			{
+				labels[i] = 0;
+				continue;
+			}
+
+			int label = parent[labels[i]];
+			labels[i] = label;
+
+			ComponentStats& component = stats[label - 1];
+			SDL_Rect& extent = extents[label - 1];
+
+			++component.area;
+			sum_x[label - 1] += col;
+			sum_y[label - 1] += row;
+
+			extent.x = SDL_min(extent.x, col);
+			extent.y = SDL_min(extent.y, row);
+			extent.w = SDL_max(extent.w, col);
+			extent.h = SDL_max(extent.h, row);
+		}
+	}
+
+	for (int i = 0; i < count; ++i)
+	{
+		stats[i].bbox = { extents[i].x, extents[i].y, extents[i].w - extents[i].x + 1, extents[i].h - extents[i].y + 1 };
+		stats[i].centroid_x = (float)(sum_x[i] / stats[i].area);
+		stats[i].centroid_y = (float)(sum_y[i] / stats[i].area);
+	}
+
+	return count;
+}
+
+void ConnectedComponents::Threshold(const Uint8* values, const int& count, const int& threshold, const bool& invert, Uint8* mask)
+{
+	for (int i = 0; i < count; ++i)
+	{
+		mask[i] = (Uint8)(((int)values[i] >= threshold) != invert);
+	}
+}
+
+void ConnectedComponents::LabelBand(const Uint8* mask, const int& width, const int& first_row, const int& last_row, const CONNECTIVITY& connectivity, int* parent)
+{
+	bool eight = connectivity == CONNECTIVITY::EIGHT;
+
+	for (int row = first_row; row < last_row; ++row)
+	{
+		for (int col = 0; col < width; ++col)
+		{
+			int i = row * width + col;
+			parent[i] = i;
+
+			if (!mask[i])
+				continue;
+
+			if (col > 0 && mask[i - 1])
+				ConnectedComponents::Union(parent, i, i - 1);
+
+			if (row > first_row)
+			{
+				int up = i - width;
+
+				if (mask[up])
+					ConnectedComponents::Union(parent, i, up);
+
+				if (eight && col > 0 && mask[up - 1])
+					ConnectedComponents::Union(parent, i, up - 1);
+
+				if (eight && col + 1 < width && mask[up + 1])
+					ConnectedComponents::Union(parent, i, up + 1);
+			}
+		}
+	}
+}
+
+void ConnectedComponents::MergeBandBorder(const Uint8* mask, const int& width, const int& row, const CONNECTIVITY& connectivity, int* parent)
+{
+	bool eight = connectivity == CONNECTIVITY::EIGHT;
+
+	for (int col = 0; col < width; ++col)
+	{
+		int i = row * width + col;
+		int up = i - width;
+
+		if (!mask[i])
+			continue;
+
+		if (mask[up])
+			ConnectedComponents::Union(parent, i, up);
+
+		if (eight && col > 0 && mask[up - 1])
+			ConnectedComponents::Union(parent, i, up - 1);
+
+		if (eight && col + 1 < width && mask[up + 1])
+			ConnectedComponents::Union(parent, i, up + 1);
+	}
+}
+
+int ConnectedComponents::FindRoot(int* parent, int index)
+{
+	int root = index;
+
+	while (parent[root] != root)
+	{
+		root = parent[root];
+	}
+
+	while (parent[index] != root)
+	{
+		int next = parent[index];
+		parent[index] = root;
+		index = next;
+	}
+
+	return root;
+}
+
+int ConnectedComponents::FindRootReadOnly(const int* parent, int index)
+{
+	while (parent[index] != index)
+	{
+		index = parent[index];
+	}
+
+	return index;
+}
+
+void ConnectedComponents::Union(int* parent, const int& a, const int& b)
+{
+	int root_a = ConnectedComponents::FindRoot(parent, a);
+	int root_b = ConnectedComponents::FindRoot(parent, b);
+
+	/* The smaller index always wins, so roots are the first pixel of their component in scan order */
+	if (root_a < root_b)
+		parent[root_b] = root_a;
+	else if (root_b < root_a)
+		parent[root_a] = root_b;
+}
\ No newline at end of file
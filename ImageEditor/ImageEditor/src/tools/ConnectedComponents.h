@@ -0,0 +1,49 @@
+#ifndef __CONNECTED_COMPONENTS_H__
+#define __CONNECTED_COMPONENTS_H__
+
+#include <vector>
+
+#include "SDL.h"
+
+enum class CONNECTIVITY
+{
+	FOUR = 0,
+	EIGHT
+};
+
+struct ComponentParams
+{
+	int THRESHOLD;
+	int MIN_AREA;
+	bool INVERT;
+	CONNECTIVITY CONNECTIVITY_TYPE;
+};
+
+struct ComponentStats
+{
+	int label;
+	int area;
+	SDL_Rect bbox;
+	float centroid_x;
+	float centroid_y;
+};
+
+class ConnectedComponents
+{
+public:
+	/* Labels start at 1, background pixels (mask == 0) get label 0. Returns the number of components */
+	static int Label(const Uint8* mask, const int& width, const int& height, const CONNECTIVITY& connectivity, std::vector<int>& labels, std::vector<ComponentStats>& stats);
+
+	/* Foreground is value >= threshold, or value < threshold when inverted */
+	static void Threshold(const Uint8* values, const int& count, const int& threshold, const bool& invert, Uint8* mask);
+
+private:
+	static void LabelBand(const Uint8* mask, const int& width, const int& first_row, const int& last_row, const CONNECTIVITY& connectivity, int* parent);
+	static void MergeBandBorder(const Uint8* mask, const int& width, const int& row, const CONNECTIVITY& connectivity, int* parent);
+
+	static int FindRoot(int* parent, int index);
+	static int FindRootReadOnly(const int* parent, int index);
+	static void Union(int* parent, const int& a, const int& b);
+};
+
+#endif /* __CONNECTED_COMPONENTS_H__ */
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include <cmath>
+#include <cstring>
+
+#include "utils/Parallel.h"
+#include "Transform.h"
+#include "DistanceTransform.h"
+
+void DistanceTransform::Compute(const Uint8* mask, const int& width, const int& height, std::vector<float>& distance)
+{
+	size_t size = (size_t)width * height;
+
+	distance.resize(size);
+
+	if (size == 0)
+		return;
+
+	std::vector<float> transposed(size);
+
+	for (size_t i = 0; i < size; ++i)
+	{
+		distance[i] = mask[i] ? 0.0f : DISTANCE_TRANSFORM_INF;
+	}
+
+	/* Columns are processed as rows of the transposed plane so both passes stream through memory */
+	Transform::Transpose(distance.data(), width, transposed.data(), height, width, height);
+	DistanceTransform::SquaredRows(transposed.data(), height, width);
+	Transform::Transpose(transposed.data(), height, distance.data(), width, height, width);
+
+	DistanceTransform::SquaredRows(distance.data(), width, height);
+
+	ParallelFor(0, height, 64, [&](const int& first, const int& last)
+	{
+		for (size_t i = (size_t)first * width; i < (size_t)last * width; ++i)
+		{
+			distance[i] = std::sqrt(distance[i]);
+		}
+	});
+}
+
+void DistanceTransform::SquaredRows(float* plane, const int& width, const int& height)
+{
+	ParallelFor(0, height, 16, [&](const int& first, const int& last)
+	{
+		std::vector<float> d(width);
+		std::vector<int> v(width);
+		std::vector<float> z(width + 1);
+
+		for (int row = first; row < last; ++row)
+		{
+			float* f = plane + (size_t)row * width;
+
+			DistanceTransform::SquaredRow(f, width, d.data(), v.data(), z.data());
+
+			memcpy(f, d.data(), width * sizeof(float));
+		}
+	});
+}
+
+void DistanceTransform::SquaredRow(float* f, const int& n, float* d, int* v, float* z)
+{
+	/* Lower envelope of the parabolas rooted at (q, f[q]) */
+	int k = 0;
+
+	v[0] = 0;
+	z[0] = -DISTANCE_TRANSFORM_INF;
+	z[1] = DISTANCE_TRANSFORM_INF;
+
+	for (int q = 1; q < n; ++q)
+	{
+		float s = ((f[q] + (float)q * q) - (f[v[k]] + (float)v[k] * v[k])) / (2.0f * (q - v[k]));
+
+		while (s <= z[k])
+		{
+			--k;
+			s = ((f[q] + (float)q * q) - (f[v[k]] + (float)v[k] * v[k])) / (2.0f * (q - v[k]));
+		}
+
+		++k;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = DISTANCE_TRANSFORM_INF;
+	}
+
+	k = 0;
+
+	for (int q = 0; q < n; ++q)
+	{
+		while (z[k + 1] < q)
+		{
+			++k;
+		}
+
+		float offset = (float)(q - v[k]);
+		d[q] = offset * offset + f[v[k]];
+	}
+}
\ No newline at end of file
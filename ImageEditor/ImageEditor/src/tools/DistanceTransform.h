@@ -0,0 +1,23 @@
+#ifndef __DISTANCE_TRANSFORM_H__
+#define __DISTANCE_TRANSFORM_H__
+
+#include <vector>
+
+#include "SDL.h"
+
+#define DISTANCE_TRANSFORM_INF 1e20f
+
+class DistanceTransform
+{
+public:
+	/* Exact Euclidean distance from every pixel to the nearest pixel with mask != 0 */
+	static void Compute(const Uint8* mask, const int& width, const int& height, std::vector<float>& distance);
+
+	/* Squared distance transform of a sampled function, in place, one row at a time (Felzenszwalb-Huttenlocher) */
+	static void SquaredRows(float* plane, const int& width, const int& height);
+
+private:
+	static void SquaredRow(float* f, const int& n, float* d, int* v, float* z);
+};
+
+#endif /* __DISTANCE_TRANSFORM_H__ */
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include <cmath>
+#include <cstdlib>
+
+#include "utils/Parallel.h"
+#include "ColorSpace.h"
+#include "DomainTransform.h"
+
+#define DOMAIN_TRANSFORM_COLUMN_STRIP 64
+
+void DomainTransform::Apply(const Uint32* src, const ptrdiff_t& src_stride, Uint32* dst, const ptrdiff_t& dst_stride, const int& width, const int& height, const DomainTransformParams& params)
+{
+	if (width <= 0 || height <= 0)
+		return;
+
+	size_t size = (size_t)width * height;
+
+	std::vector<float> r(size), g(size), b(size);
+	float* planes[3] = { r.data(), g.data(), b.data() };
+
+	/* Neighbour differences are integers, so every a^(1 + ratio * difference) of an iteration fits in a table */
+	std::vector<Uint16> horizontal(size, 0), vertical(size, 0);
+
+	auto difference = [](const Uint32& p, const Uint32& q)
+	{
+		return (Uint16)(std::abs((int)(p >> 24) - (int)(q >> 24))
+			+ std::abs((int)((p >> 16) & 0xFF) - (int)((q >> 16) & 0xFF))
+			+ std::abs((int)((p >> 8) & 0xFF) - (int)((q >> 8) & 0xFF)));
+	};
+
+	ParallelFor(0, height, 16, [&](const int& first, const int& last)
+	{
+		for (int row = first; row < last; ++row)
+		{
+			const Uint32* src_row = src + row * src_stride;
+			size_t offset = (size_t)row * width;
+
+			ColorSpace::DecodeRow(src_row, width, r.data() + offset, g.data() + offset, b.data() + offset, false);
+
+			for (int col = 1; col < width; ++col)
+			{
+				horizontal[offset + col] = difference(src_row[col], src_row[col - 1]);
+			}
+
+			if (row > 0)
+			{
+				for (int col = 0; col < width; ++col)
+				{
+					vertical[offset + col] = difference(src_row[col], src_row[col - src_stride]);
+				}
+			}
+		}
+	});
+
+	int iterations = SDL_max(params.ITERATIONS, 1);
+	float sigma_spatial = SDL_max(params.SIGMA_SPATIAL, 0.1f);
+	float ratio = sigma_spatial / SDL_max(params.SIGMA_RANGE, 0.001f) / 255.0f;
+
+	std::vector<float> feedback(DOMAIN_TRANSFORM_MAX_DIFFERENCE + 1);
+
+	for (int i = 0; i < iterations; ++i)
+	{
+		/* Halving sigma every iteration keeps the total variance equal to sigma_spatial^2 */
+		double sigma = sigma_spatial * std::sqrt(3.0) * std::pow(2.0, iterations - (i + 1)) / std::sqrt(std::pow(4.0, iterations) - 1.0);
+		double a = std::exp(-std::sqrt(2.0) / sigma);
+
+		for (int d = 0; d <= DOMAIN_TRANSFORM_MAX_DIFFERENCE; ++d)
+		{
+			feedback[d] = (float)std::pow(a, 1.0 + ratio * d);
+		}
+
+		DomainTransform::FilterRows(planes, horizontal.data(), width, height, feedback.data());
+		DomainTransform::FilterColumns(planes, vertical.data(), width, height, feedback.data());
+	}
+
+	ParallelFor(0, height, 16, [&](const int& first, const int& last)
+	{
+		for (int row = first; row < last; ++row)
+		{
+			const Uint32* src_row = src + row * src_stride;
+			Uint32* dst_row = dst + row * dst_stride;
+			size_t offset = (size_t)row * width;
+
+			ColorSpace::EncodeRow(r.data() + offset, g.data() + offset, b.data() + offset, dst_row, width, false);
+
+			for (int col = 0; col < width; ++col)
+			{
+				dst_row[col] = (dst_row[col] & 0xFFFFFF00) | (src_row[col] & 0xFF);
+			}
+		}
+	});
+}
+
+DomainTransformParams DomainTransform::DefaultParams()
+{
+	return { 60.0f, 0.4f, 3 };
+}
+
+void DomainTransform::FilterRows(float* planes[3], const Uint16* differences, const int& width, const int& height, const float* feedback)
+{
+	ParallelFor(0, height, 16, [&](const int& first, const int& last)
+	{
+		for (int row = first; row < last; ++row)
+		{
+			size_t offset = (size_t)row * width;
+			const Uint16* d = differences + offset;
+
+			float* r = planes[0] + offset;
+			float* g = planes[1] + offset;
+			float* b = planes[2] + offset;
+
+			/* The three channels are independent chains, running them together hides the latency of the recursion */
+			for (int col = 1; col < width; ++col)
+			{
+				float v = feedback[d[col]];
+
+				r[col] += v * (r[col - 1] - r[col]);
+				g[col] += v * (g[col - 1] - g[col]);
+				b[col] += v * (b[col - 1] - b[col]);
+			}
+
+			for (int col = width - 2; col >= 0; --col)
+			{
+				float v = feedback[d[col + 1]];
+
+				r[col] += v * (r[col + 1] - r[col]);
+				g[col] += v * (g[col + 1] - g[col]);
+				b[col] += v * (b[col + 1] - b[col]);
+			}
+		}
+	});
+}
+
+void DomainTransform::FilterColumns(float* planes[3], const Uint16* differences, const int& width, const int& height, const float* feedback)
+{
+	/* Strips of columns sweep the rows in order, so the recursion stays sequential per column while memory is read a row at a time */
+	ParallelFor(0, width, DOMAIN_TRANSFORM_COLUMN_STRIP, [&](const int& first, const int& last)
+	{
+		for (int c = 0; c < 3; ++c)
+		{
+			float* plane = planes[c];
+
+			for (int row = 1; row < height; ++row)
+			{
+				const Uint16* d = differences + (size_t)row * width;
+				const float* previous = plane + (size_t)(row - 1) * width;
+				float* line = plane + (size_t)row * width;
+
+				for (int col = first; col < last; ++col)
+				{
+					line[col] += feedback[d[col]] * (previous[col] - line[col]);
+				}
+			}
+
+			for (int row = height - 2; row >= 0; --row)
+			{
+				const Uint16* d = differences + (size_t)(row + 1) * width;
+				const float* next = plane + (size_t)(row + 1) * width;
+				float* line = plane + (size_t)row * width;
+
+				for (int col = first; col < last; ++col)
+				{
+					line[col] += feedback[d[col]] * (next[col] - line[col]);
+				}
+			}
+		}
+	});
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#ifndef __DOMAIN_TRANSFORM_H__
+#define __DOMAIN_TRANSFORM_H__
+
+#include <cstddef>
+#include <vector>
+
+#include "SDL.h"
+
+/* Sum of the absolute differences of R, G and B between two neighbours, in 8-bit levels */
+#define DOMAIN_TRANSFORM_MAX_DIFFERENCE 765
+
+struct DomainTransformParams
+{
+	float SIGMA_SPATIAL;
+	float SIGMA_RANGE;
+	int ITERATIONS;
+};
+
+class DomainTransform
+{
+public:
+	/* Recursive filter of Gastal and Oliveira. Spatial sigma is expressed in pixels, range sigma in [0, 1] color units */
+	static void Apply(const Uint32* src, const ptrdiff_t& src_stride, Uint32* dst, const ptrdiff_t& dst_stride, const int& width, const int& height, const DomainTransformParams& params);
+
+	static DomainTransformParams DefaultParams();
+
+private:
+	static void FilterRows(float* planes[3], const Uint16* differences, const int& width, const int& height, const float* feedback);
+	static void FilterColumns(float* planes[3], const Uint16* differences, const int& width, const int& height, const float* feedback);
+};
+
+#endif /* __DOMAIN_TRANSFORM_H__ */
\ No newline at end of file
@@ -29,4 +29,11 @@ ImVec4& EditorToolSelector::GetColorReference()
 ImVec4 EditorToolSelector::GetColorNormalized() const
 {
 	return this->color;
+}
+
+Uint32 EditorToolSelector::GetColorPixel() const
+{
+	ImVec4 color = this->GetColor();
+
+	return ((Uint32)color.x << 24) | ((Uint32)color.y << 16) | ((Uint32)color.z << 8) | (Uint32)color.w;
 }
\ No newline at end of file
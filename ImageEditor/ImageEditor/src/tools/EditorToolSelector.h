@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 
+#include "SDL.h"
 #include "Imgui.h"
 
 enum class TOOLS
@@ -18,7 +19,9 @@ enum class TOOLS
 	ELLIPSE,
 	ELLIPSE_FILL,
 	RECTANGLE,
-	RECTANGLE_FILL
+	RECTANGLE_FILL,
+	INPAINT,
+	BUCKET_FILL
 };
 
 class EditorToolSelector
@@ -29,6 +32,8 @@ public:
 
 	ImVec4 GetColor() const;
 	ImVec4 GetColorNormalized() const;
+	/* Packed in the canvas pixel format */
+	Uint32 GetColorPixel() const;
 	
 	ImVec4& GetColorReference();
 
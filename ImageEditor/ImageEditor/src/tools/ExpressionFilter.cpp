@@ -0,0 +1,608 @@
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <emmintrin.h>
+
+#include "modules/Editor.h"
+#include "utils/Parallel.h"
+#include "Application.h"
+#include "ExpressionFilter.h"
+
+/* Registers 0 to 7 hold r, g, b, a, x, y, w and h, only the channels are writable */
+#define EXPRESSION_CHANNELS 4
+#define EXPRESSION_INPUTS 8
+
+ExpressionFilter::ExpressionFilter() : register_count(EXPRESSION_INPUTS), position(0)
+{
+}
+
+bool ExpressionFilter::ApplyExpression(const std::string& source, std::string& error)
+{
+	ExpressionFilter filter;
+
+	if (!filter.Compile(source, error))
+		return false;
+
+	std::vector<Uint32> pixels;
+	int width, height;
+
+	App->editor->ReadCanvasPixels(pixels, width, height);
+
+	filter.Run(pixels.data(), width, height);
+
+	App->editor->WriteCanvasPixels(pixels, width, height);
+
+	return true;
+}
+
+bool ExpressionFilter::Compile(const std::string& source, std::string& error)
+{
+	this->instructions.clear();
+	this->constants.clear();
+	this->variables = { { "r", 0 }, { "g", 1 }, { "b", 2 }, { "a", 3 }, { "x", 4 }, { "y", 5 }, { "w", 6 }, { "h", 7 } };
+	this->register_count = EXPRESSION_INPUTS;
+
+	this->nodes.clear();
+	this->source = source;
+	this->position = 0;
+	this->error.clear();
+
+	this->SkipSpaces();
+
+	while (this->position < this->source.size())
+	{
+		if (!this->ParseStatement())
+		{
+			error = this->error;
+			this->instructions.clear();
+
+			return false;
+		}
+
+		this->Accept(";");
+	}
+
+	this->nodes.clear();
+
+	return true;
+}
+
+void ExpressionFilter::Run(Uint32* pixels, const int& width, const int& height) const
+{
+	ParallelFor(0, height, 16, [&](const int& first, const int& last)
+	{
+		std::vector<float> registers((size_t)this->register_count * EXPRESSION_BLOCK);
+
+		auto bank = [&](const int& index) { return registers.data() + (size_t)index * EXPRESSION_BLOCK; };
+
+		for (const std::pair<int, float>& constant : this->constants)
+		{
+			std::fill(bank(constant.first), bank(constant.first) + EXPRESSION_BLOCK, constant.second);
+		}
+
+		std::fill(bank(6), bank(6) + EXPRESSION_BLOCK, (float)width);
+		std::fill(bank(7), bank(7) + EXPRESSION_BLOCK, (float)height);
+
+		for (int row = first; row < last; ++row)
+		{
+			std::fill(bank(5), bank(5) + EXPRESSION_BLOCK, (float)row);
+
+			for (int col = 0; col < width; col += EXPRESSION_BLOCK)
+			{
+				int count = SDL_min(EXPRESSION_BLOCK, width - col);
+				Uint32* block = pixels + (size_t)row * width + col;
+
+				for (int i = 0; i < count; ++i)
+				{
+					bank(0)[i] = (float)(block[i] >> 24);
+					bank(1)[i] = (float)((block[i] >> 16) & 0xFF);
+					bank(2)[i] = (float)((block[i] >> 8) & 0xFF);
+					bank(3)[i] = (float)(block[i] & 0xFF);
+					bank(4)[i] = (float)(col + i);
+				}
+
+				int lanes = (count + 3) & ~3;
+
+				for (const ExpressionInstruction& instruction : this->instructions)
+				{
+					ExpressionFilter::Execute(instruction, registers.data(), lanes);
+				}
+
+				const __m128 zero = _mm_setzero_ps();
+				const __m128 max = _mm_set1_ps(255.0f);
+				const __m128 half = _mm_set1_ps(0.5f);
+
+				for (int i = 0; i < lanes; i += 4)
+				{
+					/* max_ps returns the second operand for NaN, so invalid results end up as 0 */
+					__m128i r = _mm_cvttps_epi32(_mm_add_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(bank(0) + i), zero), max), half));
+					__m128i g = _mm_cvttps_epi32(_mm_add_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(bank(1) + i), zero), max), half));
+					__m128i b = _mm_cvttps_epi32(_mm_add_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(bank(2) + i), zero), max), half));
+					__m128i a = _mm_cvttps_epi32(_mm_add_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(bank(3) + i), zero), max), half));
+
+					__m128i packed = _mm_or_si128(
+						_mm_or_si128(_mm_slli_epi32(r, 24), _mm_slli_epi32(g, 16)),
+						_mm_or_si128(_mm_slli_epi32(b, 8), a)
+					);
+
+					alignas(16) Uint32 values[4];
+					_mm_store_si128((__m128i*)values, packed);
+
+					for (int lane = 0; lane < 4 && i + lane < count; ++lane)
+					{
+						block[i + lane] = values[lane];
+					}
+				}
+			}
+		}
+	});
+}
+
+const std::vector<ExpressionInstruction>& ExpressionFilter::GetInstructions() const
+{
+	return this->instructions;
+}
+
+bool ExpressionFilter::ParseStatement()
+{
+	std::string name;
+
+	if (!this->ReadIdentifier(name))
+	{
+		this->Fail("Expected a variable name");
+		return false;
+	}
+
+	if (!this->Accept("="))
+	{
+		this->Fail("Expected '=' after '" + name + "'");
+		return false;
+	}
+
+	int node = this->ParseExpression();
+	if (node < 0)
+		return false;
+
+	auto variable = this->variables.find(name);
+
+	if (variable != this->variables.end() && variable->second >= EXPRESSION_CHANNELS && variable->second < EXPRESSION_INPUTS)
+	{
+		this->Fail("'" + name + "' is read-only");
+		return false;
+	}
+
+	int result = this->Emit(node);
+	int target = variable != this->variables.end() ? variable->second : this->register_count++;
+
+	/* A temporary computed by the last instruction can be written straight into the target */
+	if (result >= EXPRESSION_INPUTS && !this->instructions.empty() && this->instructions.back().dst == result && this->nodes[node].type == NODE_TYPE::OPERATION)
+	{
+		this->instructions.back().dst = target;
+	}
+	else if (result != target)
+	{
+		this->instructions.push_back({ EXPRESSION_OP::COPY, target, result, -1, -1 });
+	}
+
+	this->variables[name] = target;
+	this->nodes.clear();
+
+	return true;
+}
+
+int ExpressionFilter::ParseExpression()
+{
+	int condition = this->ParseComparison();
+	if (condition < 0 || !this->Accept("?"))
+		return condition;
+
+	int if_true = this->ParseExpression();
+	if (if_true < 0)
+		return -1;
+
+	if (!this->Accept(":"))
+		return this->Fail("Expected ':'");
+
+	int if_false = this->ParseExpression();
+	if (if_false < 0)
+		return -1;
+
+	return this->MakeOperation(EXPRESSION_OP::SELECT, condition, if_true, if_false);
+}
+
+int ExpressionFilter::ParseComparison()
+{
+	int left = this->ParseAdditive();
+	if (left < 0)
+		return -1;
+
+	static const std::pair<const char*, EXPRESSION_OP> operators[] = {
+		{ "<=", EXPRESSION_OP::LESS_EQUAL },
+		{ ">=", EXPRESSION_OP::GREATER_EQUAL },
+		{ "==", EXPRESSION_OP::EQUAL },
+		{ "!=", EXPRESSION_OP::NOT_EQUAL },
+		{ "<", EXPRESSION_OP::LESS },
+		{ ">", EXPRESSION_OP::GREATER }
+	};
+
+	for (const auto& op : operators)
+	{
+		if (this->Accept(op.first))
+		{
+			int right = this->ParseAdditive();
+			if (right < 0)
+				return -1;
+
+			return this->MakeOperation(op.second, left, right);
+		}
+	}
+
+	return left;
+}
+
+int ExpressionFilter::ParseAdditive()
+{
+	int left = this->ParseTerm();
+
+	while (left >= 0)
+	{
+		EXPRESSION_OP op;
+
+		if (this->Accept("+"))
+			op = EXPRESSION_OP::ADD;
+		else if (this->Accept("-"))
+			op = EXPRESSION_OP::SUB;
+		else
+			break;
+
+		int right = this->ParseTerm();
+		if (right < 0)
+			return -1;
+
+		left = this->MakeOperation(op, left, right);
+	}
+
+	return left;
+}
+
+int ExpressionFilter::ParseTerm()
+{
+	int left = this->ParseUnary();
+
+	while (left >= 0)
+	{
+		EXPRESSION_OP op;
+
+		if (this->Accept("*"))
+			op = EXPRESSION_OP::MUL;
+		else if (this->Accept("/"))
+			op = EXPRESSION_OP::DIV;
+		else
+			break;
+
+		int right = this->ParseUnary();
+		if (right < 0)
+			return -1;
+
+		left = this->MakeOperation(op, left, right);
+	}
+
+	return left;
+}
+
+int ExpressionFilter::ParseUnary()
+{
+	if (this->Accept("-"))
+	{
+		int operand = this->ParseUnary();
+		if (operand < 0)
+			return -1;
+
+		return this->MakeOperation(EXPRESSION_OP::NEG, operand);
+	}
+
+	if (this->Accept("+"))
+		return this->ParseUnary();
+
+	return this->ParsePrimary();
+}
+
+int ExpressionFilter::ParsePrimary()
+{
+	if (this->Accept("("))
+	{
+		int node = this->ParseExpression();
+		if (node < 0)
+			return -1;
+
+		if (!this->Accept(")"))
+			return this->Fail("Expected ')'");
+
+		return node;
+	}
+
+	if (this->position < this->source.size() && (isdigit((unsigned char)this->source[this->position]) || this->source[this->position] == '.'))
+	{
+		const char* begin = this->source.c_str() + this->position;
+		char* end;
+
+		float value = strtof(begin, &end);
+		if (end == begin)
+			return this->Fail("Invalid number");
+
+		this->position += end - begin;
+		this->SkipSpaces();
+
+		return this->MakeConstant(value);
+	}
+
+	std::string name;
+
+	if (!this->ReadIdentifier(name))
+		return this->Fail(this->position < this->source.size() ? std::string("Unexpected '") + this->source[this->position] + "'" : "Unexpected end of expression");
+
+	if (this->Accept("("))
+		return this->ParseCall(name);
+
+	auto variable = this->variables.find(name);
+	if (variable == this->variables.end())
+		return this->Fail("Unknown variable '" + name + "'");
+
+	this->nodes.push_back({ NODE_TYPE::VARIABLE, EXPRESSION_OP::COPY, (float)variable->second, { -1, -1, -1 } });
+
+	return (int)this->nodes.size() - 1;
+}
+
+int ExpressionFilter::ParseCall(const std::string& name)
+{
+	std::vector<int> args;
+
+	if (!this->Accept(")"))
+	{
+		do
+		{
+			int arg = this->ParseExpression();
+			if (arg < 0)
+				return -1;
+
+			args.push_back(arg);
+		} while (this->Accept(","));
+
+		if (!this->Accept(")"))
+			return this->Fail("Expected ')' after the arguments of '" + name + "'");
+	}
+
+	static const std::map<std::string, std::pair<EXPRESSION_OP, size_t>> functions = {
+		{ "min", { EXPRESSION_OP::MIN, 2 } },
+		{ "max", { EXPRESSION_OP::MAX, 2 } },
+		{ "abs", { EXPRESSION_OP::ABS, 1 } },
+		{ "sqrt", { EXPRESSION_OP::SQRT, 1 } },
+		{ "floor", { EXPRESSION_OP::FLOOR, 1 } }
+	};
+
+	if (name == "clamp")
+	{
+		if (args.size() != 3)
+			return this->Fail("'clamp' takes 3 arguments");
+
+		return this->MakeOperation(EXPRESSION_OP::MIN, this->MakeOperation(EXPRESSION_OP::MAX, args[0], args[1]), args[2]);
+	}
+
+	auto function = functions.find(name);
+	if (function == functions.end())
+		return this->Fail("Unknown function '" + name + "'");
+
+	if (args.size() != function->second.second)
+		return this->Fail("'" + name + "' takes " + std::to_string(function->second.second) + " argument(s)");
+
+	return this->MakeOperation(function->second.first, args[0], args.size() > 1 ? args[1] : -1);
+}
+
+int ExpressionFilter::MakeConstant(const float& value)
+{
+	this->nodes.push_back({ NODE_TYPE::CONSTANT, EXPRESSION_OP::COPY, value, { -1, -1, -1 } });
+
+	return (int)this->nodes.size() - 1;
+}
+
+int ExpressionFilter::MakeOperation(const EXPRESSION_OP& op, const int& a, const int& b, const int& c)
+{
+	auto is_constant = [&](const int& node) { return node < 0 || this->nodes[node].type == NODE_TYPE::CONSTANT; };
+	auto value = [&](const int& node) { return node < 0 ? 0.0f : this->nodes[node].value; };
+
+	if (is_constant(a) && is_constant(b) && is_constant(c))
+		return this->MakeConstant(ExpressionFilter::Evaluate(op, value(a), value(b), value(c)));
+
+	/* A constant condition picks its branch at compile time */
+	if (op == EXPRESSION_OP::SELECT && is_constant(a))
+		return value(a) != 0.0f ? b : c;
+
+	if ((op == EXPRESSION_OP::ADD && is_constant(b) && value(b) == 0.0f) || (op == EXPRESSION_OP::SUB && is_constant(b) && value(b) == 0.0f)
+		|| ((op == EXPRESSION_OP::MUL || op == EXPRESSION_OP::DIV) && is_constant(b) && value(b) == 1.0f))
+		return a;
+
+	if ((op == EXPRESSION_OP::ADD && is_constant(a) && value(a) == 0.0f) || (op == EXPRESSION_OP::MUL && is_constant(a) && value(a) == 1.0f))
+		return b;
+
+	this->nodes.push_back({ NODE_TYPE::OPERATION, op, 0.0f, { a, b, c } });
+
+	return (int)this->nodes.size() - 1;
+}
+
+int ExpressionFilter::Emit(const int& node)
+{
+	const Node& current = this->nodes[node];
+
+	if (current.type == NODE_TYPE::CONSTANT)
+		return this->ConstantRegister(current.value);
+
+	if (current.type == NODE_TYPE::VARIABLE)
+		return (int)current.value;
+
+	int a = current.args[0] >= 0 ? this->Emit(current.args[0]) : -1;
+	int b = current.args[1] >= 0 ? this->Emit(current.args[1]) : -1;
+	int c = current.args[2] >= 0 ? this->Emit(current.args[2]) : -1;
+
+	int dst = this->register_count++;
+	this->instructions.push_back({ current.op, dst, a, b, c });
+
+	return dst;
+}
+
+int ExpressionFilter::ConstantRegister(const float& value)
+{
+	for (const std::pair<int, float>& constant : this->constants)
+	{
+		if (constant.second == value)
+			return constant.first;
+	}
+
+	this->constants.push_back({ this->register_count, value });
+
+	return this->register_count++;
+}
+
+void ExpressionFilter::SkipSpaces()
+{
+	while (this->position < this->source.size() && isspace((unsigned char)this->source[this->position]))
+	{
+		this->position++;
+	}
+}
+
+bool ExpressionFilter::Accept(const char* token)
+{
+	size_t length = strlen(token);
+
+	if (this->source.compare(this->position, length, token) != 0)
+		return false;
+
+	/* "=" must not swallow the first half of "==" */
+	if (length == 1 && (token[0] == '=' || token[0] == '<' || token[0] == '>') && this->source.compare(this->position, 2, std::string(token) + "=") == 0)
+		return false;
+
+	this->position += length;
+	this->SkipSpaces();
+
+	return true;
+}
+
+bool ExpressionFilter::ReadIdentifier(std::string& name)
+{
+	size_t begin = this->position;
+
+	while (this->position < this->source.size()
+		&& (isalpha((unsigned char)this->source[this->position]) || this->source[this->position] == '_'
+			|| (this->position > begin && isdigit((unsigned char)this->source[this->position]))))
+	{
+		this->position++;
+	}
+
+	if (this->position == begin)
+		return false;
+
+	name = this->source.substr(begin, this->position - begin);
+	this->SkipSpaces();
+
+	return true;
+}
+
+int ExpressionFilter::Fail(const std::string& message)
+{
+	if (this->error.empty())
+	{
+		this->error = message + " at column " + std::to_string(this->position + 1);
+	}
+
+	return -1;
+}
+
+float ExpressionFilter::Evaluate(const EXPRESSION_OP& op, const float& a, const float& b, const float& c)
+{
+	switch (op)
+	{
+		case EXPRESSION_OP::COPY: return a;
+		case EXPRESSION_OP::ADD: return a + b;
+		case EXPRESSION_OP::SUB: return a - b;
+		case EXPRESSION_OP::MUL: return a * b;
+		case EXPRESSION_OP::DIV: return b != 0.0f ? a / b : 0.0f;
+		case EXPRESSION_OP::MIN: return SDL_min(a, b);
+		case EXPRESSION_OP::MAX: return SDL_max(a, b);
+		case EXPRESSION_OP::NEG: return -a;
+		case EXPRESSION_OP::ABS: return std::fabs(a);
+		case EXPRESSION_OP::SQRT: return std::sqrt(SDL_max(a, 0.0f));
+		case EXPRESSION_OP::FLOOR: return std::floor(a);
+		case EXPRESSION_OP::LESS: return a < b ? 1.0f : 0.0f;
+		case EXPRESSION_OP::LESS_EQUAL: return a <= b ? 1.0f : 0.0f;
+		case EXPRESSION_OP::GREATER: return a > b ? 1.0f : 0.0f;
+		case EXPRESSION_OP::GREATER_EQUAL: return a >= b ? 1.0f : 0.0f;
+		case EXPRESSION_OP::EQUAL: return a == b ? 1.0f : 0.0f;
+		case EXPRESSION_OP::NOT_EQUAL: return a != b ? 1.0f : 0.0f;
+		case EXPRESSION_OP::SELECT: return a != 0.0f ? b : c;
+		default: return 0.0f;
+	}
+}
+
+void ExpressionFilter::Execute(const ExpressionInstruction& instruction, float* registers, const int& count)
+{
+	float* dst = registers + (size_t)instruction.dst * EXPRESSION_BLOCK;
+	const float* a = registers + (size_t)instruction.a * EXPRESSION_BLOCK;
+	const float* b = instruction.b >= 0 ? registers + (size_t)instruction.b * EXPRESSION_BLOCK : a;
+	const float* c = instruction.c >= 0 ? registers + (size_t)instruction.c * EXPRESSION_BLOCK : a;
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 sign = _mm_set1_ps(-0.0f);
+
+	/* One dispatch per instruction and block, the loops run over full SSE lanes */
+	auto loop = [&](const auto& kernel)
+	{
+		for (int i = 0; i < count; i += 4)
+		{
+			_mm_storeu_ps(dst + i, kernel(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i), _mm_loadu_ps(c + i)));
+		}
+	};
+
+	switch (instruction.op)
+	{
+		case EXPRESSION_OP::COPY: loop([&](__m128 x, __m128, __m128) { return x; }); break;
+		case EXPRESSION_OP::ADD: loop([&](__m128 x, __m128 y, __m128) { return _mm_add_ps(x, y); }); break;
+		case EXPRESSION_OP::SUB: loop([&](__m128 x, __m128 y, __m128) { return _mm_sub_ps(x, y); }); break;
+		case EXPRESSION_OP::MUL: loop([&](__m128 x, __m128 y, __m128) { return _mm_mul_ps(x, y); }); break;
+		case EXPRESSION_OP::DIV: loop([&](__m128 x, __m128 y, __m128) { return _mm_and_ps(_mm_div_ps(x, y), _mm_cmpneq_ps(y, zero)); }); break;
+		case EXPRESSION_OP::MIN: loop([&](__m128 x, __m128 y, __m128) { return _mm_min_ps(x, y); }); break;
+		case EXPRESSION_OP::MAX: loop([&](__m128 x, __m128 y, __m128) { return _mm_max_ps(x, y); }); break;
+		case EXPRESSION_OP::NEG: loop([&](__m128 x, __m128, __m128) { return _mm_xor_ps(x, sign); }); break;
+		case EXPRESSION_OP::ABS: loop([&](__m128 x, __m128, __m128) { return _mm_andnot_ps(sign, x); }); break;
+		case EXPRESSION_OP::SQRT: loop([&](__m128 x, __m128, __m128) { return _mm_sqrt_ps(_mm_max_ps(x, zero)); }); break;
+		case EXPRESSION_OP::FLOOR:
+		{
+			loop([&](__m128 x, __m128, __m128)
+			{
+				__m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+				return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, x), one));
+			});
+			break;
+		}
+		case EXPRESSION_OP::LESS: loop([&](__m128 x, __m128 y, __m128) { return _mm_and_ps(_mm_cmplt_ps(x, y), one); }); break;
+		case EXPRESSION_OP::LESS_EQUAL: loop([&](__m128 x, __m128 y, __m128) { return _mm_and_ps(_mm_cmple_ps(x, y), one); }); break;
+		case EXPRESSION_OP::GREATER: loop([&](__m128 x, __m128 y, __m128) { return _mm_and_ps(_mm_cmpgt_ps(x, y), one); }); break;
+		case EXPRESSION_OP::GREATER_EQUAL: loop([&](__m128 x, __m128 y, __m128) { return _mm_and_ps(_mm_cmpge_ps(x, y), one); }); break;
+		case EXPRESSION_OP::EQUAL: loop([&](__m128 x, __m128 y, __m128) { return _mm_and_ps(_mm_cmpeq_ps(x, y), one); }); break;
+		case EXPRESSION_OP::NOT_EQUAL: loop([&](__m128 x, __m128 y, __m128) { return _mm_and_ps(_mm_cmpneq_ps(x, y), one); }); break;
+		case EXPRESSION_OP::SELECT:
+		{
+			loop([&](__m128 x, __m128 y, __m128 z)
+			{
+				__m128 mask = _mm_cmpneq_ps(x, zero);
+				return _mm_or_ps(_mm_and_ps(mask, y), _mm_andnot_ps(mask, z));
+			});
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
+}
\ No newline at end of file
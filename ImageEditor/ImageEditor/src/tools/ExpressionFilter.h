@@ -0,0 +1,114 @@
+#ifndef __EXPRESSION_FILTER_H__
+#define __EXPRESSION_FILTER_H__
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "SDL.h"
+
+#define EXPRESSION_BLOCK 256
+
+enum class EXPRESSION_OP
+{
+	COPY = 0,
+	ADD,
+	SUB,
+	MUL,
+	DIV,
+	MIN,
+	MAX,
+	NEG,
+	ABS,
+	SQRT,
+	FLOOR,
+	LESS,
+	LESS_EQUAL,
+	GREATER,
+	GREATER_EQUAL,
+	EQUAL,
+	NOT_EQUAL,
+	SELECT
+};
+
+struct ExpressionInstruction
+{
+	EXPRESSION_OP op;
+	int dst;
+	int a;
+	int b;
+	int c;
+};
+
+/*
+	Per-pixel channel math, e.g. "r = 255 - g; g = (r + b) / 2". Statements run in order on r, g, b and a in [0, 255],
+	x, y, w and h are read-only and any other name is a temporary. Supports + - * / < <= > >= == != ?: and
+	min, max, clamp, abs, sqrt and floor. Source is parsed into a tree, constant folded and lowered to a register
+	bytecode that is interpreted over blocks of EXPRESSION_BLOCK pixels with SSE2.
+*/
+class ExpressionFilter
+{
+public:
+	ExpressionFilter();
+
+	static bool ApplyExpression(const std::string& source, std::string& error);
+
+	/* Returns false and fills error when the source does not compile */
+	bool Compile(const std::string& source, std::string& error);
+	void Run(Uint32* pixels, const int& width, const int& height) const;
+
+	const std::vector<ExpressionInstruction>& GetInstructions() const;
+
+private:
+	enum class NODE_TYPE
+	{
+		CONSTANT = 0,
+		VARIABLE,
+		OPERATION
+	};
+
+	struct Node
+	{
+		NODE_TYPE type;
+		EXPRESSION_OP op;
+		float value;
+		int args[3];
+	};
+
+	bool ParseStatement();
+	int ParseExpression();
+	int ParseComparison();
+	int ParseAdditive();
+	int ParseTerm();
+	int ParseUnary();
+	int ParsePrimary();
+	int ParseCall(const std::string& name);
+
+	int MakeConstant(const float& value);
+	int MakeOperation(const EXPRESSION_OP& op, const int& a, const int& b=-1, const int& c=-1);
+
+	int Emit(const int& node);
+	int ConstantRegister(const float& value);
+
+	void SkipSpaces();
+	bool Accept(const char* token);
+	bool ReadIdentifier(std::string& name);
+	int Fail(const std::string& message);
+
+	static float Evaluate(const EXPRESSION_OP& op, const float& a, const float& b, const float& c);
+	static void Execute(const ExpressionInstruction& instruction, float* registers, const int& count);
+
+private:
+	std::vector<ExpressionInstruction> instructions;
+	std::vector<std::pair<int, float>> constants;
+	std::map<std::string, int> variables;
+	int register_count;
+
+	/* Compilation state */
+	std::vector<Node> nodes;
+	std::string source;
+	std::string error;
+	size_t position;
+};
+
+#endif /* __EXPRESSION_FILTER_H__ */
\ No newline at end of file
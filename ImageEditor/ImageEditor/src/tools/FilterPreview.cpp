@@ -0,0 +1,87 @@
+#include "modules/Editor.h"
+#include "Application.h"
+#include "FilterPreview.h"
+
+FilterPreview::FilterPreview()
+	: region({ 0, 0, 0, 0 }), width(0), height(0), active(false)
+{
+
+}
+
+FilterPreview::~FilterPreview()
+{
+
+}
+
+void FilterPreview::Begin()
+{
+	App->editor->ReadCanvasPixels(this->source, this->width, this->height);
+
+	this->region = { 0, 0, 0, 0 };
+	this->active = true;
+}
+
+void FilterPreview::Update(const PreviewFunction& function, const bool& force)
+{
+	if (!this->active)
+		return;
+
+	SDL_Rect visible = App->editor->GetVisibleCanvasRect();
+
+	if (!force && SDL_RectEquals(&visible, &this->region))
+		return;
+
+	this->region = visible;
+
+	if (SDL_RectEmpty(&visible))
+		return;
+
+	this->region_pixels.resize((size_t)visible.w * visible.h);
+
+	function(
+		this->source.data() + (size_t)visible.y * this->width + visible.x, this->width,
+		this->region_pixels.data(), visible.w,
+		visible.w, visible.h
+	);
+
+	App->editor->WriteCanvasRegion(this->region_pixels, visible);
+}
+
+void FilterPreview::Commit(const PreviewFunction& function)
+{
+	if (!this->active)
+		return;
+
+	std::vector<Uint32> result((size_t)this->width * this->height);
+
+	function(this->source.data(), this->width, result.data(), this->width, this->width, this->height);
+
+	App->editor->WriteCanvasPixels(result, this->width, this->height);
+
+	this->End();
+}
+
+void FilterPreview::Cancel()
+{
+	if (!this->active)
+		return;
+
+	App->editor->WriteCanvasPixels(this->source, this->width, this->height);
+
+	this->End();
+}
+
+bool FilterPreview::IsActive() const
+{
+	return this->active;
+}
+
+void FilterPreview::End()
+{
+	this->source.clear();
+	this->source.shrink_to_fit();
+	this->region_pixels.clear();
+	this->region_pixels.shrink_to_fit();
+
+	this->active = false;
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef __FILTER_PREVIEW_H__
+#define __FILTER_PREVIEW_H__
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "SDL.h"
+
+typedef std::function<void(const Uint32* src, const ptrdiff_t& src_stride, Uint32* dst, const ptrdiff_t& dst_stride, const int& width, const int& height)> PreviewFunction;
+
+class FilterPreview
+{
+public:
+	FilterPreview();
+	~FilterPreview();
+
+	/* Snapshots the canvas, every update recomputes only the part of it visible on screen */
+	void Begin();
+	void Update(const PreviewFunction& function, const bool& force);
+	void Commit(const PreviewFunction& function);
+	void Cancel();
+
+	bool IsActive() const;
+
+private:
+	void End();
+
+private:
+	std::vector<Uint32> source;
+	std::vector<Uint32> region_pixels;
+
+	SDL_Rect region;
+
+	int width;
+	int height;
+
+	bool active;
+};
+
+#endif /* __FILTER_PREVIEW_H__ */
\ No newline at end of file
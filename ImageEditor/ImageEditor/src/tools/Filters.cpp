@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <climits>
+#include <cmath>
 #include <numeric>
 
 #include "SDL.h"
@@ -5,861 +8,629 @@
 #include "modules/Renderer.h"
 #include "modules/Window.h"
 #include "modules/Editor.h"
+#include "utils/Parallel.h"
 #include "utils/Utils.h"
 #include "Application.h"
+#include "ColorSpace.h"
+#include "IntegralImage.h"
+#include "SeparableFilters.h"
 #include "Filters.h"
 
-void Filters::ApplyGrayScale(SDL_Texture* target, SDL_Texture* filter)
-{
-	Uint32 format = App->renderer->texture_format;
-	SDL_PixelFormat* pixel_format = SDL_AllocFormat(format);
-
-	int width, height;
-	SDL_QueryTexture(target, nullptr, nullptr, &width, &height);
-
-	App->renderer->SetRenderTarget(target);
-
-	SDL_Surface* target_surface = SDL_CreateRGBSurfaceWithFormat(
-		0,
-		width, height,
-		32,
-		App->renderer->texture_format
-	);
-
-	SDL_RenderReadPixels(
-		App->renderer->renderer,
-		nullptr,
-		App->renderer->texture_format,
-		target_surface->pixels,
-		target_surface->pitch
-	);
+FilterParams Filters::params = { false, false };
 
-	App->renderer->SetRenderTarget(nullptr);
-
-	Uint32* u_target_pixels = (Uint32*)target_surface->pixels;
-	
-	int pitch;
-	void* filter_pixels;
-
-	SDL_LockTexture(filter, nullptr, (void**)&filter_pixels, &pitch);
-
-	Uint32* u_filter_pixels = (Uint32*)filter_pixels;
-
-	for (int i = 0; i < width * height; ++i)
+void Filters::ApplyGrayScale()
+{
+	App->editor->TransformCanvasPixels([](Uint32* pixels, const int& count)
 	{
-		Uint8 target_r, target_g, target_b;
-		SDL_GetRGB(u_target_pixels[i], pixel_format, &target_r, &target_g, &target_b);
-		
-		Uint8 grayscale = (target_r + target_g + target_b) / 3;
+		std::vector<float> r(count), g(count), b(count);
 
-		u_filter_pixels[i] = SDL_MapRGB(pixel_format, grayscale, grayscale, grayscale);
-	}
+		ColorSpace::DecodeRow(pixels, count, r.data(), g.data(), b.data(), Filters::params.LINEAR_LIGHT);
 
-	memcpy(filter_pixels, u_filter_pixels, (pitch / 4) * height);
+		for (int i = 0; i < count; ++i)
+		{
+			float grayscale = (r[i] + g[i] + b[i]) / 3.0f;
 
-	SDL_UnlockTexture(filter);
-	SDL_FreeSurface(target_surface);
-	SDL_FreeFormat(pixel_format);
+			r[i] = grayscale;
+			g[i] = grayscale;
+			b[i] = grayscale;
+		}
 
-	App->editor->RenderImg(filter, target, false);
+		ColorSpace::EncodeRow(r.data(), g.data(), b.data(), pixels, count, Filters::params.LINEAR_LIGHT);
+	});
 }
 
-void Filters::ApplyBlur(SDL_Texture* target, SDL_Texture* filter, const int& kernel_size)
+void Filters::ApplyBlur(const int& kernel_size)
 {
-	Uint32 format = App->renderer->texture_format;
-	SDL_PixelFormat* pixel_format = SDL_AllocFormat(format);
-
-	int width, height;
-	SDL_QueryTexture(target, nullptr, nullptr, &width, &height);
+	std::vector<float> kernel = Filters::CreateStaticKernel(kernel_size, 1.0f / kernel_size);
 
-	App->renderer->SetRenderTarget(target);
+	Filters::ApplySeparableKernel(kernel);
+}
 
-	SDL_Surface* target_surface = SDL_CreateRGBSurfaceWithFormat(
-		0,
-		width, height,
-		32,
-		App->renderer->texture_format
-	);
+void Filters::ApplyGaussianBlur(const int& kernel_size)
+{
+	std::vector<float> kernel = Filters::CreateGaussianKernel(kernel_size);
 
-	SDL_RenderReadPixels(
-		App->renderer->renderer,
-		nullptr,
-		App->renderer->texture_format,
-		target_surface->pixels,
-		target_surface->pitch
-	);
+	Filters::ApplySeparableKernel(kernel);
+}
 
-	App->renderer->SetRenderTarget(nullptr);
+void Filters::ApplyMedianBlur(const int& kernel_size)
+{
+	Filters::ApplyPlaneFilter(kernel_size / 2, [&](const std::vector<Uint8>& src, std::vector<Uint8>& dst, const int& width, const int& height, const int&)
+	{
+		Filters::MedianPlane(src, dst, width, height, kernel_size);
+	});
+}
 
-	Uint32* u_target_pixels = (Uint32*)target_surface->pixels;
+void Filters::ApplyLaplace()
+{
+	std::vector<FILTER_PLANE> planes = { FILTER_PLANE::RED, FILTER_PLANE::GREEN, FILTER_PLANE::BLUE };
 
-	int pitch;
-	void* filter_pixels;
+	Filters::ProcessBands(1, [&](std::vector<Uint32>& pixels, const int& width, const int& rows, const int& band_top, const int& band_rows)
+	{
+		size_t first = (size_t)band_top * width;
+		size_t count = (size_t)band_rows * width;
 
-	SDL_LockTexture(filter, nullptr, (void**)&filter_pixels, &pitch);
+		std::vector<Uint8> plane, new_plane(pixels.size());
+		std::vector<int> sums;
 
-	Uint32* u_filter_pixels = (Uint32*)filter_pixels;
+		for (const FILTER_PLANE& channel : planes)
+		{
+			Filters::ExtractPlane(pixels, channel, plane);
+			Filters::LaplacePlane(plane, sums, width, rows, band_top, band_rows);
 
-	std::vector<float> kernel = Filters::CreateStaticKernel(3, 1.0f / 9.0f);
+			for (size_t i = 0; i < count; ++i)
+			{
+				int sum = sums[i];
+				CLAMP(sum, 0, 255);
 
-	Uint32** u_target_pixels_2d = Array2D<Uint32>(width, height);
-	Uint32** u_filter_pixels_2d = Array2D<Uint32>(width, height);
+				new_plane[first + i] = (Uint8)sum;
+			}
 
-	for (int row = 0; row < height; ++row)
-	{
-		for (int col = 0; col < width; ++col)
-		{
-			u_target_pixels_2d[row][col] = u_target_pixels[(row * width + col)];
+			Filters::InsertPlane(pixels, plane, new_plane, first, count, channel);
 		}
-	}
+	}, true);
+}
 
-	for (int row = 0; row < height; ++row)
+void Filters::ApplyLaplaceEnhancement()
+{
+	std::vector<FILTER_PLANE> planes = Filters::GetPlanes();
+	std::vector<LaplaceRange> ranges(planes.size(), { 0, INT_MIN, 0, INT_MIN });
+
+	auto band = [&](const LAPLACE_PASS& pass)
 	{
-		for (int col = 0; col < width; ++col)
+		return [&, pass](std::vector<Uint32>& pixels, const int& width, const int& rows, const int& band_top, const int& band_rows)
 		{
-			Uint8 filter_r, filter_g, filter_b;
-
-			filter_r = 0;
-			filter_g = 0;
-			filter_b = 0;
+			std::vector<Uint8> plane, new_plane(pixels.size());
 
-			int krad = kernel_size / 2;
-			int k_ind = 0;
-
-			float sum_r = 0.0f;
-			float sum_g = 0.0f;
-			float sum_b = 0.0f;
-
-			for (int k_row = -krad; k_row <= krad; ++k_row)
+			for (size_t i = 0; i < planes.size(); ++i)
 			{
-				for (int k_col = -krad; k_col <= krad; ++k_col)
-				{
-					Uint8 target_r = 0, target_g = 0, target_b = 0;
-					int target_row = row + k_row;
-					int target_col = col + k_col;
-					
-					if (target_row >= 0 && target_col >= 0
-						&& target_row < height && target_col < width)
-					{
-						SDL_GetRGB(u_target_pixels_2d[target_row][target_col], pixel_format, &target_r, &target_g, &target_b);
-					}
-
-					float target_r_normalized = (float)target_r / 255.0f;
-					float target_g_normalized = (float)target_g / 255.0f;
-					float target_b_normalized = (float)target_b / 255.0f;
-
-					sum_r += kernel[k_ind] * target_r_normalized;
-					sum_g += kernel[k_ind] * target_g_normalized;
-					sum_b += kernel[k_ind] * target_b_normalized;
+				Filters::ExtractPlane(pixels, planes[i], plane);
+				Filters::LaplaceEnhancementPlane(plane, new_plane, width, rows, band_top, band_rows, ranges[i], pass);
 
-					++k_ind;
+				if (pass == LAPLACE_PASS::OUTPUT)
+				{
+					Filters::InsertPlane(pixels, plane, new_plane, (size_t)band_top * width, (size_t)band_rows * width, planes[i]);
 				}
 			}
+		};
+	};
 
-			filter_r = Uint8(sum_r * 255.0f);
-			filter_g = Uint8(sum_g * 255.0f);
-			filter_b = Uint8(sum_b * 255.0f);
-
-			u_filter_pixels_2d[row][col] = SDL_MapRGB(pixel_format, filter_r, filter_g, filter_b);
-		}
-	}
+	/* The response is renormalized twice over the whole image, two read-only passes find both ranges before the bands are written */
+	Filters::ProcessBands(1, band(LAPLACE_PASS::SUMS), false);
 
-	for (int row = 0; row < height; ++row)
+	for (LaplaceRange& range : ranges)
 	{
-		for (int col = 0; col < width; ++col)
-		{
-			u_filter_pixels[row * width + col] = u_filter_pixels_2d[row][col];
-		}
+		range.max_sum = SDL_max(255, range.max_sum - range.min_sum);
 	}
 
-	memcpy(filter_pixels, u_filter_pixels, (pitch / 4) * height);
-
-	SDL_UnlockTexture(filter);
+	Filters::ProcessBands(1, band(LAPLACE_PASS::SHARPENED), false);
 
-	RELEASE_ARRAY2D(u_target_pixels_2d, height);
-	RELEASE_ARRAY2D(u_filter_pixels_2d, height);
-
-	SDL_FreeSurface(target_surface);
+	for (LaplaceRange& range : ranges)
+	{
+		range.max_sharpened = SDL_max(255, range.max_sharpened - range.min_sharpened);
+	}
 
-	SDL_FreeFormat(pixel_format);
+	Filters::ProcessBands(1, band(LAPLACE_PASS::OUTPUT), true);
+}
 
-	App->editor->RenderImg(filter, target, false);
+void Filters::ApplyNegative()
+{
+	/* Inverts R, G and B, alpha is kept so transparent layers stay transparent */
+	App->editor->TransformCanvasPixels([](Uint32* pixels, const int& count)
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			pixels[i] = (~pixels[i] & 0xFFFFFF00) | (pixels[i] & 0xFF);
+		}
+	});
 }
 
-void Filters::ApplyGaussianBlur(SDL_Texture* target, SDL_Texture* filter, const int& kernel_size)
+void Filters::ApplyUnsharpMask(const float& amount, const float& radius, const int& threshold)
 {
-	Uint32 format = App->renderer->texture_format;
-	SDL_PixelFormat* pixel_format = SDL_AllocFormat(format);
+	Filters::ApplySharpening(radius, 1.0f, amount / 100.0f, threshold / 255.0f);
+}
 
-	int width, height;
-	SDL_QueryTexture(target, nullptr, nullptr, &width, &height);
+void Filters::ApplyHighBoost(const float& boost, const float& radius)
+{
+	/* A * f - blur(f) = (A - 1) * f + (f - blur(f)) */
+	Filters::ApplySharpening(radius, boost - 1.0f, 1.0f, 0.0f);
+}
 
-	App->renderer->SetRenderTarget(target);
+void Filters::ApplyWienerFilter(const int& kernel_size, const float& noise_variance)
+{
+	Filters::ApplyAdaptiveFilter(kernel_size, ADAPTIVE_FILTER::WIENER, noise_variance);
+}
 
-	SDL_Surface* target_surface = SDL_CreateRGBSurfaceWithFormat(
-		0,
-		width, height,
-		32,
-		App->renderer->texture_format
-	);
+void Filters::ApplyLeeFilter(const int& kernel_size, const float& noise_deviation)
+{
+	Filters::ApplyAdaptiveFilter(kernel_size, ADAPTIVE_FILTER::LEE, noise_deviation);
+}
 
-	SDL_RenderReadPixels(
-		App->renderer->renderer,
-		nullptr,
-		App->renderer->texture_format,
-		target_surface->pixels,
-		target_surface->pitch
-	);
+void Filters::ProcessBands(const int& halo, const BandFunction& function, const bool& write)
+{
+	int width = App->editor->layers.GetWidth();
+	int height = App->editor->layers.GetHeight();
 
-	App->renderer->SetRenderTarget(nullptr);
+	std::vector<Uint32> pixels;
+	/* Last rows above the current band as they were before filtering, the previous band has already overwritten them */
+	std::vector<Uint32> original;
 
-	Uint32* u_target_pixels = (Uint32*)target_surface->pixels;
+	for (int first = 0; first < height; first += FILTER_BAND_ROWS)
+	{
+		int last = SDL_min(first + FILTER_BAND_ROWS, height);
+		int top = SDL_max(first - halo, 0);
+		int bottom = SDL_min(last + halo, height);
 
-	int pitch;
-	void* filter_pixels;
+		App->editor->ReadCanvasRegion(pixels, { 0, top, width, bottom - top });
 
-	SDL_LockTexture(filter, nullptr, (void**)&filter_pixels, &pitch);
+		size_t above = (size_t)(first - top) * width;
+		size_t count = (size_t)(last - first) * width;
 
-	Uint32* u_filter_pixels = (Uint32*)filter_pixels;
+		if (write)
+		{
+			std::copy(original.end() - above, original.end(), pixels.begin());
 
-	std::vector<float> kernel = Filters::CreateGaussianKernel(kernel_size);
+			original.insert(original.end(), pixels.begin() + above, pixels.begin() + above + count);
+			original.erase(original.begin(), original.end() - SDL_min(original.size(), (size_t)halo * width));
+		}
 
-	Uint32** u_target_pixels_2d = Array2D<Uint32>(width, height);
-	Uint32** u_filter_pixels_2d = Array2D<Uint32>(width, height);
+		function(pixels, width, bottom - top, first - top, last - first);
 
-	for (int row = 0; row < height; ++row)
-	{
-		for (int col = 0; col < width; ++col)
+		if (write)
 		{
-			u_target_pixels_2d[row][col] = u_target_pixels[(row * width + col)];
+			pixels.erase(pixels.begin(), pixels.begin() + above);
+			pixels.resize(count);
+
+			App->editor->WriteCanvasRegion(pixels, { 0, first, width, last - first });
 		}
 	}
+}
 
-	for (int row = 0; row < height; ++row)
+void Filters::ApplySeparableKernel(const std::vector<float>& kernel)
+{
+	Filters::ProcessBands((int)kernel.size() / 2, [&](std::vector<Uint32>& pixels, const int& width, const int& rows, const int& band_top, const int& band_rows)
 	{
-		for (int col = 0; col < width; ++col)
-		{
-			Uint8 filter_r, filter_g, filter_b;
-
-			filter_r = 0;
-			filter_g = 0;
-			filter_b = 0;
-
-			int krad = kernel_size / 2;
-			int k_ind = 0;
-
-			float sum_r = 0.0f;
-			float sum_g = 0.0f;
-			float sum_b = 0.0f;
-
-			for (int k_row = -krad; k_row <= krad; ++k_row)
-			{
-				for (int k_col = -krad; k_col <= krad; ++k_col)
-				{
-					Uint8 target_r = 0, target_g = 0, target_b = 0;
-					int target_row = row + k_row;
-					int target_col = col + k_col;
+		size_t size = (size_t)width * rows;
+		std::vector<float> r(size), g(size), b(size);
 
-					if (target_row >= 0 && target_col >= 0
-						&& target_row < height && target_col < width)
-					{
-						SDL_GetRGB(u_target_pixels_2d[target_row][target_col], pixel_format, &target_r, &target_g, &target_b);
-					}
-
-					float target_r_normalized = (float)target_r / 255.0f;
-					float target_g_normalized = (float)target_g / 255.0f;
-					float target_b_normalized = (float)target_b / 255.0f;
-
-					sum_r += kernel[k_ind] * target_r_normalized;
-					sum_g += kernel[k_ind] * target_g_normalized;
-					sum_b += kernel[k_ind] * target_b_normalized;
-
-					++k_ind;
-				}
-			}
-
-			filter_r = Uint8(sum_r * 255.0f);
-			filter_g = Uint8(sum_g * 255.0f);
-			filter_b = Uint8(sum_b * 255.0f);
+		for (int row = 0; row < rows; ++row)
+		{
+			size_t offset = (size_t)row * width;
 
-			u_filter_pixels_2d[row][col] = SDL_MapRGB(pixel_format, filter_r, filter_g, filter_b);
+			ColorSpace::DecodeRow(pixels.data() + offset, width, r.data() + offset, g.data() + offset, b.data() + offset, Filters::params.LINEAR_LIGHT);
 		}
-	}
 
-	for (int row = 0; row < height; ++row)
-	{
-		for (int col = 0; col < width; ++col)
+		SeparableFilters::Convolve(r.data(), width, rows, kernel);
+		SeparableFilters::Convolve(g.data(), width, rows, kernel);
+		SeparableFilters::Convolve(b.data(), width, rows, kernel);
+
+		for (int row = band_top; row < band_top + band_rows; ++row)
 		{
-			u_filter_pixels[row * width + col] = u_filter_pixels_2d[row][col];
-		}
-	}
+			size_t offset = (size_t)row * width;
 
-	memcpy(filter_pixels, u_filter_pixels, (pitch / 4) * height);
+			ColorSpace::EncodeRow(r.data() + offset, g.data() + offset, b.data() + offset, pixels.data() + offset, width, Filters::params.LINEAR_LIGHT);
+		}
+	}, true);
+}
 
-	SDL_UnlockTexture(filter);
+void Filters::ApplyPlaneFilter(const int& halo, const PlaneFunction& function)
+{
+	std::vector<FILTER_PLANE> planes = Filters::GetPlanes();
 
-	RELEASE_ARRAY2D(u_target_pixels_2d, height);
-	RELEASE_ARRAY2D(u_filter_pixels_2d, height);
+	Filters::ProcessBands(halo, [&](std::vector<Uint32>& pixels, const int& width, const int& rows, const int& band_top, const int& band_rows)
+	{
+		std::vector<Uint8> plane, new_plane(pixels.size());
 
-	SDL_FreeSurface(target_surface);
+		for (size_t i = 0; i < planes.size(); ++i)
+		{
+			Filters::ExtractPlane(pixels, planes[i], plane);
 
-	SDL_FreeFormat(pixel_format);
+			function(plane, new_plane, width, rows, (int)i);
 
-	App->editor->RenderImg(filter, target, false);
+			Filters::InsertPlane(pixels, plane, new_plane, (size_t)band_top * width, (size_t)band_rows * width, planes[i]);
+		}
+	}, true);
 }
 
-void Filters::ApplyMedianBlur(SDL_Texture* target, SDL_Texture* filter, const int& kernel_size)
+std::vector<FILTER_PLANE> Filters::GetPlanes()
 {
-	Uint32 format = App->renderer->texture_format;
-	SDL_PixelFormat* pixel_format = SDL_AllocFormat(format);
-
-	int width, height;
-	SDL_QueryTexture(target, nullptr, nullptr, &width, &height);
+	if (Filters::params.LUMA_ONLY)
+		return { FILTER_PLANE::LUMA };
 
-	App->renderer->SetRenderTarget(target);
+	return { FILTER_PLANE::RED, FILTER_PLANE::GREEN, FILTER_PLANE::BLUE };
+}
 
-	SDL_Surface* target_surface = SDL_CreateRGBSurfaceWithFormat(
-		0,
-		width, height,
-		32,
-		App->renderer->texture_format
-	);
+void Filters::ExtractPlane(const std::vector<Uint32>& pixels, const FILTER_PLANE& channel, std::vector<Uint8>& plane)
+{
+	plane.resize(pixels.size());
 
-	SDL_RenderReadPixels(
-		App->renderer->renderer,
-		nullptr,
-		App->renderer->texture_format,
-		target_surface->pixels,
-		target_surface->pitch
-	);
+	if (channel == FILTER_PLANE::LUMA)
+	{
+		ColorSpace::LumaRow(pixels.data(), (int)pixels.size(), plane.data());
 
-	App->renderer->SetRenderTarget(nullptr);
+		return;
+	}
 
-	Uint32* u_target_pixels = (Uint32*)target_surface->pixels;
+	int shift = (int)channel;
 
-	int pitch;
-	void* filter_pixels;
+	for (size_t i = 0; i < pixels.size(); ++i)
+	{
+		plane[i] = (Uint8)(pixels[i] >> shift);
+	}
+}
 
-	SDL_LockTexture(filter, nullptr, (void**)&filter_pixels, &pitch);
+void Filters::InsertPlane(std::vector<Uint32>& pixels, const std::vector<Uint8>& plane, const std::vector<Uint8>& new_plane, const size_t& first, const size_t& count, const FILTER_PLANE& channel)
+{
+	if (channel == FILTER_PLANE::LUMA)
+	{
+		ColorSpace::ShiftLumaRow(pixels.data() + first, plane.data() + first, new_plane.data() + first, (int)count);
 
-	Uint32* u_filter_pixels = (Uint32*)filter_pixels;
+		return;
+	}
 
-	Uint32** u_target_pixels_2d = Array2D<Uint32>(width, height);
-	Uint32** u_filter_pixels_2d = Array2D<Uint32>(width, height);
+	int shift = (int)channel;
 
-	for (int row = 0; row < height; ++row)
+	for (size_t i = first; i < first + count; ++i)
 	{
-		for (int col = 0; col < width; ++col)
-		{
-			u_target_pixels_2d[row][col] = u_target_pixels[(row * width + col)];
-		}
+		pixels[i] = (pixels[i] & ~((Uint32)0xFF << shift)) | ((Uint32)new_plane[i] << shift);
 	}
+}
+
+void Filters::ApplySharpening(const float& radius, const float& source_weight, const float& detail_weight, const float& threshold)
+{
+	/* The recursive Gaussian never reaches zero, four sigma away its weight is far below one 8-bit level */
+	int halo = (int)std::ceil(4.0f * radius);
 
-	for (int row = 0; row < height; ++row)
+	if (Filters::params.LUMA_ONLY)
 	{
-		for (int col = 0; col < width; ++col)
+		Filters::ApplyPlaneFilter(halo, [&](const std::vector<Uint8>& luma, std::vector<Uint8>& new_luma, const int& width, const int& height, const int&)
 		{
-			Uint8 filter_r, filter_g, filter_b;
-
-			filter_r = 0;
-			filter_g = 0;
-			filter_b = 0;
-
-			int krad = kernel_size / 2;
-			int k_ind = 0;
+			size_t size = (size_t)width * height;
+			std::vector<float> values(size), blurred;
 
-			std::vector<int> r_list(kernel_size * kernel_size);
-			std::vector<int> g_list(kernel_size * kernel_size);
-			std::vector<int> b_list(kernel_size * kernel_size);
-
-			for (int k_row = -krad; k_row <= krad; ++k_row)
+			for (size_t i = 0; i < size; ++i)
 			{
-				for (int k_col = -krad; k_col <= krad; ++k_col)
-				{
-					Uint8 target_r = 0, target_g = 0, target_b = 0;
-					int target_row = row + k_row;
-					int target_col = col + k_col;
-
-					if (target_row >= 0 && target_col >= 0
-						&& target_row < height && target_col < width)
-					{
-						SDL_GetRGB(u_target_pixels_2d[target_row][target_col], pixel_format, &target_r, &target_g, &target_b);
-					}
+				values[i] = luma[i] / 255.0f;
+			}
 
-					r_list[k_ind] = target_r;
-					g_list[k_ind] = target_g;
-					b_list[k_ind] = target_b;
+			Filters::SharpenPlane(values.data(), blurred, width, height, radius, source_weight, detail_weight, threshold);
 
-					++k_ind;
-				}
+			for (size_t i = 0; i < size; ++i)
+			{
+				new_luma[i] = (Uint8)(SDL_clamp(values[i], 0.0f, 1.0f) * 255.0f + 0.5f);
 			}
+		});
 
-			filter_r = (Uint8)Median(r_list);
-			filter_g = (Uint8)Median(g_list);
-			filter_b = (Uint8)Median(b_list);
-
-			u_filter_pixels_2d[row][col] = SDL_MapRGB(pixel_format, filter_r, filter_g, filter_b);
-		}
+		return;
 	}
 
-	for (int row = 0; row < height; ++row)
+	Filters::ProcessBands(halo, [&](std::vector<Uint32>& pixels, const int& width, const int& rows, const int& band_top, const int& band_rows)
 	{
-		for (int col = 0; col < width; ++col)
-		{
-			u_filter_pixels[row * width + col] = u_filter_pixels_2d[row][col];
-		}
-	}
-
-	memcpy(filter_pixels, u_filter_pixels, (pitch / 4) * height);
+		size_t size = (size_t)width * rows;
+		std::vector<float> r(size), g(size), b(size), blurred;
 
-	SDL_UnlockTexture(filter);
+		ParallelFor(0, rows, 64, [&](const int& first, const int& last)
+		{
+			for (int row = first; row < last; ++row)
+			{
+				size_t offset = (size_t)row * width;
 
-	RELEASE_ARRAY2D(u_target_pixels_2d, height);
-	RELEASE_ARRAY2D(u_filter_pixels_2d, height);
+				ColorSpace::DecodeRow(pixels.data() + offset, width, r.data() + offset, g.data() + offset, b.data() + offset, Filters::params.LINEAR_LIGHT);
+			}
+		});
 
-	SDL_FreeSurface(target_surface);
+		Filters::SharpenPlane(r.data(), blurred, width, rows, radius, source_weight, detail_weight, threshold);
+		Filters::SharpenPlane(g.data(), blurred, width, rows, radius, source_weight, detail_weight, threshold);
+		Filters::SharpenPlane(b.data(), blurred, width, rows, radius, source_weight, detail_weight, threshold);
 
-	SDL_FreeFormat(pixel_format);
+		ParallelFor(band_top, band_top + band_rows, 64, [&](const int& first, const int& last)
+		{
+			for (int row = first; row < last; ++row)
+			{
+				size_t offset = (size_t)row * width;
 
-	App->editor->RenderImg(filter, target, false);
+				ColorSpace::EncodeRow(r.data() + offset, g.data() + offset, b.data() + offset, pixels.data() + offset, width, Filters::params.LINEAR_LIGHT);
+			}
+		});
+	}, true);
 }
 
-void Filters::ApplyLaplace(SDL_Texture* target, SDL_Texture* filter)
+void Filters::SharpenPlane(float* plane, std::vector<float>& blurred, const int& width, const int& height, const float& radius, const float& source_weight, const float& detail_weight, const float& threshold)
 {
-	Uint32 format = App->renderer->texture_format;
-	SDL_PixelFormat* pixel_format = SDL_AllocFormat(format);
-
-	int width, height;
-	SDL_QueryTexture(target, nullptr, nullptr, &width, &height);
+	blurred.assign(plane, plane + (size_t)width * height);
 
-	App->renderer->SetRenderTarget(target);
+	SeparableFilters::RecursiveGaussian(blurred.data(), width, height, radius);
 
-	SDL_Surface* target_surface = SDL_CreateRGBSurfaceWithFormat(
-		0,
-		width, height,
-		32,
-		App->renderer->texture_format
-	);
-
-	SDL_RenderReadPixels(
-		App->renderer->renderer,
-		nullptr,
-		App->renderer->texture_format,
-		target_surface->pixels,
-		target_surface->pitch
-	);
-
-	App->renderer->SetRenderTarget(nullptr);
-
-	Uint32* u_target_pixels = (Uint32*)target_surface->pixels;
+	/* Single fused pass over the source and its blurred copy */
+	ParallelFor(0, height, 64, [&](const int& first, const int& last)
+	{
+		for (int row = first; row < last; ++row)
+		{
+			float* line = plane + (size_t)row * width;
+			const float* blurred_line = blurred.data() + (size_t)row * width;
 
-	int pitch;
-	void* filter_pixels;
+			for (int col = 0; col < width; ++col)
+			{
+				float detail = line[col] - blurred_line[col];
 
-	SDL_LockTexture(filter, nullptr, (void**)&filter_pixels, &pitch);
+				if (std::fabs(detail) < threshold)
+					detail = 0.0f;
 
-	Uint32* u_filter_pixels = (Uint32*)filter_pixels;
+				line[col] = source_weight * line[col] + detail_weight * detail;
+			}
+		}
+	});
+}
 
-	std::vector<int> kernel = Filters::CreateLaplaceKernel();
-	int kernel_size = 3;
+void Filters::ApplyAdaptiveFilter(const int& kernel_size, const ADAPTIVE_FILTER& type, const float& noise)
+{
+	std::vector<FILTER_PLANE> planes = Filters::GetPlanes();
+	std::vector<float> noise_levels(planes.size(), noise);
 
-	Uint32** u_target_pixels_2d = Array2D<Uint32>(width, height);
-	Uint32** u_filter_pixels_2d = Array2D<Uint32>(width, height);
+	int radius = kernel_size / 2;
 
-	for (int row = 0; row < height; ++row)
+	if (type == ADAPTIVE_FILTER::WIENER && noise <= 0.0f)
 	{
-		for (int col = 0; col < width; ++col)
-		{
-			u_target_pixels_2d[row][col] = u_target_pixels[(row * width + col)];
-		}
-	}
+		/* The estimate is the mean local variance of the whole image, gathered in a read-only pass */
+		std::vector<double> sums(planes.size(), 0.0);
 
-	for (int row = 0; row < height; ++row)
-	{
-		for (int col = 0; col < width; ++col)
+		Filters::ProcessBands(radius, [&](std::vector<Uint32>& pixels, const int& width, const int& rows, const int& band_top, const int& band_rows)
 		{
-			int krad = kernel_size / 2;
-			int k_ind = 0;
-
-			int sum_r = 0;
-			int sum_g = 0;
-			int sum_b = 0;
+			std::vector<Uint8> plane;
 
-			for (int k_row = -krad; k_row <= krad; ++k_row)
+			for (size_t i = 0; i < planes.size(); ++i)
 			{
-				for (int k_col = -krad; k_col <= krad; ++k_col)
-				{
-					Uint8 k_r = 0, k_g = 0, k_b = 0;
-					int target_row = row + k_row;
-					int target_col = col + k_col;
-
-					if (target_row >= 0 && target_col >= 0
-						&& target_row < height && target_col < width)
-					{
-						SDL_GetRGB(u_target_pixels_2d[target_row][target_col], pixel_format, &k_r, &k_g, &k_b);
-					}
-
-					sum_r += kernel[k_ind] * (int)k_r;
-					sum_g += kernel[k_ind] * (int)k_g;
-					sum_b += kernel[k_ind] * (int)k_b;
+				Filters::ExtractPlane(pixels, planes[i], plane);
 
-					++k_ind;
-				}
+				sums[i] += Filters::SumLocalVariance(plane, width, rows, kernel_size, band_top, band_rows);
 			}
+		}, false);
 
-			CLAMP(sum_r, 0, 255);
-			CLAMP(sum_g, 0, 255);
-			CLAMP(sum_b, 0, 255);
-
-			Uint8 current_target_r = 0;
-			Uint8 current_target_g = 0;
-			Uint8 current_target_b = 0;
-			SDL_GetRGB(u_target_pixels_2d[row][col], pixel_format, &current_target_r, &current_target_g, &current_target_b);
-
-			u_filter_pixels_2d[row][col] = SDL_MapRGB(pixel_format, sum_r, sum_g, sum_b);
-		}
-	}
+		size_t count = SDL_max((size_t)App->editor->layers.GetWidth() * App->editor->layers.GetHeight(), (size_t)1);
 
-	for (int row = 0; row < height; ++row)
-	{
-		for (int col = 0; col < width; ++col)
+		for (size_t i = 0; i < planes.size(); ++i)
 		{
-			u_filter_pixels[row * width + col] = u_filter_pixels_2d[row][col];
+			noise_levels[i] = (float)(sums[i] / count);
 		}
 	}
 
-	memcpy(filter_pixels, u_filter_pixels, (pitch / 4) * height);
-
-	SDL_UnlockTexture(filter);
-
-	RELEASE_ARRAY2D(u_target_pixels_2d, height);
-	RELEASE_ARRAY2D(u_filter_pixels_2d, height);
-
-	SDL_FreeSurface(target_surface);
-
-	SDL_FreeFormat(pixel_format);
-
-	App->editor->RenderImg(filter, target, false);;
+	Filters::ApplyPlaneFilter(radius, [&](const std::vector<Uint8>& src, std::vector<Uint8>& dst, const int& width, const int& height, const int& plane)
+	{
+		Filters::AdaptivePlane(src, dst, width, height, kernel_size, type, noise_levels[plane]);
+	});
 }
 
-void Filters::ApplyLaplaceEnhancement(SDL_Texture* target, SDL_Texture* filter)
+double Filters::SumLocalVariance(const std::vector<Uint8>& src, const int& width, const int& height, const int& kernel_size, const int& band_top, const int& band_rows)
 {
-	Uint32 format = App->renderer->texture_format;
-	SDL_PixelFormat* pixel_format = SDL_AllocFormat(format);
-
-	int width, height;
-	SDL_QueryTexture(target, nullptr, nullptr, &width, &height);
-
-	App->renderer->SetRenderTarget(target);
+	IntegralImage integral;
+	integral.Build(src.data(), width, height);
 
-	SDL_Surface* target_surface = SDL_CreateRGBSurfaceWithFormat(
-		0,
-		width, height,
-		32,
-		App->renderer->texture_format
-	);
+	int radius = kernel_size / 2;
+	std::vector<double> row_sums(band_rows, 0.0);
 
-	SDL_RenderReadPixels(
-		App->renderer->renderer,
-		nullptr,
-		App->renderer->texture_format,
-		target_surface->pixels,
-		target_surface->pitch
-	);
-
-	App->renderer->SetRenderTarget(nullptr);
-
-	Uint32* u_target_pixels = (Uint32*)target_surface->pixels;
-
-	int pitch;
-	void* filter_pixels;
+	ParallelFor(band_top, band_top + band_rows, 64, [&](const int& first, const int& last)
+	{
+		for (int row = first; row < last; ++row)
+		{
+			for (int col = 0; col < width; ++col)
+			{
+				float mean, variance;
+				integral.GetStatistics(col - radius, row - radius, col + radius + 1, row + radius + 1, mean, variance);
 
-	SDL_LockTexture(filter, nullptr, (void**)&filter_pixels, &pitch);
+				row_sums[row - band_top] += variance;
+			}
+		}
+	});
 
-	Uint32* u_filter_pixels = (Uint32*)filter_pixels;
+	return std::accumulate(row_sums.begin(), row_sums.end(), 0.0);
+}
 
-	std::vector<int> kernel = Filters::CreateLaplaceKernel();
-	int kernel_size = 3;
+void Filters::AdaptivePlane(const std::vector<Uint8>& src, std::vector<Uint8>& dst, const int& width, const int& height, const int& kernel_size, const ADAPTIVE_FILTER& type, const float& noise)
+{
+	IntegralImage integral;
+	integral.Build(src.data(), width, height);
 
-	Uint32** u_target_pixels_2d = Array2D<Uint32>(width, height);
-	Uint32** u_filter_pixels_2d = Array2D<Uint32>(width, height);
+	int radius = kernel_size / 2;
+	float noise_variance = noise;
+	float speckle = noise * noise;
 
-	for (int row = 0; row < height; ++row)
+	/* Both filters pull every pixel towards its local mean, less where the local variance exceeds the expected noise */
+	ParallelFor(0, height, 64, [&](const int& first, const int& last)
 	{
-		for (int col = 0; col < width; ++col)
+		for (int row = first; row < last; ++row)
 		{
-			u_target_pixels_2d[row][col] = u_target_pixels[(row * width + col)];
-		}
-	}
+			for (int col = 0; col < width; ++col)
+			{
+				size_t i = (size_t)row * width + col;
 
-	Uint8** initial_target_r = Array2D<Uint8>(width, height);
-	Uint8** initial_target_g = Array2D<Uint8>(width, height);
-	Uint8** initial_target_b = Array2D<Uint8>(width, height);
+				float mean, variance, gain;
+				integral.GetStatistics(col - radius, row - radius, col + radius + 1, row + radius + 1, mean, variance);
 
-	int min_r = 0;
-	int min_g = 0;
-	int min_b = 0;
+				if (type == ADAPTIVE_FILTER::WIENER)
+				{
+					gain = variance > noise_variance ? (variance - noise_variance) / variance : 0.0f;
+				}
+				else
+				{
+					float coefficient = mean > 0.0f ? variance / (mean * mean) : 0.0f;
+					gain = coefficient > speckle ? 1.0f - speckle / coefficient : 0.0f;
+				}
 
-	int** sums_r = Array2D<int>(width, height);
-	int** sums_g = Array2D<int>(width, height);
-	int** sums_b = Array2D<int>(width, height);
+				float value = mean + gain * (src[i] - mean);
+				dst[i] = (Uint8)SDL_clamp(value + 0.5f, 0.0f, 255.0f);
+			}
+		}
+	});
+}
 
-	for (int row = 0; row < height; ++row)
+void Filters::MedianPlane(const std::vector<Uint8>& src, std::vector<Uint8>& dst, const int& width, const int& height, const int& kernel_size)
+{
+	/* Sliding histogram per row, samples outside the plane count as zero */
+	int krad = kernel_size / 2;
+	int half = (kernel_size * kernel_size) / 2;
+
+	ParallelFor(0, height, 8, [&](const int& first, const int& last)
 	{
-		for (int col = 0; col < width; ++col)
+		int histogram[256];
+
+		auto sample = [&](const int& row, const int& col) -> int
 		{
-			SDL_GetRGB(u_target_pixels_2d[row][col], pixel_format, &initial_target_r[row][col], &initial_target_g[row][col], &initial_target_b[row][col]);
+			if (row < 0 || col < 0 || row >= height || col >= width)
+				return 0;
 
-			int krad = kernel_size / 2;
-			int k_ind = 0;
+			return src[(size_t)row * width + col];
+		};
 
-			int sum_r = 0;
-			int sum_g = 0;
-			int sum_b = 0;
+		for (int row = first; row < last; ++row)
+		{
+			memset(histogram, 0, sizeof(histogram));
 
 			for (int k_row = -krad; k_row <= krad; ++k_row)
 			{
 				for (int k_col = -krad; k_col <= krad; ++k_col)
 				{
-					Uint8 k_r = 0, k_g = 0, k_b = 0;
-					int target_row = row + k_row;
-					int target_col = col + k_col;
-
-					if (target_row >= 0 && target_col >= 0
-						&& target_row < height && target_col < width)
-					{
-						SDL_GetRGB(u_target_pixels_2d[target_row][target_col], pixel_format, &k_r, &k_g, &k_b);
-					}
-
-					sum_r += kernel[k_ind] * (int)k_r;
-					sum_g += kernel[k_ind] * (int)k_g;
-					sum_b += kernel[k_ind] * (int)k_b;
-
-					++k_ind;
+					++histogram[sample(row + k_row, k_col)];
 				}
 			}
 
-			sums_r[row][col] = sum_r;
-			sums_g[row][col] = sum_g;
-			sums_b[row][col] = sum_b;
+			int median = 0;
+			int below = 0;
 
-			if (min_r > sum_r) min_r = sum_r;
-			if (min_g > sum_g) min_g = sum_g;
-			if (min_b > sum_b) min_b = sum_b;
-		}
-	}
+			for (int col = 0; col < width; ++col)
+			{
+				if (col > 0)
+				{
+					for (int k_row = -krad; k_row <= krad; ++k_row)
+					{
+						int removed = sample(row + k_row, col - krad - 1);
+						int added = sample(row + k_row, col + krad);
 
-	int** sums_r_min = Array2D<int>(width, height);
-	int** sums_g_min = Array2D<int>(width, height);
-	int** sums_b_min = Array2D<int>(width, height);
+						--histogram[removed];
+						++histogram[added];
 
-	int max_r = 255;
-	int max_g = 255;
-	int max_b = 255;
+						if (removed < median) --below;
+						if (added < median) ++below;
+					}
+				}
 
-	for (int row = 0; row < height; ++row)
-	{
-		for (int col = 0; col < width; ++col)
-		{
-			sums_r_min[row][col] = sums_r[row][col] - min_r;
-			sums_g_min[row][col] = sums_g[row][col] - min_g;
-			sums_b_min[row][col] = sums_b[row][col] - min_b;
+				while (below > half)
+				{
+					--median;
+					below -= histogram[median];
+				}
 
-			if (max_r < sums_r_min[row][col]) max_r = sums_r_min[row][col];
-			if (max_g < sums_g_min[row][col]) max_g = sums_g_min[row][col];
-			if (max_b < sums_b_min[row][col]) max_b = sums_b_min[row][col];
+				while (below + histogram[median] <= half)
+				{
+					below += histogram[median];
+					++median;
+				}
+
+				dst[(size_t)row * width + col] = (Uint8)median;
+			}
 		}
-	}
+	});
+}
 
-	int** initial_sharpened_r = Array2D<int>(width, height);
-	int** initial_sharpened_g = Array2D<int>(width, height);
-	int** initial_sharpened_b = Array2D<int>(width, height);
+void Filters::LaplacePlane(const std::vector<Uint8>& src, std::vector<int>& sums, const int& width, const int& height, const int& band_top, const int& band_rows)
+{
+	/* Kernel response of rows [band_top, band_top + band_rows), samples outside the plane count as zero */
+	std::vector<int> kernel = Filters::CreateLaplaceKernel();
+	int krad = 1;
 
-	int min_sharpened_r = 0;
-	int min_sharpened_g = 0;
-	int min_sharpened_b = 0;
+	sums.resize((size_t)width * band_rows);
 
-	for (int row = 0; row < height; ++row)
+	ParallelFor(band_top, band_top + band_rows, 64, [&](const int& first, const int& last)
 	{
-		for (int col = 0; col < width; ++col)
+		for (int row = first; row < last; ++row)
 		{
-			int r = sums_r_min[row][col] * (255.0f / max_r);
-			int g = sums_g_min[row][col] * (255.0f / max_g);
-			int b = sums_b_min[row][col] * (255.0f / max_b);
+			for (int col = 0; col < width; ++col)
+			{
+				int k_ind = 0;
+				int sum = 0;
 
-			Uint8 wh = (r + g + b) / 3;
+				for (int k_row = -krad; k_row <= krad; ++k_row)
+				{
+					for (int k_col = -krad; k_col <= krad; ++k_col)
+					{
+						int target_row = row + k_row;
+						int target_col = col + k_col;
+
+						if (target_row >= 0 && target_col >= 0
+							&& target_row < height && target_col < width)
+						{
+							sum += kernel[k_ind] * (int)src[(size_t)target_row * width + target_col];
+						}
 
-			initial_sharpened_r[row][col] = (int)initial_target_r[row][col] + r / (kernel_size * kernel_size);
-			initial_sharpened_g[row][col] = (int)initial_target_g[row][col] + g / (kernel_size * kernel_size);
-			initial_sharpened_b[row][col] = (int)initial_target_b[row][col] + b / (kernel_size * kernel_size);
+						++k_ind;
+					}
+				}
 
-			if (min_sharpened_r > initial_sharpened_r[row][col]) min_sharpened_r = initial_sharpened_r[row][col];
-			if (min_sharpened_g > initial_sharpened_g[row][col]) min_sharpened_g = initial_sharpened_g[row][col];
-			if (min_sharpened_b > initial_sharpened_b[row][col]) min_sharpened_b = initial_sharpened_b[row][col];
+				sums[(size_t)(row - band_top) * width + col] = sum;
+			}
 		}
-	}
+	});
+}
 
-	int** final_sharpened_r = Array2D<int>(width, height);
-	int** final_sharpened_g = Array2D<int>(width, height);
-	int** final_sharpened_b = Array2D<int>(width, height);
+void Filters::LaplaceEnhancementPlane(const std::vector<Uint8>& src, std::vector<Uint8>& dst, const int& width, const int& height, const int& band_top, const int& band_rows, LaplaceRange& range, const LAPLACE_PASS& pass)
+{
+	std::vector<int> sums;
+	Filters::LaplacePlane(src, sums, width, height, band_top, band_rows);
 
-	int max_sharpened_r = 255;
-	int max_sharpened_g = 255;
-	int max_sharpened_b = 255;
+	size_t first = (size_t)band_top * width;
 
-	for (int row = 0; row < height; ++row)
+	for (size_t i = 0; i < sums.size(); ++i)
 	{
-		for (int col = 0; col < width; ++col)
+		if (pass == LAPLACE_PASS::SUMS)
 		{
-			final_sharpened_r[row][col] = initial_sharpened_r[row][col] - min_sharpened_r;
-			final_sharpened_g[row][col] = initial_sharpened_g[row][col] - min_sharpened_g;
-			final_sharpened_b[row][col] = initial_sharpened_b[row][col] - min_sharpened_b;
+			range.min_sum = SDL_min(range.min_sum, sums[i]);
+			range.max_sum = SDL_max(range.max_sum, sums[i]);
 
-			if (max_sharpened_r < final_sharpened_r[row][col]) max_sharpened_r = final_sharpened_r[row][col];
-			if (max_sharpened_g < final_sharpened_g[row][col]) max_sharpened_g = final_sharpened_g[row][col];
-			if (max_sharpened_b < final_sharpened_b[row][col]) max_sharpened_b = final_sharpened_b[row][col];
+			continue;
 		}
-	}
 
-	for (int row = 0; row < height; ++row)
-	{
-		for (int col = 0; col < width; ++col)
+		int value = (int)((sums[i] - range.min_sum) * (255.0f / range.max_sum));
+		int sharpened = (int)src[first + i] + value / 9;
+
+		if (pass == LAPLACE_PASS::SHARPENED)
 		{
-			int r = final_sharpened_r[row][col] * (255.0f / max_sharpened_r);
-			int g = final_sharpened_g[row][col] * (255.0f / max_sharpened_g);
-			int b = final_sharpened_b[row][col] * (255.0f / max_sharpened_b);
-
-			u_filter_pixels_2d[row][col] = SDL_MapRGB(
-				pixel_format,
-				(Uint8)r,
-				(Uint8)g,
-				(Uint8)b
-			);
+			range.min_sharpened = SDL_min(range.min_sharpened, sharpened);
+			range.max_sharpened = SDL_max(range.max_sharpened, sharpened);
 		}
-	}
-
-	for (int row = 0; row < height; ++row)
-	{
-		for (int col = 0; col < width; ++col)
+		else
 		{
-			u_filter_pixels[row * width + col] = u_filter_pixels_2d[row][col];
+			dst[first + i] = (Uint8)((sharpened - range.min_sharpened) * (255.0f / range.max_sharpened));
 		}
 	}
-
-	memcpy(filter_pixels, u_filter_pixels, (pitch / 4) * height);
-
-	SDL_UnlockTexture(filter);
-
-	RELEASE_ARRAY2D(u_target_pixels_2d, height);
-	RELEASE_ARRAY2D(u_filter_pixels_2d, height);
-
-	RELEASE_ARRAY2D(initial_target_r, height);
-	RELEASE_ARRAY2D(initial_target_g, height);
-	RELEASE_ARRAY2D(initial_target_b, height);
-
-	RELEASE_ARRAY2D(sums_r, height);
-	RELEASE_ARRAY2D(sums_g, height);
-	RELEASE_ARRAY2D(sums_b, height);
-
-	RELEASE_ARRAY2D(sums_r_min, height);
-	RELEASE_ARRAY2D(sums_g_min, height);
-	RELEASE_ARRAY2D(sums_b_min, height);
-
-	RELEASE_ARRAY2D(initial_sharpened_r, height);
-	RELEASE_ARRAY2D(initial_sharpened_g, height);
-	RELEASE_ARRAY2D(initial_sharpened_b, height);
-
-	RELEASE_ARRAY2D(final_sharpened_r, height);
-	RELEASE_ARRAY2D(final_sharpened_g, height);
-	RELEASE_ARRAY2D(final_sharpened_b, height);
-
-
-
-	SDL_FreeSurface(target_surface);
-
-	SDL_FreeFormat(pixel_format);
-
-
-	App->editor->RenderImg(filter, target, false);
-}
-
-void Filters::ApplyNegative(SDL_Texture* target, SDL_Texture* filter)
-{
-	Uint32 format = App->renderer->texture_format;
-	SDL_PixelFormat* pixel_format = SDL_AllocFormat(format);
-
-	int width, height;
-	SDL_QueryTexture(target, nullptr, nullptr, &width, &height);
-
-	App->renderer->SetRenderTarget(target);
-
-	SDL_Surface* target_surface = SDL_CreateRGBSurfaceWithFormat(
-		0,
-		width, height,
-		32,
-		App->renderer->texture_format
-	);
-
-	SDL_RenderReadPixels(
-		App->renderer->renderer,
-		nullptr,
-		App->renderer->texture_format,
-		target_surface->pixels,
-		target_surface->pitch
-	);
-
-	App->renderer->SetRenderTarget(nullptr);
-
-	Uint32* u_target_pixels = (Uint32*)target_surface->pixels;
-
-	int pitch;
-	void* filter_pixels;
-
-	SDL_LockTexture(filter, nullptr, (void**)&filter_pixels, &pitch);
-
-	Uint32* u_filter_pixels = (Uint32*)filter_pixels;
-
-	for (int i = 0; i < width * height; ++i)
-	{
-		Uint8 target_r, target_g, target_b;
-		SDL_GetRGB(u_target_pixels[i], pixel_format, &target_r, &target_g, &target_b);
-
-		Uint8 filter_r = 255 - target_r;
-		Uint8 filter_g = 255 - target_g;
-		Uint8 filter_b = 255 - target_b;
-
-		u_filter_pixels[i] = SDL_MapRGB(pixel_format, filter_r, filter_g, filter_b);
-	}
-
-	memcpy(filter_pixels, u_filter_pixels, (pitch / 4) * height);
-
-	SDL_UnlockTexture(filter);
-
-	SDL_FreeSurface(target_surface);
-
-	SDL_FreeFormat(pixel_format);
-
-	App->editor->RenderImg(filter, target, false);
 }
 
 std::vector<float> Filters::CreateStaticKernel(const int& kernel_size, const float& value)
 {
-	std::vector<float> kernel(kernel_size * kernel_size, 0.0f);
-
-	for (int i = 0; i < kernel_size; ++i)
-	{
-		for (int j = 0; j < kernel_size; ++j)
-		{
-			kernel[i * kernel_size + j] = value;
-		}
-	}
-
-	return kernel;
+	return std::vector<float>(kernel_size, value);
 }
 
 std::vector<float> Filters::CreateGaussianKernel(const int& kernel_size)
 {
-	std::vector<float> kernel(kernel_size * kernel_size, 0.0f);
+	std::vector<float> kernel(kernel_size, 0.0f);
 
 	int krad = kernel_size / 2;
 	float sigma = krad / 2.0f;
@@ -874,22 +645,14 @@ std::vector<float> Filters::CreateGaussianKernel(const int& kernel_size)
 
 	for (int i = 0; i < kernel_size; ++i)
 	{
-		for (int j = 0; j < kernel_size; ++j)
-		{
-			float x = gaussian(i, krad, sigma) * gaussian(j, krad, sigma);
-			
-			kernel[i * kernel_size + j] = x;
-			
-			sum += x;
-		}
+		kernel[i] = gaussian(i, krad, sigma);
+
+		sum += kernel[i];
 	}
 
 	for (int i = 0; i < kernel_size; ++i)
 	{
-		for (int j = 0; j < kernel_size; ++j)
-		{
-			kernel[i * kernel_size + j] /= sum;
-		}
+		kernel[i] /= sum;
 	}
 
 	return kernel;
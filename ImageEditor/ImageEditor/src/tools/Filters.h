@@ -1,23 +1,102 @@
 #ifndef __FILTERS_H__
 #define __FILTERS_H__
 
+#include <functional>
 #include <iostream>
 #include <vector>
 
-struct SDL_Texture;
+#include "SDL.h"
+
+#include "TiledCanvas.h"
+
+/* Filters that read neighbours run one band of whole tile rows at a time */
+#define FILTER_BAND_ROWS CANVAS_TILE_SIZE
+
+enum class ADAPTIVE_FILTER
+{
+	WIENER = 0,
+	LEE
+};
+
+struct FilterParams
+{
+	bool LINEAR_LIGHT;
+	bool LUMA_ONLY;
+};
+
+/* Values are the shift of the channel inside a pixel, luma is derived from all three */
+enum class FILTER_PLANE
+{
+	LUMA = 0,
+	BLUE = 8,
+	GREEN = 16,
+	RED = 24
+};
+
+enum class LAPLACE_PASS
+{
+	SUMS = 0,
+	SHARPENED,
+	OUTPUT
+};
+
+struct LaplaceRange
+{
+	int min_sum;
+	int max_sum;
+	int min_sharpened;
+	int max_sharpened;
+};
+
+/* Pixels hold the band with up to halo rows above and below, only rows [band_top, band_top + band_rows) are written back */
+typedef std::function<void(std::vector<Uint32>& pixels, const int& width, const int& rows, const int& band_top, const int& band_rows)> BandFunction;
+/* Plane is the index of the channel among the ones being filtered */
+typedef std::function<void(const std::vector<Uint8>& src, std::vector<Uint8>& dst, const int& width, const int& height, const int& plane)> PlaneFunction;
 
 class Filters
 {
 public:
-	static void ApplyGrayScale(SDL_Texture* target, SDL_Texture* filter);
-	static void ApplyBlur(SDL_Texture* target, SDL_Texture* filter, const int& kernel_size);
-	static void ApplyGaussianBlur(SDL_Texture* target, SDL_Texture* filter, const int& kernel_size);
-	static void ApplyMedianBlur(SDL_Texture* target, SDL_Texture* filter, const int& kernel_size);
-	static void ApplyLaplace(SDL_Texture* target, SDL_Texture* filter);
-	static void ApplyLaplaceEnhancement(SDL_Texture* target, SDL_Texture* filter);
-	static void ApplyNegative(SDL_Texture* target, SDL_Texture* filter);
+	static void ApplyGrayScale();
+	static void ApplyBlur(const int& kernel_size);
+	static void ApplyGaussianBlur(const int& kernel_size);
+	static void ApplyMedianBlur(const int& kernel_size);
+	static void ApplyLaplace();
+	static void ApplyLaplaceEnhancement();
+	static void ApplyNegative();
+
+	/* Amount is a percentage, threshold is expressed in 8-bit levels */
+	static void ApplyUnsharpMask(const float& amount, const float& radius, const int& threshold);
+	static void ApplyHighBoost(const float& boost, const float& radius);
+
+	/* Noise variance is expressed in squared 8-bit levels, 0 estimates it as the mean local variance */
+	static void ApplyWienerFilter(const int& kernel_size, const float& noise_variance);
+	/* Noise deviation is the coefficient of variation of the multiplicative speckle */
+	static void ApplyLeeFilter(const int& kernel_size, const float& noise_deviation);
+
+public:
+	static FilterParams params;
 
 private:
+	static void ProcessBands(const int& halo, const BandFunction& function, const bool& write);
+
+	static void ApplySeparableKernel(const std::vector<float>& kernel);
+	static void ApplyPlaneFilter(const int& halo, const PlaneFunction& function);
+
+	static std::vector<FILTER_PLANE> GetPlanes();
+	static void ExtractPlane(const std::vector<Uint32>& pixels, const FILTER_PLANE& channel, std::vector<Uint8>& plane);
+	static void InsertPlane(std::vector<Uint32>& pixels, const std::vector<Uint8>& plane, const std::vector<Uint8>& new_plane, const size_t& first, const size_t& count, const FILTER_PLANE& channel);
+
+	static void ApplySharpening(const float& radius, const float& source_weight, const float& detail_weight, const float& threshold);
+	static void SharpenPlane(float* plane, std::vector<float>& blurred, const int& width, const int& height, const float& radius, const float& source_weight, const float& detail_weight, const float& threshold);
+
+	static void ApplyAdaptiveFilter(const int& kernel_size, const ADAPTIVE_FILTER& type, const float& noise);
+	static double SumLocalVariance(const std::vector<Uint8>& src, const int& width, const int& height, const int& kernel_size, const int& band_top, const int& band_rows);
+	static void AdaptivePlane(const std::vector<Uint8>& src, std::vector<Uint8>& dst, const int& width, const int& height, const int& kernel_size, const ADAPTIVE_FILTER& type, const float& noise);
+
+	static void MedianPlane(const std::vector<Uint8>& src, std::vector<Uint8>& dst, const int& width, const int& height, const int& kernel_size);
+	static void LaplacePlane(const std::vector<Uint8>& src, std::vector<int>& sums, const int& width, const int& height, const int& band_top, const int& band_rows);
+	static void LaplaceEnhancementPlane(const std::vector<Uint8>& src, std::vector<Uint8>& dst, const int& width, const int& height, const int& band_top, const int& band_rows, LaplaceRange& range, const LAPLACE_PASS& pass);
+
 	static std::vector<float> CreateStaticKernel(const int& kernel_size, const float& value);
 	static std::vector<float> CreateGaussianKernel(const int& kernel_size);
 	static std::vector<int> CreateLaplaceKernel();
@@ -0,0 +1,264 @@
+#include <cstdlib>
+#include <emmintrin.h>
+
+#include "TiledCanvas.h"
+#include "FloodFill.h"
+
+static inline bool Matches(const Uint32& pixel, const Uint32& seed, const int& tolerance)
+{
+	if (pixel == seed)
+		return true;
+
+	for (int shift = 0; shift < 32; shift += 8)
+	{
+		if (std::abs((int)((pixel >> shift) & 0xFF) - (int)((seed >> shift) & 0xFF)) > tolerance)
+			return false;
+	}
+
+	return true;
+}
+
+/* Number of leading pixels that match, four at a time */
+static inline int MatchingPrefix(const Uint32* pixels, const int& count, const Uint32& seed, const int& tolerance)
+{
+	const __m128i seeds = _mm_set1_epi32((int)seed);
+	const __m128i limit = _mm_set1_epi8((char)tolerance);
+	const __m128i zero = _mm_setzero_si128();
+
+	int x = 0;
+
+	for (; x + 4 <= count; x += 4)
+	{
+		__m128i block = _mm_loadu_si128((const __m128i*)(pixels + x));
+		__m128i difference = _mm_or_si128(_mm_subs_epu8(block, seeds), _mm_subs_epu8(seeds, block));
+
+		/* Any channel further than the tolerance leaves a non-zero byte */
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(difference, limit), zero)) != 0xFFFF)
+			break;
+	}
+
+	while (x < count && Matches(pixels[x], seed, tolerance))
+	{
+		++x;
+	}
+
+	return x;
+}
+
+/* Reads the canvas a tile row at a time, tiles that are not stored are matched once as a whole */
+struct FillSource
+{
+	const TiledCanvas& canvas;
+	Uint32 seed;
+	int tolerance;
+	bool background_matches;
+
+	/* First pixel at or after x on row y that does not match, or limit */
+	int RunEnd(int x, const int& y, const int& limit) const
+	{
+		int tile_y = y / CANVAS_TILE_SIZE;
+		int row = y - tile_y * CANVAS_TILE_SIZE;
+
+		while (x < limit)
+		{
+			int tile_x = x / CANVAS_TILE_SIZE;
+			int end = SDL_min(limit, (tile_x + 1) * CANVAS_TILE_SIZE);
+			const Uint32* tile = this->canvas.GetTile(tile_x, tile_y);
+
+			if (tile == nullptr)
+			{
+				if (!this->background_matches)
+					return x;
+
+				x = end;
+				continue;
+			}
+
+			int start = tile_x * CANVAS_TILE_SIZE;
+			int matching = MatchingPrefix(tile + (size_t)row * CANVAS_TILE_SIZE + (x - start), end - x, this->seed, this->tolerance);
+
+			if (x + matching < end)
+				return x + matching;
+
+			x = end;
+		}
+
+		return limit;
+	}
+
+	/* Leftmost pixel of the matching run that ends right before x on row y */
+	int RunStart(int x, const int& y) const
+	{
+		int tile_y = y / CANVAS_TILE_SIZE;
+		int row = y - tile_y * CANVAS_TILE_SIZE;
+
+		while (x > 0)
+		{
+			int tile_x = (x - 1) / CANVAS_TILE_SIZE;
+			int start = tile_x * CANVAS_TILE_SIZE;
+			const Uint32* tile = this->canvas.GetTile(tile_x, tile_y);
+
+			if (tile == nullptr)
+			{
+				if (!this->background_matches)
+					return x;
+
+				x = start;
+				continue;
+			}
+
+			const Uint32* line = tile + (size_t)row * CANVAS_TILE_SIZE;
+
+			for (; x > start; --x)
+			{
+				if (!Matches(line[x - 1 - start], this->seed, this->tolerance))
+					return x;
+			}
+		}
+
+		return 0;
+	}
+
+	bool Test(const int& x, const int& y) const
+	{
+		const Uint32* tile = this->canvas.GetTile(x / CANVAS_TILE_SIZE, y / CANVAS_TILE_SIZE);
+
+		if (tile == nullptr)
+			return this->background_matches;
+
+		return Matches(tile[(size_t)(y % CANVAS_TILE_SIZE) * CANVAS_TILE_SIZE + x % CANVAS_TILE_SIZE], this->seed, this->tolerance);
+	}
+};
+
+/* One bit per pixel, so runs that are already filled are skipped 64 pixels at a time */
+class FillMask
+{
+public:
+	FillMask(const int& width, const int& height)
+		: width(width), bits(((size_t)width * height + 63) / 64, 0)
+	{
+
+	}
+
+	void Mark(const int& y, const int& x0, const int& x1)
+	{
+		size_t first = (size_t)y * this->width + x0;
+		size_t last = (size_t)y * this->width + x1;
+
+		for (size_t i = first; i < last;)
+		{
+			if ((i & 63) == 0 && i + 64 <= last)
+			{
+				this->bits[i >> 6] = ~0ull;
+				i += 64;
+			}
+			else
+			{
+				this->bits[i >> 6] |= 1ull << (i & 63);
+				++i;
+			}
+		}
+	}
+
+	/* First pixel at or after x on row y that is not filled yet, or limit */
+	int NextFree(const int& y, int x, const int& limit) const
+	{
+		size_t base = (size_t)y * this->width;
+
+		while (x < limit)
+		{
+			size_t i = base + x;
+			Uint64 word = this->bits[i >> 6] >> (i & 63);
+
+			if ((word & 1) == 0)
+				return x;
+
+			/* Jumps over the filled bits left in this word */
+			int filled = (word == (~0ull >> (i & 63))) ? 64 - (int)(i & 63) : 1;
+			x += filled;
+		}
+
+		return limit;
+	}
+
+private:
+	int width;
+	std::vector<Uint64> bits;
+};
+
+void FloodFill::Fill(const TiledCanvas& canvas, const int& x, const int& y, const FloodFillParams& params, std::vector<Span>& spans)
+{
+	spans.clear();
+
+	int width = canvas.GetWidth();
+	int height = canvas.GetHeight();
+
+	if (x < 0 || y < 0 || x >= width || y >= height)
+		return;
+
+	FillSource source = { canvas, 0, SDL_clamp(params.TOLERANCE, 0, 255), false };
+
+	const Uint32* seed_tile = canvas.GetTile(x / CANVAS_TILE_SIZE, y / CANVAS_TILE_SIZE);
+	source.seed = seed_tile ? seed_tile[(size_t)(y % CANVAS_TILE_SIZE) * CANVAS_TILE_SIZE + x % CANVAS_TILE_SIZE] : canvas.GetBackground();
+	source.background_matches = Matches(canvas.GetBackground(), source.seed, source.tolerance);
+
+	FillMask mask(width, height);
+	int reach = params.CONNECTIVITY_TYPE == CONNECTIVITY::EIGHT ? 1 : 0;
+
+	/* Every span on the stack is filled, its rows above and below are still to be scanned */
+	std::vector<Span> stack;
+
+	Span first = { y, source.RunStart(x, y), source.RunEnd(x, y, width) };
+	mask.Mark(first.y, first.x0, first.x1);
+	spans.push_back(first);
+	stack.push_back(first);
+
+	while (!stack.empty())
+	{
+		Span span = stack.back();
+		stack.pop_back();
+
+		int left = SDL_max(span.x0 - reach, 0);
+		int right = SDL_min(span.x1 + reach, width);
+
+		for (int row = span.y - 1; row <= span.y + 1; row += 2)
+		{
+			if (row < 0 || row >= height)
+				continue;
+
+			int position = left;
+
+			while (position < right)
+			{
+				position = mask.NextFree(row, position, right);
+
+				if (position >= right)
+					break;
+
+				if (!source.Test(position, row))
+				{
+					++position;
+					continue;
+				}
+
+				/* Filled runs are maximal, so only a run starting at the left edge can reach further left */
+				Span found = { row, position == left ? source.RunStart(position, row) : position, source.RunEnd(position, row, width) };
+
+				mask.Mark(found.y, found.x0, found.x1);
+				spans.push_back(found);
+				stack.push_back(found);
+
+				position = found.x1;
+			}
+		}
+	}
+}
+
+FloodFillParams FloodFill::DefaultParams()
+{
+	FloodFillParams params;
+	params.TOLERANCE = 32;
+	params.CONNECTIVITY_TYPE = CONNECTIVITY::FOUR;
+
+	return params;
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef __FLOOD_FILL_H__
+#define __FLOOD_FILL_H__
+
+#include <vector>
+
+#include "SDL.h"
+
+#include "ConnectedComponents.h"
+#include "SpanRasterizer.h"
+
+class TiledCanvas;
+
+struct FloodFillParams
+{
+	int TOLERANCE;
+	CONNECTIVITY CONNECTIVITY_TYPE;
+};
+
+/* Scanline fill driven by a stack of filled spans. Pixels are read straight from the tiles and every pixel is tested a bounded number of times */
+class FloodFill
+{
+public:
+	/* Spans of the region connected to (x, y) whose channels all lie within TOLERANCE of the pixel there. Empty when the seed is outside the canvas */
+	static void Fill(const TiledCanvas& canvas, const int& x, const int& y, const FloodFillParams& params, std::vector<Span>& spans);
+
+	static FloodFillParams DefaultParams();
+};
+
+#endif /* __FLOOD_FILL_H__ */
\ No newline at end of file
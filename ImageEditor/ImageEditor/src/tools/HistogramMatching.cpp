@@ -0,0 +1,197 @@
+#include <mutex>
+
+#include "modules/Editor.h"
+#include "utils/Parallel.h"
+#include "Application.h"
+#include "ColorSpace.h"
+#include "ImageLoader.h"
+#include "HistogramMatching.h"
+
+#define HISTOGRAM_MATCHING_CHUNK 65536
+
+bool HistogramMatching::ApplyMatchHistogram(const std::string& reference_path, const HISTOGRAM_MATCHING_MODE& mode)
+{
+	std::vector<Uint32> reference;
+	int reference_width, reference_height;
+
+	if (!ImageLoader::LoadPixels(reference_path, reference, reference_width, reference_height))
+		return false;
+
+	std::vector<Uint32> pixels;
+	int width, height;
+
+	App->editor->ReadCanvasPixels(pixels, width, height);
+
+	HistogramMatching::Match(pixels.data(), pixels.size(), reference.data(), reference.size(), mode);
+
+	App->editor->WriteCanvasPixels(pixels, width, height);
+
+	return true;
+}
+
+void HistogramMatching::Match(Uint32* pixels, const size_t& count, const Uint32* reference, const size_t& reference_count, const HISTOGRAM_MATCHING_MODE& mode)
+{
+	if (count == 0 || reference_count == 0)
+		return;
+
+	ChannelHistograms source_histograms, reference_histograms;
+
+	HistogramMatching::ComputeHistograms(pixels, count, mode, source_histograms);
+	HistogramMatching::ComputeHistograms(reference, reference_count, mode, reference_histograms);
+
+	Uint8 luts[3 * 256];
+	int channels = mode == HISTOGRAM_MATCHING_MODE::RGB ? 3 : 1;
+
+	for (int c = 0; c < channels; ++c)
+	{
+		HistogramMatching::BuildLUT(source_histograms.data() + c * 256, reference_histograms.data() + c * 256, luts + c * 256);
+	}
+
+	if (mode == HISTOGRAM_MATCHING_MODE::RGB)
+	{
+		HistogramMatching::ApplyRGB(pixels, count, luts);
+	}
+	else
+	{
+		HistogramMatching::ApplyLuma(pixels, count, luts);
+	}
+}
+
+void HistogramMatching::ComputeHistograms(const Uint32* pixels, const size_t& count, const HISTOGRAM_MATCHING_MODE& mode, ChannelHistograms& histograms)
+{
+	histograms.fill(0);
+
+	std::mutex merge_mutex;
+
+	/* Every chunk counts into a private histogram, so threads only meet once per chunk */
+	ParallelFor(0, (int)((count + HISTOGRAM_MATCHING_CHUNK - 1) / HISTOGRAM_MATCHING_CHUNK), 1, [&](const int& first, const int& last)
+	{
+		std::array<Uint32, 3 * 256> local = {};
+		std::vector<Uint8> luma;
+
+		for (int chunk = first; chunk < last; ++chunk)
+		{
+			size_t begin = (size_t)chunk * HISTOGRAM_MATCHING_CHUNK;
+			int length = (int)SDL_min((size_t)HISTOGRAM_MATCHING_CHUNK, count - begin);
+
+			if (mode == HISTOGRAM_MATCHING_MODE::RGB)
+			{
+				for (int i = 0; i < length; ++i)
+				{
+					Uint32 pixel = pixels[begin + i];
+
+					local[pixel >> 24]++;
+					local[256 + ((pixel >> 16) & 0xFF)]++;
+					local[512 + ((pixel >> 8) & 0xFF)]++;
+				}
+			}
+			else
+			{
+				luma.resize(length);
+				ColorSpace::LumaRow(pixels + begin, length, luma.data());
+
+				for (int i = 0; i < length; ++i)
+				{
+					local[luma[i]]++;
+				}
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(merge_mutex);
+
+		for (size_t bin = 0; bin < local.size(); ++bin)
+		{
+			histograms[bin] += local[bin];
+		}
+	});
+}
+
+void HistogramMatching::BuildLUT(const Uint64* source, const Uint64* reference, Uint8* lut)
+{
+	Uint64 source_total = 0, reference_total = 0;
+
+	for (int i = 0; i < 256; ++i)
+	{
+		source_total += source[i];
+		reference_total += reference[i];
+	}
+
+	if (source_total == 0 || reference_total == 0)
+	{
+		for (int i = 0; i < 256; ++i)
+		{
+			lut[i] = (Uint8)i;
+		}
+
+		return;
+	}
+
+	/* Both CDFs are monotonic, so a single walk over the reference finds the first level reaching each source quantile */
+	double source_cdf = 0.0, reference_cdf = 0.0;
+	int level = 0;
+
+	reference_cdf = (double)reference[0] / reference_total;
+
+	for (int i = 0; i < 256; ++i)
+	{
+		source_cdf += (double)source[i] / source_total;
+
+		while (level < 255 && reference_cdf < source_cdf - 1e-12)
+		{
+			reference_cdf += (double)reference[++level] / reference_total;
+		}
+
+		lut[i] = (Uint8)level;
+	}
+}
+
+void HistogramMatching::ApplyRGB(Uint32* pixels, const size_t& count, const Uint8* luts)
+{
+	/* SSE2 has no gather, so the per-channel tables are widened to pre-shifted 32-bit entries and merged with ORs */
+	Uint32 r[256], g[256], b[256];
+
+	for (int i = 0; i < 256; ++i)
+	{
+		r[i] = (Uint32)luts[i] << 24;
+		g[i] = (Uint32)luts[256 + i] << 16;
+		b[i] = (Uint32)luts[512 + i] << 8;
+	}
+
+	ParallelFor(0, (int)((count + HISTOGRAM_MATCHING_CHUNK - 1) / HISTOGRAM_MATCHING_CHUNK), 1, [&](const int& first, const int& last)
+	{
+		size_t end = SDL_min((size_t)last * HISTOGRAM_MATCHING_CHUNK, count);
+
+		for (size_t i = (size_t)first * HISTOGRAM_MATCHING_CHUNK; i < end; ++i)
+		{
+			Uint32 pixel = pixels[i];
+
+			pixels[i] = r[pixel >> 24] | g[(pixel >> 16) & 0xFF] | b[(pixel >> 8) & 0xFF] | (pixel & 0xFF);
+		}
+	});
+}
+
+void HistogramMatching::ApplyLuma(Uint32* pixels, const size_t& count, const Uint8* lut)
+{
+	ParallelFor(0, (int)((count + HISTOGRAM_MATCHING_CHUNK - 1) / HISTOGRAM_MATCHING_CHUNK), 1, [&](const int& first, const int& last)
+	{
+		std::vector<Uint8> luma, new_luma;
+
+		for (int chunk = first; chunk < last; ++chunk)
+		{
+			size_t begin = (size_t)chunk * HISTOGRAM_MATCHING_CHUNK;
+			int length = (int)SDL_min((size_t)HISTOGRAM_MATCHING_CHUNK, count - begin);
+
+			luma.resize(length);
+			new_luma.resize(length);
+
+			ColorSpace::LumaRow(pixels + begin, length, luma.data());
+
+			for (int i = 0; i < length; ++i)
+			{
+				new_luma[i] = lut[luma[i]];
+			}
+
+			ColorSpace::ShiftLumaRow(pixels + begin, luma.data(), new_luma.data(), length);
+		}
+	});
+}
\ No newline at end of file
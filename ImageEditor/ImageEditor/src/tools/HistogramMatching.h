@@ -0,0 +1,35 @@
+#ifndef __HISTOGRAM_MATCHING_H__
+#define __HISTOGRAM_MATCHING_H__
+
+#include <array>
+#include <cstddef>
+#include <string>
+
+#include "SDL.h"
+
+enum class HISTOGRAM_MATCHING_MODE
+{
+	RGB = 0,
+	LUMA
+};
+
+/* 256 bins for each of R, G and B, or a single luma histogram in the first 256 bins */
+typedef std::array<Uint64, 3 * 256> ChannelHistograms;
+
+class HistogramMatching
+{
+public:
+	static bool ApplyMatchHistogram(const std::string& reference_path, const HISTOGRAM_MATCHING_MODE& mode);
+
+	/* Maps the distribution of pixels to the one of reference, alpha is preserved */
+	static void Match(Uint32* pixels, const size_t& count, const Uint32* reference, const size_t& reference_count, const HISTOGRAM_MATCHING_MODE& mode);
+
+	static void ComputeHistograms(const Uint32* pixels, const size_t& count, const HISTOGRAM_MATCHING_MODE& mode, ChannelHistograms& histograms);
+	static void BuildLUT(const Uint64* source, const Uint64* reference, Uint8* lut);
+
+private:
+	static void ApplyRGB(Uint32* pixels, const size_t& count, const Uint8* luts);
+	static void ApplyLuma(Uint32* pixels, const size_t& count, const Uint8* lut);
+};
+
+#endif /* __HISTOGRAM_MATCHING_H__ */
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include "LayerStack.h"
+#include "History.h"
+
+History::History()
+	: position(0), memory_limit((size_t)HISTORY_MEMORY_LIMIT_MB << 20), memory_used(0)
+{
+
+}
+
+History::~History()
+{
+
+}
+
+void History::Commit(LayerStack& layers)
+{
+	HistoryStep step;
+	step.bytes_before = 0;
+	step.bytes_after = 0;
+
+	for (Layer& layer : layers.layers)
+	{
+		CanvasChange change;
+
+		if (layer.canvas->TakeChange(change))
+		{
+			step.bytes_before += History::CountBytes(change, false);
+			step.bytes_after += History::CountBytes(change, true);
+			step.changes.emplace_back(layer.id, std::move(change));
+		}
+	}
+
+	if (step.changes.empty())
+		return;
+
+	while (this->steps.size() > this->position)
+	{
+		this->memory_used -= this->steps.back().bytes_before;
+		this->steps.pop_back();
+	}
+
+	this->memory_used += step.bytes_before;
+	this->steps.push_back(std::move(step));
+	this->position = this->steps.size();
+
+	this->Trim();
+}
+
+bool History::Undo(LayerStack& layers)
+{
+	/* Whatever is still being written is undone first */
+	this->Commit(layers);
+
+	if (!this->CanUndo())
+		return false;
+
+	--this->position;
+	this->Apply(layers, this->steps[this->position], true);
+
+	return true;
+}
+
+bool History::Redo(LayerStack& layers)
+{
+	this->Commit(layers);
+
+	if (!this->CanRedo())
+		return false;
+
+	this->Apply(layers, this->steps[this->position], false);
+	++this->position;
+
+	return true;
+}
+
+void History::Clear(LayerStack& layers)
+{
+	this->steps.clear();
+	this->position = 0;
+	this->memory_used = 0;
+
+	for (Layer& layer : layers.layers)
+	{
+		layer.canvas->DiscardChange();
+	}
+}
+
+bool History::CanUndo() const
+{
+	return this->position > 0;
+}
+
+bool History::CanRedo() const
+{
+	return this->position < this->steps.size();
+}
+
+void History::SetMemoryLimit(const size_t& bytes)
+{
+	this->memory_limit = bytes;
+
+	this->Trim();
+}
+
+size_t History::GetMemoryUsage() const
+{
+	/* Once undone, the newest pixels are only kept by the history */
+	return this->memory_used + (this->steps.empty() ? 0 : this->steps.back().bytes_after);
+}
+
+void History::Apply(LayerStack& layers, const HistoryStep& step, const bool& undo)
+{
+	for (size_t i = 0; i < step.changes.size(); ++i)
+	{
+		const std::pair<int, CanvasChange>& change = step.changes[undo ? step.changes.size() - 1 - i : i];
+
+		/* Edits of removed layers are gone with them */
+		TiledCanvas* canvas = layers.FindLayer(change.first);
+
+		if (canvas)
+		{
+			canvas->ApplyChange(change.second, undo);
+		}
+	}
+
+	for (const std::pair<int, CanvasChange>& change : step.changes)
+	{
+		if (change.second.resized_from == nullptr)
+			continue;
+
+		/* Layers added after the resize were not part of it, they follow the size of the others */
+		const CanvasState& state = undo ? *change.second.resized_from : *change.second.resized_to;
+		layers.Resize(state.width, state.height);
+
+		for (Layer& layer : layers.layers)
+		{
+			layer.canvas->DiscardChange();
+		}
+
+		break;
+	}
+}
+
+void History::Trim()
+{
+	while (this->GetMemoryUsage() > this->memory_limit && this->steps.size() > 1)
+	{
+		if (this->position > 0)
+		{
+			this->memory_used -= this->steps.front().bytes_before;
+			this->steps.pop_front();
+
+			--this->position;
+		}
+		else
+		{
+			this->memory_used -= this->steps.back().bytes_before;
+			this->steps.pop_back();
+		}
+	}
+}
+
+size_t History::CountBytes(const CanvasChange& change, const bool& after)
+{
+	/* Tiles showing the background hold no pixels */
+	size_t tiles = 0;
+
+	for (const TilePixels& pixels : after ? change.after : change.before)
+	{
+		tiles += pixels != nullptr;
+	}
+
+	if (change.resized_from)
+	{
+		for (const TilePixels& pixels : after ? change.resized_to->tiles : change.resized_from->tiles)
+		{
+			tiles += pixels != nullptr;
+		}
+	}
+
+	return tiles * CANVAS_TILE_SIZE * CANVAS_TILE_SIZE * sizeof(Uint32);
+}
\ No newline at end of file
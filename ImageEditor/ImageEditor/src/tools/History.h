@@ -0,0 +1,61 @@
+#ifndef __HISTORY_H__
+#define __HISTORY_H__
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "TiledCanvas.h"
+
+#define HISTORY_MEMORY_LIMIT_MB 512
+
+class LayerStack;
+
+struct HistoryStep
+{
+	/* Layer id and what was written to it */
+	std::vector<std::pair<int, CanvasChange>> changes;
+
+	/* The old pixels are owned by this step, the new ones are the old pixels of the next step or the canvas itself */
+	size_t bytes_before;
+	size_t bytes_after;
+};
+
+/* Steps keep only the tiles that changed. Their pixels are shared with the canvas and with the other steps, so committing a step copies nothing */
+class History
+{
+public:
+	History();
+	~History();
+
+	/* Everything written to the layers since the last call becomes one step, the steps that were undone are dropped */
+	void Commit(LayerStack& layers);
+	bool Undo(LayerStack& layers);
+	bool Redo(LayerStack& layers);
+	void Clear(LayerStack& layers);
+
+	bool CanUndo() const;
+	bool CanRedo() const;
+
+	/* Once the steps hold more than this the oldest ones go first, the latest step is always kept */
+	void SetMemoryLimit(const size_t& bytes);
+	size_t GetMemoryUsage() const;
+
+private:
+	void Apply(LayerStack& layers, const HistoryStep& step, const bool& undo);
+	void Trim();
+
+	static size_t CountBytes(const CanvasChange& change, const bool& after);
+
+private:
+	std::deque<HistoryStep> steps;
+
+	/* Steps before it can be undone, the ones from it on can be redone */
+	size_t position;
+
+	size_t memory_limit;
+	/* Old pixels of every step, the newest step also adds its new pixels in GetMemoryUsage */
+	size_t memory_used;
+};
+
+#endif /* __HISTORY_H__ */
\ No newline at end of file
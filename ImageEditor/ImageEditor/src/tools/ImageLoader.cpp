@@ -1,3 +1,4 @@
+#include <cstring>
 #include <iostream>
 #include <filesystem>
 #include <windows.h>
@@ -28,19 +29,56 @@ SDL_Texture* ImageLoader::LoadTexture(SDL_Renderer* renderer, const std::string&
     return texture;
 }
 
-void ImageLoader::SaveTexture(SDL_Renderer* renderer, SDL_Texture* texture, const std::string& path)
+bool ImageLoader::LoadPixels(const std::string& path, std::vector<Uint32>& pixels, int& width, int& height)
+{
+    SDL_Surface* surface = IMG_Load(path.c_str());
+    if (surface == nullptr)
+    {
+        printf("Image %s can't be loaded. IMG_GetError: %s\n", path.c_str(), IMG_GetError());
+        return false;
+    }
+
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, App->renderer->texture_format, 0);
+    SDL_FreeSurface(surface);
+
+    if (converted == nullptr)
+    {
+        printf("Image %s can't be converted. SDL_GetError: %s\n", path.c_str(), SDL_GetError());
+        return false;
+    }
+
+    width = converted->w;
+    height = converted->h;
+    pixels.resize((size_t)width * height);
+
+    for (int row = 0; row < height; ++row)
+    {
+        memcpy(pixels.data() + (size_t)row * width, (Uint8*)converted->pixels + (size_t)row * converted->pitch, width * sizeof(Uint32));
+    }
+
+    SDL_FreeSurface(converted);
+
+    return true;
+}
+
+void ImageLoader::SavePixels(const std::string& path, const std::vector<Uint32>& pixels, const int& width, const int& height)
 {
     std::string extension = std::filesystem::path(path).extension().string();
 
-    SDL_Texture* target = SDL_GetRenderTarget(renderer);
-    SDL_SetRenderTarget(renderer, texture);
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(
+        (void*)pixels.data(),
+        width, height,
+        32,
+        width * sizeof(Uint32),
+        App->renderer->texture_format
+    );
 
-    int width, height;
-    ImageLoader::GetTextureDimensions(texture, &width, &height);
+    if (surface == nullptr)
+    {
+        printf("Surface for %s can't be created. SDL_GetError: %s\n", path.c_str(), SDL_GetError());
+        return;
+    }
 
-    SDL_Surface* surface = SDL_CreateRGBSurface(0, width, height, 32, 0, 0, 0, 0);
-    SDL_RenderReadPixels(renderer, nullptr, surface->format->format, surface->pixels, surface->pitch);
-    
     if (extension == ".bmp")
         SDL_SaveBMP(surface, path.c_str());
     else if (extension == ".png")
@@ -49,7 +87,6 @@ void ImageLoader::SaveTexture(SDL_Renderer* renderer, SDL_Texture* texture, cons
         IMG_SaveJPG(surface, path.c_str(), 100);
 
     SDL_FreeSurface(surface);
-    SDL_SetRenderTarget(renderer, target);
 }
 
 void ImageLoader::GetTextureDimensions(SDL_Texture* texture, int* width, int* height)
@@ -78,6 +115,5 @@ void ImageLoader::SendMatToEditor(const cv::Mat& ldr, const bool& normalized)
     else
         cv::imwrite(save_path, ldr);
 
-    App->editor->bg = App->editor->LoadImg(save_path);
-    App->editor->RenderImg(App->editor->bg, App->renderer->texture_target);
+    App->editor->LoadImg(save_path);
 }
\ No newline at end of file
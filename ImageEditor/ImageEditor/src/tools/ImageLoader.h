@@ -2,6 +2,7 @@
 #define __IMAGE_LOADER_H__
 
 #include <iostream>
+#include <vector>
 
 #include "SDL.h"
 #include "opencv2/imgcodecs.hpp"
@@ -13,7 +14,8 @@ class ImageLoader
 {
 public:
 	static SDL_Texture* LoadTexture(SDL_Renderer* renderer, const std::string& path);
-	static void SaveTexture(SDL_Renderer* renderer, SDL_Texture* texture, const std::string& path);
+	static bool LoadPixels(const std::string& path, std::vector<Uint32>& pixels, int& width, int& height);
+	static void SavePixels(const std::string& path, const std::vector<Uint32>& pixels, const int& width, const int& height);
 	
 	static void GetTextureDimensions(SDL_Texture* texture, int* width, int* height);
 	static void GetTextureInformation(SDL_Texture* texture, Uint32* format, int* access, int* width, int* height);
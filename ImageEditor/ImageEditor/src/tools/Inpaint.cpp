@@ -0,0 +1,251 @@
+#include <cmath>
+#include <cstring>
+#include <queue>
+
+#include "modules/Editor.h"
+#include "Application.h"
+#include "Inpaint.h"
+
+#define INPAINT_INF 1e6f
+
+enum class INPAINT_FLAG : Uint8
+{
+	KNOWN = 0,
+	BAND,
+	INSIDE
+};
+
+void Inpaint::ApplyToCanvas(const std::vector<Uint8>& mask, const int& mask_width, const SDL_Rect& region, const int& radius)
+{
+	if (SDL_RectEmpty(&region))
+		return;
+
+	int mask_height = (int)(mask.size() / mask_width);
+	int margin = radius + 2;
+
+	SDL_Rect canvas = { 0, 0, mask_width, mask_height };
+	SDL_Rect expanded = { region.x - margin, region.y - margin, region.w + 2 * margin, region.h + 2 * margin };
+	SDL_Rect roi;
+
+	if (!SDL_IntersectRect(&canvas, &expanded, &roi))
+		return;
+
+	std::vector<Uint32> pixels;
+	App->editor->ReadCanvasRegion(pixels, roi);
+
+	std::vector<Uint8> roi_mask((size_t)roi.w * roi.h);
+
+	for (int row = 0; row < roi.h; ++row)
+	{
+		memcpy(roi_mask.data() + (size_t)row * roi.w, mask.data() + (size_t)(roi.y + row) * mask_width + roi.x, roi.w);
+	}
+
+	Inpaint::Telea(pixels.data(), roi_mask.data(), roi.w, roi.h, radius);
+
+	App->editor->WriteCanvasRegion(pixels, roi);
+}
+
+void Inpaint::Telea(Uint32* pixels, const Uint8* mask, const int& width, const int& height, const int& radius)
+{
+	size_t size = (size_t)width * height;
+
+	std::vector<Uint8> flags(size);
+	std::vector<float> distance(size);
+
+	typedef std::pair<float, int> BandEntry;
+	std::priority_queue<BandEntry, std::vector<BandEntry>, std::greater<BandEntry>> band;
+
+	for (size_t i = 0; i < size; ++i)
+	{
+		flags[i] = (Uint8)(mask[i] ? INPAINT_FLAG::INSIDE : INPAINT_FLAG::KNOWN);
+		distance[i] = mask[i] ? INPAINT_INF : 0.0f;
+	}
+
+	/* The initial narrow band is the ring of known pixels touching the mask */
+	const int offsets_x[4] = { -1, 1, 0, 0 };
+	const int offsets_y[4] = { 0, 0, -1, 1 };
+
+	for (int y = 0; y < height; ++y)
+	{
+		for (int x = 0; x < width; ++x)
+		{
+			int i = y * width + x;
+
+			if (flags[i] != (Uint8)INPAINT_FLAG::KNOWN)
+				continue;
+
+			for (int k = 0; k < 4; ++k)
+			{
+				int nx = x + offsets_x[k];
+				int ny = y + offsets_y[k];
+
+				if (nx >= 0 && ny >= 0 && nx < width && ny < height && flags[ny * width + nx] == (Uint8)INPAINT_FLAG::INSIDE)
+				{
+					flags[i] = (Uint8)INPAINT_FLAG::BAND;
+					band.push({ 0.0f, i });
+					break;
+				}
+			}
+		}
+	}
+
+	while (!band.empty())
+	{
+		int i = band.top().second;
+		band.pop();
+
+		if (flags[i] == (Uint8)INPAINT_FLAG::KNOWN)
+			continue;
+
+		flags[i] = (Uint8)INPAINT_FLAG::KNOWN;
+
+		int x = i % width;
+		int y = i / width;
+
+		for (int k = 0; k < 4; ++k)
+		{
+			int nx = x + offsets_x[k];
+			int ny = y + offsets_y[k];
+
+			if (nx < 0 || ny < 0 || nx >= width || ny >= height)
+				continue;
+
+			int n = ny * width + nx;
+
+			if (flags[n] == (Uint8)INPAINT_FLAG::KNOWN)
+				continue;
+
+			/* Arrival time from the four quadrants, neighbours outside the image count as unknown */
+			int left = nx > 0 ? n - 1 : -1;
+			int right = nx + 1 < width ? n + 1 : -1;
+			int up = ny > 0 ? n - width : -1;
+			int down = ny + 1 < height ? n + width : -1;
+
+			float arrival = INPAINT_INF;
+			arrival = SDL_min(arrival, Inpaint::Solve(distance, flags, up, left));
+			arrival = SDL_min(arrival, Inpaint::Solve(distance, flags, up, right));
+			arrival = SDL_min(arrival, Inpaint::Solve(distance, flags, down, left));
+			arrival = SDL_min(arrival, Inpaint::Solve(distance, flags, down, right));
+
+			distance[n] = arrival;
+
+			if (flags[n] == (Uint8)INPAINT_FLAG::INSIDE)
+			{
+				Inpaint::InpaintPixel(pixels, distance, flags, width, height, nx, ny, radius);
+
+				flags[n] = (Uint8)INPAINT_FLAG::BAND;
+				band.push({ arrival, n });
+			}
+		}
+	}
+}
+
+float Inpaint::Solve(const std::vector<float>& distance, const std::vector<Uint8>& flags, const int& a, const int& b)
+{
+	bool known_a = a >= 0 && flags[a] == (Uint8)INPAINT_FLAG::KNOWN;
+	bool known_b = b >= 0 && flags[b] == (Uint8)INPAINT_FLAG::KNOWN;
+
+	if (known_a && known_b)
+	{
+		float t1 = distance[a];
+		float t2 = distance[b];
+		float difference = t1 - t2;
+
+		if (difference * difference < 2.0f)
+		{
+			float r = std::sqrt(2.0f - difference * difference);
+			float s = (t1 + t2 + r) * 0.5f;
+
+			if (s >= t1 && s >= t2)
+				return s;
+		}
+
+		return 1.0f + SDL_min(t1, t2);
+	}
+
+	if (known_a)
+		return 1.0f + distance[a];
+
+	if (known_b)
+		return 1.0f + distance[b];
+
+	return INPAINT_INF;
+}
+
+void Inpaint::InpaintPixel(Uint32* pixels, const std::vector<float>& distance, const std::vector<Uint8>& flags, const int& width, const int& height, const int& x, const int& y, const int& radius)
+{
+	auto known = [&](const int& px, const int& py)
+	{
+		return px >= 0 && py >= 0 && px < width && py < height && flags[py * width + px] != (Uint8)INPAINT_FLAG::INSIDE;
+	};
+
+	auto channel = [&](const int& px, const int& py, const int& shift)
+	{
+		return (float)((pixels[py * width + px] >> shift) & 0xFF);
+	};
+
+	auto gradient = [&](const int& px, const int& py, const int& dx, const int& dy, const auto& value) -> float
+	{
+		bool next = known(px + dx, py + dy);
+		bool previous = known(px - dx, py - dy);
+
+		if (next && previous) return (value(px + dx, py + dy) - value(px - dx, py - dy)) * 0.5f;
+		if (next) return value(px + dx, py + dy) - value(px, py);
+		if (previous) return value(px, py) - value(px - dx, py - dy);
+
+		return 0.0f;
+	};
+
+	auto arrival = [&](const int& px, const int& py) { return distance[py * width + px]; };
+
+	float gradient_tx = gradient(x, y, 1, 0, arrival);
+	float gradient_ty = gradient(x, y, 0, 1, arrival);
+
+	float sum[3] = { 0.0f, 0.0f, 0.0f };
+	float weight_sum = 0.0f;
+	const int shifts[3] = { 24, 16, 8 };
+
+	for (int qy = y - radius; qy <= y + radius; ++qy)
+	{
+		for (int qx = x - radius; qx <= x + radius; ++qx)
+		{
+			int rx = x - qx;
+			int ry = y - qy;
+			int length_squared = rx * rx + ry * ry;
+
+			if (length_squared == 0 || length_squared > radius * radius || !known(qx, qy))
+				continue;
+
+			/* Telea weights: direction along the front normal, geometric distance and level set distance */
+			float direction = std::fabs(rx * gradient_tx + ry * gradient_ty) / std::sqrt((float)length_squared);
+			float geometric = 1.0f / length_squared;
+			float level = 1.0f / (1.0f + std::fabs(distance[qy * width + qx] - distance[y * width + x]));
+
+			float weight = SDL_max(direction, 1e-6f) * geometric * level;
+
+			for (int c = 0; c < 3; ++c)
+			{
+				auto value = [&](const int& px, const int& py) { return channel(px, py, shifts[c]); };
+
+				float estimate = value(qx, qy) + gradient(qx, qy, 1, 0, value) * rx + gradient(qx, qy, 0, 1, value) * ry;
+				sum[c] += weight * estimate;
+			}
+
+			weight_sum += weight;
+		}
+	}
+
+	if (weight_sum <= 0.0f)
+		return;
+
+	Uint32& pixel = pixels[y * width + x];
+	Uint32 result = pixel & 0xFF;
+
+	for (int c = 0; c < 3; ++c)
+	{
+		Uint32 value = (Uint32)SDL_clamp(sum[c] / weight_sum + 0.5f, 0.0f, 255.0f);
+		result |= value << shifts[c];
+	}
+
+	pixel = result;
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#ifndef __INPAINT_H__
+#define __INPAINT_H__
+
+#include <vector>
+
+#include "SDL.h"
+
+#define INPAINT_RADIUS 5
+
+class Inpaint
+{
+public:
+	/* Region is the bounding box of the mask in canvas pixels, only that box plus a margin is read back and uploaded */
+	static void ApplyToCanvas(const std::vector<Uint8>& mask, const int& mask_width, const SDL_Rect& region, const int& radius);
+
+	/* Telea fast marching method. Pixels with mask != 0 are filled from the known pixels around them */
+	static void Telea(Uint32* pixels, const Uint8* mask, const int& width, const int& height, const int& radius);
+
+private:
+	static float Solve(const std::vector<float>& distance, const std::vector<Uint8>& flags, const int& a, const int& b);
+	static void InpaintPixel(Uint32* pixels, const std::vector<float>& distance, const std::vector<Uint8>& flags, const int& width, const int& height, const int& x, const int& y, const int& radius);
+};
+
+#endif /* __INPAINT_H__ */
\ No newline at end of file
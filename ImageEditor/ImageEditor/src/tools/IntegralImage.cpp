@@ -0,0 +1,83 @@
+#include "utils/Parallel.h"
+#include "IntegralImage.h"
+
+#define INTEGRAL_IMAGE_COLUMN_STRIP 64
+
+IntegralImage::IntegralImage() : stride(1), width(0), height(0)
+{
+}
+
+void IntegralImage::Build(const Uint8* plane, const int& width, const int& height)
+{
+	this->width = width;
+	this->height = height;
+	this->stride = width + 1;
+
+	this->sums.assign((size_t)this->stride * (height + 1), 0);
+	this->squares.assign((size_t)this->stride * (height + 1), 0);
+
+	/* Row prefix sums are independent, then the column pass sweeps strips of columns in parallel */
+	ParallelFor(0, height, 64, [&](const int& first, const int& last)
+	{
+		for (int row = first; row < last; ++row)
+		{
+			const Uint8* line = plane + (size_t)row * width;
+			Uint64* sum = this->sums.data() + (size_t)(row + 1) * this->stride;
+			Uint64* square = this->squares.data() + (size_t)(row + 1) * this->stride;
+
+			Uint64 running_sum = 0, running_square = 0;
+
+			for (int col = 0; col < width; ++col)
+			{
+				running_sum += line[col];
+				running_square += (Uint32)line[col] * line[col];
+
+				sum[col + 1] = running_sum;
+				square[col + 1] = running_square;
+			}
+		}
+	});
+
+	ParallelFor(1, this->stride, INTEGRAL_IMAGE_COLUMN_STRIP, [&](const int& first, const int& last)
+	{
+		for (int row = 2; row <= height; ++row)
+		{
+			Uint64* sum = this->sums.data() + (size_t)row * this->stride;
+			Uint64* square = this->squares.data() + (size_t)row * this->stride;
+
+			const Uint64* sum_above = sum - this->stride;
+			const Uint64* square_above = square - this->stride;
+
+			for (int col = first; col < last; ++col)
+			{
+				sum[col] += sum_above[col];
+				square[col] += square_above[col];
+			}
+		}
+	});
+}
+
+void IntegralImage::GetStatistics(const int& x0, const int& y0, const int& x1, const int& y1, float& mean, float& variance) const
+{
+	int left = SDL_max(x0, 0), right = SDL_min(x1, this->width);
+	int top = SDL_max(y0, 0), bottom = SDL_min(y1, this->height);
+
+	if (left >= right || top >= bottom)
+	{
+		mean = 0.0f;
+		variance = 0.0f;
+
+		return;
+	}
+
+	size_t a = (size_t)top * this->stride + left, b = (size_t)top * this->stride + right;
+	size_t c = (size_t)bottom * this->stride + left, d = (size_t)bottom * this->stride + right;
+
+	Uint64 count = (Uint64)(right - left) * (bottom - top);
+	Uint64 sum = this->sums[d] - this->sums[b] - this->sums[c] + this->sums[a];
+	Uint64 square = this->squares[d] - this->squares[b] - this->squares[c] + this->squares[a];
+
+	/* n * sum(x^2) - sum(x)^2 wraps in 64 bits but stays exact, the result itself fits for windows of up to 2^25 pixels */
+	mean = (float)((double)sum / count);
+	variance = (float)((double)(count * square - sum * sum) / ((double)count * count));
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef __INTEGRAL_IMAGE_H__
+#define __INTEGRAL_IMAGE_H__
+
+#include <vector>
+
+#include "SDL.h"
+
+/* Summed-area tables of values and squared values, any window mean and variance costs four lookups per table */
+class IntegralImage
+{
+public:
+	IntegralImage();
+
+	void Build(const Uint8* plane, const int& width, const int& height);
+
+	/* Window is [x0, x1) x [y0, y1), clipped to the image */
+	void GetStatistics(const int& x0, const int& y0, const int& x1, const int& y1, float& mean, float& variance) const;
+
+private:
+	std::vector<Uint64> sums;
+	std::vector<Uint64> squares;
+
+	/* Tables have a leading row and column of zeros */
+	int stride;
+	int width;
+	int height;
+};
+
+#endif /* __INTEGRAL_IMAGE_H__ */
\ No newline at end of file
@@ -0,0 +1,417 @@
+#include <algorithm>
+#include <emmintrin.h>
+
+#include "utils/Parallel.h"
+#include "LayerStack.h"
+
+/* x * y / 255 rounded, exact for 8-bit inputs held in 16-bit lanes */
+static inline __m128i Multiply255(const __m128i& x, const __m128i& y)
+{
+	__m128i t = _mm_add_epi16(_mm_mullo_epi16(x, y), _mm_set1_epi16(128));
+
+	return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+/* Lanes hold A, B, G, R of two pixels, the alpha of each pixel goes to its four lanes */
+static inline __m128i BroadcastAlpha(const __m128i& pixels)
+{
+	return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0));
+}
+
+static inline __m128i BlendPixels(__m128i source, const __m128i& destination, const BLEND_MODE& mode, const __m128i& opacity)
+{
+	const __m128i full = _mm_set1_epi16(255);
+	const __m128i alpha_lanes = _mm_set_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+
+	/* Premultiply and fade by the layer opacity, alpha itself is only faded */
+	__m128i factor = _mm_or_si128(_mm_andnot_si128(alpha_lanes, BroadcastAlpha(source)), _mm_and_si128(alpha_lanes, full));
+	source = Multiply255(Multiply255(source, factor), opacity);
+
+	__m128i source_alpha = BroadcastAlpha(source);
+	__m128i destination_alpha = BroadcastAlpha(destination);
+	__m128i source_remaining = _mm_sub_epi16(full, source_alpha);
+	__m128i destination_remaining = _mm_sub_epi16(full, destination_alpha);
+
+	/* The same formulas hold for the alpha lanes, which always come out as As + Ad - As * Ad, or saturate for add */
+	switch (mode)
+	{
+		case BLEND_MODE::MULTIPLY:
+		{
+			__m128i cross = _mm_add_epi16(Multiply255(source, destination_remaining), Multiply255(destination, source_remaining));
+
+			return _mm_add_epi16(Multiply255(source, destination), cross);
+		}
+		case BLEND_MODE::SCREEN:
+		{
+			return _mm_sub_epi16(_mm_add_epi16(source, destination), Multiply255(source, destination));
+		}
+		case BLEND_MODE::OVERLAY:
+		{
+			__m128i cross = _mm_add_epi16(Multiply255(source, destination_remaining), Multiply255(destination, source_remaining));
+			__m128i product = Multiply255(source, destination);
+
+			__m128i dark = _mm_add_epi16(product, product);
+			__m128i inverse = Multiply255(_mm_sub_epi16(destination_alpha, destination), _mm_sub_epi16(source_alpha, source));
+			__m128i light = _mm_subs_epu16(Multiply255(source_alpha, destination_alpha), _mm_add_epi16(inverse, inverse));
+
+			/* Screen where the backdrop is above half its alpha, multiply below */
+			__m128i upper = _mm_cmpgt_epi16(_mm_add_epi16(destination, destination), destination_alpha);
+
+			return _mm_add_epi16(cross, _mm_or_si128(_mm_and_si128(upper, light), _mm_andnot_si128(upper, dark)));
+		}
+		case BLEND_MODE::ADD:
+		{
+			return _mm_add_epi16(source, destination);
+		}
+		default:
+		{
+			return _mm_add_epi16(source, Multiply255(destination, source_remaining));
+		}
+	}
+}
+
+LayerStack::LayerStack()
+	: active(0), composite_all(true), next_layer_number(1), next_layer_id(0)
+{
+	/* The composite is rebuilt from the layers, undo never looks at it */
+	this->composite.SetHistoryEnabled(false);
+
+}
+
+LayerStack::~LayerStack()
+{
+
+}
+
+void LayerStack::Reset(const int& width, const int& height, const Uint32& background)
+{
+	this->Clear();
+
+	Layer layer;
+	layer.id = this->next_layer_id++;
+	layer.name = "Background";
+	layer.canvas.reset(new TiledCanvas());
+	layer.canvas->Resize(width, height, background);
+	layer.blend_mode = BLEND_MODE::NORMAL;
+	layer.opacity = 1.0f;
+	layer.visible = true;
+
+	this->layers.push_back(std::move(layer));
+	this->active = 0;
+	this->next_layer_number = 1;
+
+	this->composite.Resize(width, height, background);
+	this->composite_all = true;
+}
+
+void LayerStack::Resize(const int& width, const int& height)
+{
+	std::vector<Uint32> pixels;
+
+	for (Layer& layer : this->layers)
+	{
+		if (layer.canvas->GetWidth() == width && layer.canvas->GetHeight() == height)
+			continue;
+
+		SDL_Rect kept = { 0, 0, SDL_min(width, layer.canvas->GetWidth()), SDL_min(height, layer.canvas->GetHeight()) };
+		pixels.resize((size_t)kept.w * kept.h);
+
+		layer.canvas->ReadRegion(pixels.data(), kept.w, kept);
+		layer.canvas->Resize(width, height, layer.canvas->GetBackground());
+		layer.canvas->WriteRegion(pixels.data(), kept.w, kept);
+	}
+
+	if (this->composite.GetWidth() != width || this->composite.GetHeight() != height)
+	{
+		this->composite.Resize(width, height, this->composite.GetBackground());
+		this->composite_all = true;
+	}
+}
+
+void LayerStack::Clear()
+{
+	this->layers.clear();
+	this->composite.Clear();
+
+	this->active = 0;
+}
+
+void LayerStack::AddLayer()
+{
+	Layer layer;
+	layer.id = this->next_layer_id++;
+	layer.name = "Layer " + std::to_string(this->next_layer_number++);
+	layer.canvas.reset(new TiledCanvas());
+	layer.canvas->Resize(this->GetWidth(), this->GetHeight(), 0x00000000);
+	layer.blend_mode = BLEND_MODE::NORMAL;
+	layer.opacity = 1.0f;
+	layer.visible = true;
+
+	/* An empty transparent layer changes nothing, its tiles start clean */
+	std::vector<Uint8> unused(layer.canvas->GetTilesX() * layer.canvas->GetTilesY());
+	layer.canvas->CollectChangedTiles(unused);
+
+	this->active = SDL_min(this->active + 1, (int)this->layers.size());
+	this->layers.insert(this->layers.begin() + this->active, std::move(layer));
+}
+
+void LayerStack::RemoveLayer(const int& index)
+{
+	if (this->layers.size() <= 1 || index < 0 || index >= (int)this->layers.size())
+		return;
+
+	this->layers[index].canvas->ReleaseTextures();
+	this->layers.erase(this->layers.begin() + index);
+
+	this->active = SDL_clamp(this->active > index ? this->active - 1 : this->active, 0, (int)this->layers.size() - 1);
+	this->composite_all = true;
+}
+
+void LayerStack::MoveLayer(const int& index, const int& offset)
+{
+	int target = index + offset;
+
+	if (index < 0 || index >= (int)this->layers.size() || target < 0 || target >= (int)this->layers.size())
+		return;
+
+	std::swap(this->layers[index], this->layers[target]);
+
+	if (this->active == index)
+	{
+		this->active = target;
+	}
+	else if (this->active == target)
+	{
+		this->active = index;
+	}
+
+	this->composite_all = true;
+}
+
+void LayerStack::InvalidateComposite()
+{
+	this->composite_all = true;
+}
+
+void LayerStack::Composite()
+{
+	int tiles_x = this->composite.GetTilesX();
+	int tiles_y = this->composite.GetTilesY();
+
+	std::vector<Uint8> changed((size_t)tiles_x * tiles_y, this->composite_all ? 1 : 0);
+
+	for (Layer& layer : this->layers)
+	{
+		layer.canvas->CollectChangedTiles(changed);
+	}
+
+	/* Edits can change a layer background too, so it is refreshed every time. It does nothing when unchanged */
+	this->composite.SetBackground(this->CompositeBackground());
+	this->composite_all = false;
+
+	std::vector<int> dirty;
+
+	for (int i = 0; i < (int)changed.size(); ++i)
+	{
+		if (changed[i])
+		{
+			dirty.push_back(i);
+		}
+	}
+
+	if (dirty.empty())
+		return;
+
+	const size_t tile_pixels = CANVAS_TILE_SIZE * CANVAS_TILE_SIZE;
+	std::vector<Uint32> batch(tile_pixels * SDL_min((int)dirty.size(), LAYER_COMPOSITE_BATCH));
+
+	for (int first = 0; first < (int)dirty.size(); first += LAYER_COMPOSITE_BATCH)
+	{
+		int count = SDL_min((int)dirty.size() - first, LAYER_COMPOSITE_BATCH);
+
+		ParallelFor(0, count, 1, [&](const int& begin, const int& end)
+		{
+			for (int i = begin; i < end; ++i)
+			{
+				this->CompositeTile(dirty[first + i] % tiles_x, dirty[first + i] / tiles_x, batch.data() + tile_pixels * i);
+			}
+		});
+
+		/* Writing stores or releases the composite tile and reports it to the renderer */
+		for (int i = 0; i < count; ++i)
+		{
+			int tile_x = dirty[first + i] % tiles_x;
+			int tile_y = dirty[first + i] / tiles_x;
+
+			SDL_Rect rect = {
+				tile_x * CANVAS_TILE_SIZE,
+				tile_y * CANVAS_TILE_SIZE,
+				SDL_min(CANVAS_TILE_SIZE, this->GetWidth() - tile_x * CANVAS_TILE_SIZE),
+				SDL_min(CANVAS_TILE_SIZE, this->GetHeight() - tile_y * CANVAS_TILE_SIZE)
+			};
+
+			this->composite.WriteRegion(batch.data() + tile_pixels * i, CANVAS_TILE_SIZE, rect);
+		}
+	}
+}
+
+void LayerStack::ReleaseTextures()
+{
+	for (Layer& layer : this->layers)
+	{
+		layer.canvas->ReleaseTextures();
+	}
+
+	this->composite.ReleaseTextures();
+}
+
+TiledCanvas* LayerStack::FindLayer(const int& id)
+{
+	for (Layer& layer : this->layers)
+	{
+		if (layer.id == id)
+			return layer.canvas.get();
+	}
+
+	return nullptr;
+}
+
+TiledCanvas& LayerStack::GetActive()
+{
+	return *this->layers[this->active].canvas;
+}
+
+const TiledCanvas& LayerStack::GetActive() const
+{
+	return *this->layers[this->active].canvas;
+}
+
+TiledCanvas& LayerStack::GetComposite()
+{
+	return this->composite;
+}
+
+const TiledCanvas& LayerStack::GetComposite() const
+{
+	return this->composite;
+}
+
+int LayerStack::GetWidth() const
+{
+	return this->composite.GetWidth();
+}
+
+int LayerStack::GetHeight() const
+{
+	return this->composite.GetHeight();
+}
+
+void LayerStack::CompositeTile(const int& tile_x, const int& tile_y, Uint32* pixels) const
+{
+	std::vector<Uint32> background_row(CANVAS_TILE_SIZE);
+
+	std::fill(pixels, pixels + CANVAS_TILE_SIZE * CANVAS_TILE_SIZE, 0);
+
+	for (const Layer& layer : this->layers)
+	{
+		Uint8 opacity = (Uint8)(SDL_clamp(layer.opacity, 0.0f, 1.0f) * 255.0f + 0.5f);
+
+		if (!layer.visible || opacity == 0)
+			continue;
+
+		const Uint32* tile = layer.canvas->GetTile(tile_x, tile_y);
+
+		/* Tiles that are not stored are a flat background, a transparent one adds nothing */
+		if (tile == nullptr)
+		{
+			if ((layer.canvas->GetBackground() & 0xFF) == 0)
+				continue;
+
+			std::fill(background_row.begin(), background_row.end(), layer.canvas->GetBackground());
+		}
+
+		for (int row = 0; row < CANVAS_TILE_SIZE; ++row)
+		{
+			const Uint32* source = tile ? tile + (size_t)row * CANVAS_TILE_SIZE : background_row.data();
+
+			LayerStack::BlendRow(pixels + (size_t)row * CANVAS_TILE_SIZE, source, CANVAS_TILE_SIZE, layer.blend_mode, opacity);
+		}
+	}
+
+	for (int row = 0; row < CANVAS_TILE_SIZE; ++row)
+	{
+		LayerStack::UnpremultiplyRow(pixels + (size_t)row * CANVAS_TILE_SIZE, CANVAS_TILE_SIZE);
+	}
+}
+
+Uint32 LayerStack::CompositeBackground() const
+{
+	Uint32 pixel = 0;
+
+	for (const Layer& layer : this->layers)
+	{
+		Uint8 opacity = (Uint8)(SDL_clamp(layer.opacity, 0.0f, 1.0f) * 255.0f + 0.5f);
+
+		if (!layer.visible)
+			continue;
+
+		Uint32 background = layer.canvas->GetBackground();
+		LayerStack::BlendRow(&pixel, &background, 1, layer.blend_mode, opacity);
+	}
+
+	LayerStack::UnpremultiplyRow(&pixel, 1);
+
+	return pixel;
+}
+
+void LayerStack::BlendRow(Uint32* destination, const Uint32* source, const int& count, const BLEND_MODE& mode, const Uint8& opacity)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i opacity_lanes = _mm_set1_epi16(opacity);
+
+	int x = 0;
+
+	for (; x + 4 <= count; x += 4)
+	{
+		__m128i s = _mm_loadu_si128((const __m128i*)(source + x));
+		__m128i d = _mm_loadu_si128((const __m128i*)(destination + x));
+
+		__m128i low = BlendPixels(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), mode, opacity_lanes);
+		__m128i high = BlendPixels(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), mode, opacity_lanes);
+
+		_mm_storeu_si128((__m128i*)(destination + x), _mm_packus_epi16(low, high));
+	}
+
+	for (; x < count; ++x)
+	{
+		__m128i s = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)source[x]), zero);
+		__m128i d = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)destination[x]), zero);
+
+		__m128i result = BlendPixels(s, d, mode, opacity_lanes);
+
+		destination[x] = (Uint32)_mm_cvtsi128_si32(_mm_packus_epi16(result, result));
+	}
+}
+
+void LayerStack::UnpremultiplyRow(Uint32* pixels, const int& count)
+{
+	for (int x = 0; x < count; ++x)
+	{
+		Uint32 alpha = pixels[x] & 0xFF;
+
+		if (alpha == 255)
+			continue;
+
+		if (alpha == 0)
+		{
+			pixels[x] = 0;
+			continue;
+		}
+
+		Uint32 r = SDL_min(((pixels[x] >> 24) * 255 + alpha / 2) / alpha, 255u);
+		Uint32 g = SDL_min((((pixels[x] >> 16) & 0xFF) * 255 + alpha / 2) / alpha, 255u);
+		Uint32 b = SDL_min((((pixels[x] >> 8) & 0xFF) * 255 + alpha / 2) / alpha, 255u);
+
+		pixels[x] = (r << 24) | (g << 16) | (b << 8) | alpha;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#ifndef __LAYER_STACK_H__
+#define __LAYER_STACK_H__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SDL.h"
+
+#include "TiledCanvas.h"
+
+/* Tiles recomposed per parallel batch, bounds the scratch memory of a full recomposition */
+#define LAYER_COMPOSITE_BATCH 64
+
+enum class BLEND_MODE
+{
+	NORMAL = 0,
+	MULTIPLY,
+	SCREEN,
+	OVERLAY,
+	ADD
+};
+
+struct Layer
+{
+	/* Stays the same while the layer moves in the stack, the history refers to layers by it */
+	int id;
+	std::string name;
+	std::unique_ptr<TiledCanvas> canvas;
+
+	BLEND_MODE blend_mode;
+	float opacity;
+	bool visible;
+};
+
+/* Layers hold straight RGBA tiles and are blended bottom to top in premultiplied space. The composite is another tiled canvas whose tiles act as the cache */
+class LayerStack
+{
+public:
+	LayerStack();
+	~LayerStack();
+
+	/* Starts over with a single layer filled with background */
+	void Reset(const int& width, const int& height, const Uint32& background);
+	/* Every layer keeps the part that still fits */
+	void Resize(const int& width, const int& height);
+	void Clear();
+
+	/* New layers are transparent, go above the active one and become active */
+	void AddLayer();
+	void RemoveLayer(const int& index);
+	void MoveLayer(const int& index, const int& offset);
+
+	/* Must be called after changing the blend mode, opacity or visibility of a layer */
+	void InvalidateComposite();
+	/* Recomposes only the tiles that changed in any layer since the last call */
+	void Composite();
+
+	void ReleaseTextures();
+
+	/* Null when the layer was removed */
+	TiledCanvas* FindLayer(const int& id);
+
+	TiledCanvas& GetActive();
+	const TiledCanvas& GetActive() const;
+	TiledCanvas& GetComposite();
+	const TiledCanvas& GetComposite() const;
+
+	int GetWidth() const;
+	int GetHeight() const;
+
+public:
+	/* Bottom layer first */
+	std::vector<Layer> layers;
+	int active;
+
+private:
+	void CompositeTile(const int& tile_x, const int& tile_y, Uint32* pixels) const;
+	Uint32 CompositeBackground() const;
+
+	/* Blends a straight source row into a premultiplied destination row */
+	static void BlendRow(Uint32* destination, const Uint32* source, const int& count, const BLEND_MODE& mode, const Uint8& opacity);
+	static void UnpremultiplyRow(Uint32* pixels, const int& count);
+
+private:
+	TiledCanvas composite;
+	bool composite_all;
+
+	int next_layer_number;
+	int next_layer_id;
+};
+
+#endif /* __LAYER_STACK_H__ */
\ No newline at end of file
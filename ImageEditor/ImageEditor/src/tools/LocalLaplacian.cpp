@@ -0,0 +1,416 @@
+#include <cmath>
+
+#include "utils/Parallel.h"
+#include "ColorSpace.h"
+#include "LocalLaplacian.h"
+
+#define LOCAL_LAPLACIAN_MAX_LEVELS 10
+#define LOCAL_LAPLACIAN_MIN_SIZE 8
+
+void LocalLaplacian::Apply(const Uint32* src, const ptrdiff_t& src_stride, Uint32* dst, const ptrdiff_t& dst_stride, const int& width, const int& height, const LocalLaplacianParams& params)
+{
+	if (width <= 0 || height <= 0)
+		return;
+
+	std::vector<float> r, g, b;
+
+	LocalLaplacian::Decode(src, src_stride, width, height, r, g, b);
+	LocalLaplacian::FilterPlanes(r.data(), g.data(), b.data(), width, height, params);
+	LocalLaplacian::Encode(src, src_stride, dst, dst_stride, width, height, r, g, b);
+}
+
+void LocalLaplacian::ApplyProxy(const Uint32* src, const ptrdiff_t& src_stride, Uint32* dst, const ptrdiff_t& dst_stride, const int& width, const int& height, const LocalLaplacianParams& params, const int& max_pixels)
+{
+	int factor = 1;
+	while ((size_t)((width + factor - 1) / factor) * ((height + factor - 1) / factor) > (size_t)max_pixels)
+	{
+		factor *= 2;
+	}
+
+	if (factor == 1)
+	{
+		LocalLaplacian::Apply(src, src_stride, dst, dst_stride, width, height, params);
+		return;
+	}
+
+	std::vector<float> r, g, b;
+	LocalLaplacian::Decode(src, src_stride, width, height, r, g, b);
+
+	int proxy_width = (width + factor - 1) / factor;
+	int proxy_height = (height + factor - 1) / factor;
+	size_t proxy_size = (size_t)proxy_width * proxy_height;
+
+	float* planes[3] = { r.data(), g.data(), b.data() };
+	std::vector<float> proxy[3], original[3];
+
+	for (int c = 0; c < 3; ++c)
+	{
+		proxy[c].assign(proxy_size, 0.0f);
+	}
+
+	ParallelFor(0, proxy_height, 8, [&](const int& first, const int& last)
+	{
+		for (int py = first; py < last; ++py)
+		{
+			int y0 = py * factor, y1 = SDL_min(y0 + factor, height);
+
+			for (int px = 0; px < proxy_width; ++px)
+			{
+				int x0 = px * factor, x1 = SDL_min(x0 + factor, width);
+				float weight = 1.0f / ((y1 - y0) * (x1 - x0));
+
+				for (int c = 0; c < 3; ++c)
+				{
+					float sum = 0.0f;
+
+					for (int y = y0; y < y1; ++y)
+					{
+						const float* line = planes[c] + (size_t)y * width;
+
+						for (int x = x0; x < x1; ++x)
+						{
+							sum += line[x];
+						}
+					}
+
+					proxy[c][(size_t)py * proxy_width + px] = sum * weight;
+				}
+			}
+		}
+	});
+
+	for (int c = 0; c < 3; ++c)
+	{
+		original[c] = proxy[c];
+	}
+
+	LocalLaplacian::FilterPlanes(proxy[0].data(), proxy[1].data(), proxy[2].data(), proxy_width, proxy_height, params);
+
+	/* Only the change is upsampled, so the full resolution detail of the source stays intact */
+	ParallelFor(0, height, 16, [&](const int& first, const int& last)
+	{
+		for (int y = first; y < last; ++y)
+		{
+			float fy = SDL_clamp((y + 0.5f) / factor - 0.5f, 0.0f, (float)(proxy_height - 1));
+			int y0 = (int)fy, y1 = SDL_min(y0 + 1, proxy_height - 1);
+			float wy = fy - y0;
+
+			for (int x = 0; x < width; ++x)
+			{
+				float fx = SDL_clamp((x + 0.5f) / factor - 0.5f, 0.0f, (float)(proxy_width - 1));
+				int x0 = (int)fx, x1 = SDL_min(x0 + 1, proxy_width - 1);
+				float wx = fx - x0;
+
+				size_t i00 = (size_t)y0 * proxy_width + x0, i01 = (size_t)y0 * proxy_width + x1;
+				size_t i10 = (size_t)y1 * proxy_width + x0, i11 = (size_t)y1 * proxy_width + x1;
+
+				for (int c = 0; c < 3; ++c)
+				{
+					const float* p = proxy[c].data();
+					const float* o = original[c].data();
+
+					float top = (p[i00] - o[i00]) * (1.0f - wx) + (p[i01] - o[i01]) * wx;
+					float bottom = (p[i10] - o[i10]) * (1.0f - wx) + (p[i11] - o[i11]) * wx;
+
+					planes[c][(size_t)y * width + x] += top * (1.0f - wy) + bottom * wy;
+				}
+			}
+		}
+	});
+
+	LocalLaplacian::Encode(src, src_stride, dst, dst_stride, width, height, r, g, b);
+}
+
+LocalLaplacianParams LocalLaplacian::DefaultParams()
+{
+	return { 0.0f, 0.0f, 0.1f };
+}
+
+void LocalLaplacian::FilterPlanes(float* r, float* g, float* b, const int& width, const int& height, const LocalLaplacianParams& params)
+{
+	size_t size = (size_t)width * height;
+
+	std::vector<float> luma(size), result(size);
+
+	ParallelFor(0, height, 32, [&](const int& first, const int& last)
+	{
+		for (size_t i = (size_t)first * width; i < (size_t)last * width; ++i)
+		{
+			luma[i] = 0.299f * r[i] + 0.587f * g[i] + 0.114f * b[i];
+		}
+	});
+
+	LocalLaplacian::FilterLuma(luma.data(), result.data(), width, height, params);
+
+	ParallelFor(0, height, 32, [&](const int& first, const int& last)
+	{
+		for (size_t i = (size_t)first * width; i < (size_t)last * width; ++i)
+		{
+			float delta = result[i] - luma[i];
+
+			r[i] += delta;
+			g[i] += delta;
+			b[i] += delta;
+		}
+	});
+}
+
+void LocalLaplacian::FilterLuma(const float* luma, float* result, const int& width, const int& height, const LocalLaplacianParams& params)
+{
+	float amount = params.DETAIL > 0.0f ? params.DETAIL / 50.0f : params.DETAIL / 100.0f;
+	float beta = SDL_max(1.0f + params.TONE / 100.0f, 0.0f);
+	float edge = SDL_max(params.EDGE, 0.01f);
+
+	/* Gaussian pyramid of the input, its coefficients pick the remapping levels to interpolate */
+	Pyramid gaussian(1);
+	gaussian[0].data.assign(luma, luma + (size_t)width * height);
+	gaussian[0].width = width;
+	gaussian[0].height = height;
+
+	LocalLaplacian::BuildGaussianPyramid(gaussian);
+
+	int levels = (int)gaussian.size();
+
+	Pyramid output(levels);
+	for (int l = 0; l < levels; ++l)
+	{
+		output[l].width = gaussian[l].width;
+		output[l].height = gaussian[l].height;
+		output[l].data.assign(gaussian[l].data.size(), 0.0f);
+	}
+
+	output[levels - 1].data = gaussian[levels - 1].data;
+
+	Pyramid remapped(1);
+	remapped[0].width = width;
+	remapped[0].height = height;
+	remapped[0].data.resize((size_t)width * height);
+
+	std::vector<float> expanded;
+
+	for (int j = 0; j < LOCAL_LAPLACIAN_SAMPLES; ++j)
+	{
+		float reference = (float)j / (LOCAL_LAPLACIAN_SAMPLES - 1);
+
+		ParallelFor(0, height, 32, [&](const int& first, const int& last)
+		{
+			for (size_t i = (size_t)first * width; i < (size_t)last * width; ++i)
+			{
+				remapped[0].data[i] = LocalLaplacian::Remap(luma[i], reference, edge, amount, beta);
+			}
+		});
+
+		remapped.resize(1);
+		LocalLaplacian::BuildGaussianPyramid(remapped);
+
+		/* Each Laplacian coefficient of the remapped image contributes with a hat weight around its sampled level */
+		for (int l = 0; l < levels - 1; ++l)
+		{
+			const Level& current = remapped[l];
+			LocalLaplacian::Expand(remapped[l + 1], expanded, current.width, current.height);
+
+			const float* g = gaussian[l].data.data();
+			float* out = output[l].data.data();
+
+			ParallelFor(0, current.height, 32, [&](const int& first, const int& last)
+			{
+				for (size_t i = (size_t)first * current.width; i < (size_t)last * current.width; ++i)
+				{
+					float weight = 1.0f - std::fabs(SDL_clamp(g[i], 0.0f, 1.0f) * (LOCAL_LAPLACIAN_SAMPLES - 1) - j);
+
+					if (weight > 0.0f)
+					{
+						out[i] += weight * (current.data[i] - expanded[i]);
+					}
+				}
+			});
+		}
+	}
+
+	/* Collapse from the coarsest level */
+	for (int l = levels - 2; l >= 0; --l)
+	{
+		LocalLaplacian::Expand(output[l + 1], expanded, output[l].width, output[l].height);
+
+		float* out = output[l].data.data();
+
+		ParallelFor(0, output[l].height, 32, [&](const int& first, const int& last)
+		{
+			for (size_t i = (size_t)first * output[l].width; i < (size_t)last * output[l].width; ++i)
+			{
+				out[i] += expanded[i];
+			}
+		});
+	}
+
+	std::copy(output[0].data.begin(), output[0].data.end(), result);
+}
+
+void LocalLaplacian::BuildGaussianPyramid(Pyramid& pyramid)
+{
+	while ((int)pyramid.size() < LOCAL_LAPLACIAN_MAX_LEVELS
+		&& SDL_min(pyramid.back().width, pyramid.back().height) >= 2 * LOCAL_LAPLACIAN_MIN_SIZE)
+	{
+		Level next;
+		LocalLaplacian::Reduce(pyramid.back(), next);
+
+		pyramid.push_back(std::move(next));
+	}
+}
+
+void LocalLaplacian::Reduce(const Level& src, Level& dst)
+{
+	static const float kernel[5] = { 1.0f / 16.0f, 4.0f / 16.0f, 6.0f / 16.0f, 4.0f / 16.0f, 1.0f / 16.0f };
+
+	dst.width = (src.width + 1) / 2;
+	dst.height = (src.height + 1) / 2;
+	dst.data.resize((size_t)dst.width * dst.height);
+
+	std::vector<float> rows((size_t)dst.width * src.height);
+
+	ParallelFor(0, src.height, 32, [&](const int& first, const int& last)
+	{
+		for (int y = first; y < last; ++y)
+		{
+			const float* line = src.data.data() + (size_t)y * src.width;
+			float* out = rows.data() + (size_t)y * dst.width;
+
+			for (int x = 0; x < dst.width; ++x)
+			{
+				float sum = 0.0f;
+
+				for (int k = -2; k <= 2; ++k)
+				{
+					sum += kernel[k + 2] * line[SDL_clamp(2 * x + k, 0, src.width - 1)];
+				}
+
+				out[x] = sum;
+			}
+		}
+	});
+
+	ParallelFor(0, dst.height, 16, [&](const int& first, const int& last)
+	{
+		for (int y = first; y < last; ++y)
+		{
+			float* out = dst.data.data() + (size_t)y * dst.width;
+
+			for (int x = 0; x < dst.width; ++x)
+			{
+				out[x] = 0.0f;
+			}
+
+			for (int k = -2; k <= 2; ++k)
+			{
+				const float* line = rows.data() + (size_t)SDL_clamp(2 * y + k, 0, src.height - 1) * dst.width;
+
+				for (int x = 0; x < dst.width; ++x)
+				{
+					out[x] += kernel[k + 2] * line[x];
+				}
+			}
+		}
+	});
+}
+
+void LocalLaplacian::Expand(const Level& src, std::vector<float>& dst, const int& width, const int& height)
+{
+	/* Even samples sit on a source sample (1 6 1) / 8, odd ones between two (4 4) / 8 */
+	std::vector<float> rows((size_t)width * src.height);
+
+	ParallelFor(0, src.height, 32, [&](const int& first, const int& last)
+	{
+		for (int y = first; y < last; ++y)
+		{
+			const float* line = src.data.data() + (size_t)y * src.width;
+			float* out = rows.data() + (size_t)y * width;
+
+			for (int x = 0; x < width; ++x)
+			{
+				int q = x >> 1;
+
+				if (x & 1)
+					out[x] = 0.5f * (line[SDL_min(q, src.width - 1)] + line[SDL_min(q + 1, src.width - 1)]);
+				else
+					out[x] = 0.125f * line[SDL_max(q - 1, 0)] + 0.75f * line[SDL_min(q, src.width - 1)] + 0.125f * line[SDL_min(q + 1, src.width - 1)];
+			}
+		}
+	});
+
+	dst.resize((size_t)width * height);
+
+	ParallelFor(0, height, 16, [&](const int& first, const int& last)
+	{
+		for (int y = first; y < last; ++y)
+		{
+			int q = y >> 1;
+			float* out = dst.data() + (size_t)y * width;
+
+			const float* above = rows.data() + (size_t)SDL_max(q - 1, 0) * width;
+			const float* center = rows.data() + (size_t)SDL_min(q, src.height - 1) * width;
+			const float* below = rows.data() + (size_t)SDL_min(q + 1, src.height - 1) * width;
+
+			if (y & 1)
+			{
+				for (int x = 0; x < width; ++x)
+				{
+					out[x] = 0.5f * (center[x] + below[x]);
+				}
+			}
+			else
+			{
+				for (int x = 0; x < width; ++x)
+				{
+					out[x] = 0.125f * above[x] + 0.75f * center[x] + 0.125f * below[x];
+				}
+			}
+		}
+	});
+}
+
+float LocalLaplacian::Remap(const float& value, const float& reference, const float& edge, const float& amount, const float& beta)
+{
+	/* Smooth remapping: the slope is 1 + amount on small differences and decays to beta past the edge scale */
+	float difference = value - reference;
+	float x = difference / edge;
+
+	return reference + beta * difference + (1.0f - beta + amount) * difference * std::exp(-0.5f * x * x);
+}
+
+void LocalLaplacian::Decode(const Uint32* src, const ptrdiff_t& src_stride, const int& width, const int& height, std::vector<float>& r, std::vector<float>& g, std::vector<float>& b)
+{
+	size_t size = (size_t)width * height;
+
+	r.resize(size);
+	g.resize(size);
+	b.resize(size);
+
+	ParallelFor(0, height, 16, [&](const int& first, const int& last)
+	{
+		for (int row = first; row < last; ++row)
+		{
+			size_t offset = (size_t)row * width;
+			ColorSpace::DecodeRow(src + row * src_stride, width, r.data() + offset, g.data() + offset, b.data() + offset, false);
+		}
+	});
+}
+
+void LocalLaplacian::Encode(const Uint32* src, const ptrdiff_t& src_stride, Uint32* dst, const ptrdiff_t& dst_stride, const int& width, const int& height, const std::vector<float>& r, const std::vector<float>& g, const std::vector<float>& b)
+{
+	ParallelFor(0, height, 16, [&](const int& first, const int& last)
+	{
+		for (int row = first; row < last; ++row)
+		{
+			const Uint32* src_row = src + row * src_stride;
+			Uint32* dst_row = dst + row * dst_stride;
+			size_t offset = (size_t)row * width;
+
+			ColorSpace::EncodeRow(r.data() + offset, g.data() + offset, b.data() + offset, dst_row, width, false);
+
+			for (int col = 0; col < width; ++col)
+			{
+				dst_row[col] = (dst_row[col] & 0xFFFFFF00) | (src_row[col] & 0xFF);
+			}
+		}
+	});
+}
\ No newline at end of file
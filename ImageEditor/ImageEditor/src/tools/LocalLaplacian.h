@@ -0,0 +1,55 @@
+#ifndef __LOCAL_LAPLACIAN_H__
+#define __LOCAL_LAPLACIAN_H__
+
+#include <cstddef>
+#include <vector>
+
+#include "SDL.h"
+
+/* Sampled remapping levels of the fast approximation */
+#define LOCAL_LAPLACIAN_SAMPLES 8
+#define LOCAL_LAPLACIAN_PROXY_PIXELS (1 << 20)
+
+struct LocalLaplacianParams
+{
+	float DETAIL;
+	float TONE;
+	float EDGE;
+};
+
+class LocalLaplacian
+{
+public:
+	/* Detail and tone are percentages in [-100, 100], edge is the luma difference in [0, 1] above which detail is left alone */
+	static void Apply(const Uint32* src, const ptrdiff_t& src_stride, Uint32* dst, const ptrdiff_t& dst_stride, const int& width, const int& height, const LocalLaplacianParams& params);
+
+	/* Filters a box-downsampled proxy when the image is larger than max_pixels and adds the upsampled difference to the full resolution source */
+	static void ApplyProxy(const Uint32* src, const ptrdiff_t& src_stride, Uint32* dst, const ptrdiff_t& dst_stride, const int& width, const int& height, const LocalLaplacianParams& params, const int& max_pixels);
+
+	static LocalLaplacianParams DefaultParams();
+
+private:
+	struct Level
+	{
+		std::vector<float> data;
+		int width;
+		int height;
+	};
+
+	typedef std::vector<Level> Pyramid;
+
+	/* Filters the luma of the planes and shifts R, G and B by the same amount */
+	static void FilterPlanes(float* r, float* g, float* b, const int& width, const int& height, const LocalLaplacianParams& params);
+	static void FilterLuma(const float* luma, float* result, const int& width, const int& height, const LocalLaplacianParams& params);
+
+	static void BuildGaussianPyramid(Pyramid& pyramid);
+	static void Reduce(const Level& src, Level& dst);
+	static void Expand(const Level& src, std::vector<float>& dst, const int& width, const int& height);
+
+	static float Remap(const float& value, const float& reference, const float& edge, const float& amount, const float& beta);
+
+	static void Decode(const Uint32* src, const ptrdiff_t& src_stride, const int& width, const int& height, std::vector<float>& r, std::vector<float>& g, std::vector<float>& b);
+	static void Encode(const Uint32* src, const ptrdiff_t& src_stride, Uint32* dst, const ptrdiff_t& dst_stride, const int& width, const int& height, const std::vector<float>& r, const std::vector<float>& g, const std::vector<float>& b);
+};
+
+#endif /* __LOCAL_LAPLACIAN_H__ */
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include <cmath>
+#include <cstdlib>
+
+#include "PrimitiveBatcher.h"
+
+PrimitiveBatcher::PrimitiveBatcher()
+{
+
+}
+
+PrimitiveBatcher::~PrimitiveBatcher()
+{
+
+}
+
+void PrimitiveBatcher::AddLine(const int& x1, const int& y1, const int& x2, const int& y2, const int& size, const SDL_Color& color)
+{
+	this->Append(this->GetMesh(PRIMITIVE_TYPE::LINE, x2 - x1, y2 - y1, SDL_max(size, 1)), (float)x1, (float)y1, color);
+}
+
+void PrimitiveBatcher::AddRectangle(const int& x, const int& y, const int& width, const int& height, const SDL_Color& color)
+{
+	this->Append(this->GetMesh(PRIMITIVE_TYPE::RECTANGLE, width, height, 0), (float)x, (float)y, color);
+}
+
+void PrimitiveBatcher::AddRectangleFill(const int& x, const int& y, const int& width, const int& height, const SDL_Color& color)
+{
+	this->Append(this->GetMesh(PRIMITIVE_TYPE::RECTANGLE_FILL, width, height, 0), (float)x, (float)y, color);
+}
+
+void PrimitiveBatcher::AddEllipse(const int& x, const int& y, const int& radius_x, const int& radius_y, const SDL_Color& color)
+{
+	this->Append(this->GetMesh(PRIMITIVE_TYPE::ELLIPSE, std::abs(radius_x), std::abs(radius_y), 0), (float)x, (float)y, color);
+}
+
+void PrimitiveBatcher::AddEllipseFill(const int& x, const int& y, const int& radius_x, const int& radius_y, const SDL_Color& color)
+{
+	this->Append(this->GetMesh(PRIMITIVE_TYPE::ELLIPSE_FILL, std::abs(radius_x), std::abs(radius_y), 0), (float)x, (float)y, color);
+}
+
+void PrimitiveBatcher::Flush(SDL_Renderer* renderer)
+{
+	if (this->vertices.empty())
+		return;
+
+	SDL_BlendMode blend_mode;
+	SDL_GetRenderDrawBlendMode(renderer, &blend_mode);
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+
+	SDL_RenderGeometry(renderer, nullptr, this->vertices.data(), (int)this->vertices.size(), this->indices.data(), (int)this->indices.size());
+
+	SDL_SetRenderDrawBlendMode(renderer, blend_mode);
+
+	this->vertices.clear();
+	this->indices.clear();
+}
+
+const PrimitiveBatcher::Mesh& PrimitiveBatcher::GetMesh(const PRIMITIVE_TYPE& type, const int& a, const int& b, const int& c)
+{
+	/* Sizes are packed in 20 bits each, enough for any canvas dimension */
+	Uint64 key = ((Uint64)type << 60) | ((Uint64)(a & 0xFFFFF) << 40) | ((Uint64)(b & 0xFFFFF) << 20) | (Uint64)(c & 0xFFFFF);
+
+	auto cached = this->cache.find(key);
+	if (cached != this->cache.end())
+		return cached->second;
+
+	if (this->cache.size() >= PRIMITIVE_CACHE_SIZE)
+	{
+		this->cache.clear();
+	}
+
+	Mesh& mesh = this->cache[key];
+
+	switch (type)
+	{
+		case PRIMITIVE_TYPE::LINE:
+		{
+			/* Quad between the pixel centers, half the size to each side */
+			float length = std::sqrt((float)(a * a + b * b));
+			float half = c * 0.5f;
+
+			float nx = length > 0.0f ? -b / length * half : 0.0f;
+			float ny = length > 0.0f ? a / length * half : half;
+			float tx = length > 0.0f ? 0.0f : half;
+
+			SDL_FPoint start = { 0.5f - tx, 0.5f };
+			SDL_FPoint end = { a + 0.5f + tx, b + 0.5f };
+
+			PrimitiveBatcher::AddQuad(
+				mesh,
+				{ start.x + nx, start.y + ny },
+				{ end.x + nx, end.y + ny },
+				{ end.x - nx, end.y - ny },
+				{ start.x - nx, start.y - ny }
+			);
+
+			break;
+		}
+		case PRIMITIVE_TYPE::RECTANGLE:
+		case PRIMITIVE_TYPE::RECTANGLE_FILL:
+		{
+			float x0 = (float)SDL_min(a, 0);
+			float y0 = (float)SDL_min(b, 0);
+			float x1 = (float)SDL_max(a, 0) + 1.0f;
+			float y1 = (float)SDL_max(b, 0) + 1.0f;
+
+			if (type == PRIMITIVE_TYPE::RECTANGLE_FILL || x1 - x0 <= 2.0f || y1 - y0 <= 2.0f)
+			{
+				PrimitiveBatcher::AddQuad(mesh, { x0, y0 }, { x1, y0 }, { x1, y1 }, { x0, y1 });
+			}
+			else
+			{
+				/* One pixel wide bars, the sides stop short of the top and bottom ones */
+				PrimitiveBatcher::AddQuad(mesh, { x0, y0 }, { x1, y0 }, { x1, y0 + 1.0f }, { x0, y0 + 1.0f });
+				PrimitiveBatcher::AddQuad(mesh, { x0, y1 - 1.0f }, { x1, y1 - 1.0f }, { x1, y1 }, { x0, y1 });
+				PrimitiveBatcher::AddQuad(mesh, { x0, y0 + 1.0f }, { x0 + 1.0f, y0 + 1.0f }, { x0 + 1.0f, y1 - 1.0f }, { x0, y1 - 1.0f });
+				PrimitiveBatcher::AddQuad(mesh, { x1 - 1.0f, y0 + 1.0f }, { x1, y0 + 1.0f }, { x1, y1 - 1.0f }, { x1 - 1.0f, y1 - 1.0f });
+			}
+
+			break;
+		}
+		case PRIMITIVE_TYPE::ELLIPSE:
+		case PRIMITIVE_TYPE::ELLIPSE_FILL:
+		{
+			int segments = PrimitiveBatcher::GetEllipseSegments(a, b);
+			float factor = 2.0f * (float)M_PI / segments;
+
+			if (type == PRIMITIVE_TYPE::ELLIPSE_FILL)
+			{
+				/* Fan around the center pixel */
+				mesh.positions.push_back({ 0.5f, 0.5f });
+
+				for (int i = 0; i < segments; ++i)
+				{
+					mesh.positions.push_back({ 0.5f + (a + 0.5f) * std::cos(i * factor), 0.5f + (b + 0.5f) * std::sin(i * factor) });
+
+					mesh.indices.push_back(0);
+					mesh.indices.push_back(1 + i);
+					mesh.indices.push_back(1 + (i + 1) % segments);
+				}
+			}
+			else
+			{
+				/* One pixel wide ring, outer and inner vertices alternate */
+				for (int i = 0; i < segments; ++i)
+				{
+					float c = std::cos(i * factor);
+					float s = std::sin(i * factor);
+
+					mesh.positions.push_back({ 0.5f + (a + 0.5f) * c, 0.5f + (b + 0.5f) * s });
+					mesh.positions.push_back({ 0.5f + SDL_max(a - 0.5f, 0.0f) * c, 0.5f + SDL_max(b - 0.5f, 0.0f) * s });
+
+					int outer = 2 * i;
+					int next = 2 * ((i + 1) % segments);
+
+					mesh.indices.insert(mesh.indices.end(), { outer, next, outer + 1, outer + 1, next, next + 1 });
+				}
+			}
+
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
+
+	return mesh;
+}
+
+void PrimitiveBatcher::Append(const Mesh& mesh, const float& x, const float& y, const SDL_Color& color)
+{
+	int base = (int)this->vertices.size();
+
+	for (const SDL_FPoint& position : mesh.positions)
+	{
+		this->vertices.push_back({ { position.x + x, position.y + y }, color, { 0.0f, 0.0f } });
+	}
+
+	for (const int& index : mesh.indices)
+	{
+		this->indices.push_back(base + index);
+	}
+}
+
+void PrimitiveBatcher::AddQuad(Mesh& mesh, const SDL_FPoint& p0, const SDL_FPoint& p1, const SDL_FPoint& p2, const SDL_FPoint& p3)
+{
+	int base = (int)mesh.positions.size();
+
+	mesh.positions.insert(mesh.positions.end(), { p0, p1, p2, p3 });
+	mesh.indices.insert(mesh.indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+}
+
+int PrimitiveBatcher::GetEllipseSegments(const int& radius_x, const int& radius_y)
+{
+	/* Chords stay within a quarter of a pixel of the curve */
+	float radius = SDL_max(radius_x, radius_y) + 0.5f;
+	int segments = (int)std::ceil((float)M_PI / std::acos(SDL_max(1.0f - 0.25f / radius, -1.0f)));
+
+	return SDL_clamp(segments, 12, 1024);
+}
\ No newline at end of file
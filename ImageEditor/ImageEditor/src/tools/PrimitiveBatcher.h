@@ -0,0 +1,58 @@
+#ifndef __PRIMITIVE_BATCHER_H__
+#define __PRIMITIVE_BATCHER_H__
+
+#include <unordered_map>
+#include <vector>
+
+#include "SDL.h"
+
+/* Meshes kept around before the cache starts over, one per distinct shape size */
+#define PRIMITIVE_CACHE_SIZE 1024
+
+enum class PRIMITIVE_TYPE
+{
+	LINE = 0,
+	RECTANGLE,
+	RECTANGLE_FILL,
+	ELLIPSE,
+	ELLIPSE_FILL
+};
+
+/* Shapes are tessellated into triangles relative to their origin, so a mesh is reused for every position and color */
+class PrimitiveBatcher
+{
+public:
+	PrimitiveBatcher();
+	~PrimitiveBatcher();
+
+	/* Coordinates and sizes follow the SDL2_gfx functions the batcher replaces, rectangles include their far edge */
+	void AddLine(const int& x1, const int& y1, const int& x2, const int& y2, const int& size, const SDL_Color& color);
+	void AddRectangle(const int& x, const int& y, const int& width, const int& height, const SDL_Color& color);
+	void AddRectangleFill(const int& x, const int& y, const int& width, const int& height, const SDL_Color& color);
+	void AddEllipse(const int& x, const int& y, const int& radius_x, const int& radius_y, const SDL_Color& color);
+	void AddEllipseFill(const int& x, const int& y, const int& radius_x, const int& radius_y, const SDL_Color& color);
+
+	/* Submits everything queued as one SDL_RenderGeometry call */
+	void Flush(SDL_Renderer* renderer);
+
+private:
+	struct Mesh
+	{
+		std::vector<SDL_FPoint> positions;
+		std::vector<int> indices;
+	};
+
+	const Mesh& GetMesh(const PRIMITIVE_TYPE& type, const int& a, const int& b, const int& c);
+	void Append(const Mesh& mesh, const float& x, const float& y, const SDL_Color& color);
+
+	static void AddQuad(Mesh& mesh, const SDL_FPoint& p0, const SDL_FPoint& p1, const SDL_FPoint& p2, const SDL_FPoint& p3);
+	static int GetEllipseSegments(const int& radius_x, const int& radius_y);
+
+private:
+	std::unordered_map<Uint64, Mesh> cache;
+
+	std::vector<SDL_Vertex> vertices;
+	std::vector<int> indices;
+};
+
+#endif /* __PRIMITIVE_BATCHER_H__ */
\ No newline at end of file
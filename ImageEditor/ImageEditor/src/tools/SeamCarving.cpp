@@ -0,0 +1,360 @@
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <emmintrin.h>
+
+#include "modules/Editor.h"
+#include "utils/Parallel.h"
+#include "Application.h"
+#include "ColorSpace.h"
+#include "Transform.h"
+#include "SeamCarving.h"
+
+#define SEAM_CARVING_INF 1e30f
+
+void SeamCarving::ApplyContentAwareResize(const int& target_width, const int& target_height)
+{
+	std::vector<Uint32> pixels;
+	int width, height;
+
+	App->editor->ReadCanvasPixels(pixels, width, height);
+
+	if (target_width < width)
+	{
+		SeamCarving::CarveColumns(pixels, width, height, target_width);
+	}
+
+	if (target_height < height)
+	{
+		std::vector<Uint32> transposed(pixels.size());
+		Transform::Transpose(pixels.data(), width, transposed.data(), height, width, height);
+
+		SeamCarving::CarveColumns(transposed, height, width, target_height);
+
+		pixels.resize(transposed.size());
+		Transform::Transpose(transposed.data(), height, pixels.data(), width, height, width);
+	}
+
+	App->editor->WriteCanvasPixels(pixels, width, height);
+}
+
+void SeamCarving::CarveColumns(std::vector<Uint32>& pixels, int& width, const int& height, const int& target_width)
+{
+	if (target_width >= width || target_width <= 0 || height <= 0)
+		return;
+
+	SeamCarving carving(pixels, width, height);
+
+	carving.Carve(target_width);
+	carving.Pack();
+
+	width = target_width;
+}
+
+SeamCarving::SeamCarving(std::vector<Uint32>& pixels, const int& width, const int& height)
+	: pixels(pixels), stride(width), cost_stride(width + 2), width(width), height(height)
+{
+	size_t size = (size_t)width * height;
+
+	this->luma.resize(size);
+	this->energy.resize(size);
+	this->cost.assign((size_t)this->cost_stride * height, SEAM_CARVING_INF);
+	this->marks.assign(size, 0);
+	this->seams.resize((size_t)SEAM_CARVING_BATCH * height);
+	this->removed.resize((size_t)SEAM_CARVING_BATCH * height);
+
+	ParallelFor(0, height, 64, [&](const int& first, const int& last)
+	{
+		for (int row = first; row < last; ++row)
+		{
+			ColorSpace::LumaRow(this->pixels.data() + (size_t)row * width, width, this->luma.data() + (size_t)row * width);
+		}
+	});
+
+	ParallelFor(0, height, 64, [&](const int& first, const int& last)
+	{
+		this->ComputeEnergyRows(first, last);
+	});
+
+	for (int row = 0; row < height; ++row)
+	{
+		this->ComputeCostRow(row);
+	}
+}
+
+void SeamCarving::Carve(const int& target_width)
+{
+	while (this->width > target_width)
+	{
+		int batch = SDL_min(SDL_min(SEAM_CARVING_BATCH, this->width - target_width), SDL_max(1, this->width / 32));
+		int found = this->FindSeams(batch);
+
+		this->RemoveSeams(found);
+		this->UpdateCost(found);
+	}
+}
+
+void SeamCarving::Pack()
+{
+	for (int row = 1; row < this->height; ++row)
+	{
+		memmove(this->pixels.data() + (size_t)row * this->width, this->pixels.data() + (size_t)row * this->stride, this->width * sizeof(Uint32));
+	}
+
+	this->pixels.resize((size_t)this->width * this->height);
+}
+
+float SeamCarving::ComputeEnergy(const int& row, const int& col) const
+{
+	const Uint8* line = this->luma.data() + (size_t)row * this->stride;
+	const Uint8* up = this->luma.data() + (size_t)SDL_max(row - 1, 0) * this->stride;
+	const Uint8* down = this->luma.data() + (size_t)SDL_min(row + 1, this->height - 1) * this->stride;
+
+	int left = SDL_max(col - 1, 0);
+	int right = SDL_min(col + 1, this->width - 1);
+
+	return (float)(abs((int)line[right] - (int)line[left]) + abs((int)down[col] - (int)up[col]));
+}
+
+void SeamCarving::ComputeEnergyRows(const int& first, const int& last)
+{
+	for (int row = first; row < last; ++row)
+	{
+		float* line = this->energy.data() + (size_t)row * this->stride;
+
+		for (int col = 0; col < this->width; ++col)
+		{
+			line[col] = this->ComputeEnergy(row, col);
+		}
+	}
+}
+
+void SeamCarving::ComputeCostRow(const int& row)
+{
+	const float* energy_row = this->energy.data() + (size_t)row * this->stride;
+	float* cost_row = this->CostRow(row);
+
+	if (row == 0)
+	{
+		memcpy(cost_row, energy_row, this->width * sizeof(float));
+		return;
+	}
+
+	/* The padding columns hold +inf, so the three-way minimum needs no border checks */
+	const float* previous = this->CostRow(row - 1);
+
+	int col = 0;
+	for (; col + 4 <= this->width; col += 4)
+	{
+		__m128 left = _mm_loadu_ps(previous + col - 1);
+		__m128 center = _mm_loadu_ps(previous + col);
+		__m128 right = _mm_loadu_ps(previous + col + 1);
+
+		__m128 minimum = _mm_min_ps(_mm_min_ps(left, center), right);
+		_mm_storeu_ps(cost_row + col, _mm_add_ps(minimum, _mm_loadu_ps(energy_row + col)));
+	}
+
+	for (; col < this->width; ++col)
+	{
+		cost_row[col] = energy_row[col] + SDL_min(SDL_min(previous[col - 1], previous[col]), previous[col + 1]);
+	}
+}
+
+int SeamCarving::FindSeams(const int& count)
+{
+	/* Greedy backtracking from the cheapest bottom entries, a seam is dropped when it runs into a taken pixel */
+	const float* bottom = this->CostRow(this->height - 1);
+
+	std::vector<int> candidates(this->width);
+	std::iota(candidates.begin(), candidates.end(), 0);
+
+	int candidate_count = SDL_min(this->width, count * 16);
+	std::partial_sort(candidates.begin(), candidates.begin() + candidate_count, candidates.end(), [&](const int& a, const int& b)
+	{
+		return bottom[a] < bottom[b];
+	});
+
+	std::vector<int> path(this->height);
+	int found = 0;
+
+	for (int candidate = 0; candidate < candidate_count && found < count; ++candidate)
+	{
+		int col = candidates[candidate];
+		bool valid = !this->marks[(size_t)(this->height - 1) * this->stride + col];
+
+		path[this->height - 1] = col;
+
+		for (int row = this->height - 2; row >= 0 && valid; --row)
+		{
+			const float* cost_row = this->CostRow(row);
+			const Uint8* marks_row = this->marks.data() + (size_t)row * this->stride;
+
+			int best = -1;
+
+			for (int next = SDL_max(col - 1, 0); next <= SDL_min(col + 1, this->width - 1); ++next)
+			{
+				if (!marks_row[next] && (best < 0 || cost_row[next] < cost_row[best]))
+					best = next;
+			}
+
+			valid = best >= 0;
+			col = best;
+			path[row] = col;
+		}
+
+		if (!valid)
+			continue;
+
+		for (int row = 0; row < this->height; ++row)
+		{
+			this->marks[(size_t)row * this->stride + path[row]] = 1;
+			this->seams[(size_t)found * this->height + row] = path[row];
+		}
+
+		++found;
+	}
+
+	return found;
+}
+
+void SeamCarving::RemoveSeams(const int& count)
+{
+	ParallelFor(0, this->height, 32, [&](const int& first, const int& last)
+	{
+		for (int row = first; row < last; ++row)
+		{
+			int* columns = this->removed.data() + (size_t)row * SEAM_CARVING_BATCH;
+
+			for (int seam = 0; seam < count; ++seam)
+			{
+				columns[seam] = this->seams[(size_t)seam * this->height + row];
+				this->marks[(size_t)row * this->stride + columns[seam]] = 0;
+			}
+
+			std::sort(columns, columns + count);
+
+			Uint32* pixel_row = this->pixels.data() + (size_t)row * this->stride;
+			Uint8* luma_row = this->luma.data() + (size_t)row * this->stride;
+			float* energy_row = this->energy.data() + (size_t)row * this->stride;
+			float* cost_row = this->CostRow(row);
+
+			/* Shift every segment between two removed columns left by the number of columns removed so far */
+			for (int seam = 0; seam < count; ++seam)
+			{
+				int begin = columns[seam] + 1;
+				int end = seam + 1 < count ? columns[seam + 1] : this->width;
+				int length = end - begin;
+
+				if (length <= 0)
+					continue;
+
+				memmove(pixel_row + begin - seam - 1, pixel_row + begin, length * sizeof(Uint32));
+				memmove(luma_row + begin - seam - 1, luma_row + begin, length * sizeof(Uint8));
+				memmove(energy_row + begin - seam - 1, energy_row + begin, length * sizeof(float));
+				memmove(cost_row + begin - seam - 1, cost_row + begin, length * sizeof(float));
+			}
+
+			cost_row[this->width - count] = SEAM_CARVING_INF;
+		}
+	});
+
+	this->width -= count;
+}
+
+void SeamCarving::UpdateCost(const int& count)
+{
+	/* Energy only changes next to a removed pixel of the same or an adjacent row. Costs are recomputed
+	   for those columns and for the columns below any cost that actually changed */
+	std::vector<int> stamp(this->width + 2, -1);
+	std::vector<int> dirty, changed, next_changed;
+	std::vector<float> previous_costs;
+
+	dirty.reserve(this->width);
+	changed.reserve(this->width);
+	next_changed.reserve(this->width);
+
+	for (int row = 0; row < this->height; ++row)
+	{
+		dirty.clear();
+
+		auto add = [&](const int& col)
+		{
+			if (col >= 0 && col < this->width && stamp[col] != row)
+			{
+				stamp[col] = row;
+				dirty.push_back(col);
+			}
+		};
+
+		for (int neighbour = SDL_max(row - 1, 0); neighbour <= SDL_min(row + 1, this->height - 1); ++neighbour)
+		{
+			const int* columns = this->removed.data() + (size_t)neighbour * SEAM_CARVING_BATCH;
+
+			for (int seam = 0; seam < count; ++seam)
+			{
+				int hole = columns[seam] - seam;
+
+				for (int col = hole - 2; col <= hole + 1; ++col)
+				{
+					add(col);
+				}
+			}
+		}
+
+		float* energy_row = this->energy.data() + (size_t)row * this->stride;
+
+		for (const int& col : dirty)
+		{
+			energy_row[col] = this->ComputeEnergy(row, col);
+		}
+
+		next_changed.clear();
+
+		if ((int)(dirty.size() + changed.size() * 3) > this->width / 4)
+		{
+			float* cost_row = this->CostRow(row);
+
+			previous_costs.assign(cost_row, cost_row + this->width);
+
+			this->ComputeCostRow(row);
+
+			for (int col = 0; col < this->width; ++col)
+			{
+				if (cost_row[col] != previous_costs[col]) next_changed.push_back(col);
+			}
+		}
+		else
+		{
+			for (const int& col : changed)
+			{
+				add(col - 1);
+				add(col);
+				add(col + 1);
+			}
+
+			float* cost_row = this->CostRow(row);
+			const float* previous = row > 0 ? this->CostRow(row - 1) : nullptr;
+
+			for (const int& col : dirty)
+			{
+				float value = energy_row[col];
+
+				if (previous)
+					value += SDL_min(SDL_min(previous[col - 1], previous[col]), previous[col + 1]);
+
+				if (value != cost_row[col])
+				{
+					cost_row[col] = value;
+					next_changed.push_back(col);
+				}
+			}
+		}
+
+		changed.swap(next_changed);
+	}
+}
+
+float* SeamCarving::CostRow(const int& row)
+{
+	return this->cost.data() + (size_t)row * this->cost_stride + 1;
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef __SEAM_CARVING_H__
+#define __SEAM_CARVING_H__
+
+#include <vector>
+
+#include "SDL.h"
+
+#define SEAM_CARVING_BATCH 32
+
+class SeamCarving
+{
+public:
+	/* Only shrinks, heights are carved on the transposed image */
+	static void ApplyContentAwareResize(const int& target_width, const int& target_height);
+
+	/* Pixels are tightly packed before and after the call, width becomes target_width */
+	static void CarveColumns(std::vector<Uint32>& pixels, int& width, const int& height, const int& target_width);
+
+private:
+	SeamCarving(std::vector<Uint32>& pixels, const int& width, const int& height);
+
+	void Carve(const int& target_width);
+	void Pack();
+
+	float ComputeEnergy(const int& row, const int& col) const;
+	void ComputeEnergyRows(const int& first, const int& last);
+	void ComputeCostRow(const int& row);
+
+	int FindSeams(const int& count);
+	void RemoveSeams(const int& count);
+	void UpdateCost(const int& count);
+
+	float* CostRow(const int& row);
+
+private:
+	std::vector<Uint32>& pixels;
+	std::vector<Uint8> luma;
+	std::vector<float> energy;
+	std::vector<float> cost;
+
+	/* seams[seam * height + row] holds a column, removed[row * SEAM_CARVING_BATCH + i] the sorted columns of a row */
+	std::vector<int> seams;
+	std::vector<int> removed;
+	std::vector<Uint8> marks;
+
+	int stride;
+	int cost_stride;
+	int width;
+	int height;
+};
+
+#endif /* __SEAM_CARVING_H__ */
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include <cmath>
+
+#include "utils/Parallel.h"
+#include "Transform.h"
+#include "SeparableFilters.h"
+
+void SeparableFilters::Convolve(float* plane, const int& width, const int& height, const std::vector<float>& kernel)
+{
+	std::vector<float> rows((size_t)width * height);
+	std::vector<float> columns((size_t)width * height);
+
+	SeparableFilters::ConvolveRows(plane, rows.data(), width, height, kernel);
+	Transform::Transpose(rows.data(), width, columns.data(), height, width, height);
+
+	SeparableFilters::ConvolveRows(columns.data(), rows.data(), height, width, kernel);
+	Transform::Transpose(rows.data(), height, plane, width, height, width);
+}
+
+void SeparableFilters::RecursiveGaussian(float* plane, const int& width, const int& height, const float& sigma)
+{
+	double s = SDL_max(sigma, 0.5f);
+	double q = s >= 2.5 ? 0.98711 * s - 0.96330 : 3.97156 - 4.14554 * std::sqrt(1.0 - 0.26891 * s);
+
+	double b0 = 1.57825 + 2.44413 * q + 1.4281 * q * q + 0.422205 * q * q * q;
+	double b1 = 2.44413 * q + 2.85619 * q * q + 1.26661 * q * q * q;
+	double b2 = -(1.4281 * q * q + 1.26661 * q * q * q);
+	double b3 = 0.422205 * q * q * q;
+
+	const double coefficients[4] = { 1.0 - (b1 + b2 + b3) / b0, b1 / b0, b2 / b0, b3 / b0 };
+
+	std::vector<float> transposed((size_t)width * height);
+
+	SeparableFilters::RecursiveGaussianRows(plane, width, height, coefficients);
+	Transform::Transpose(plane, width, transposed.data(), height, width, height);
+
+	SeparableFilters::RecursiveGaussianRows(transposed.data(), height, width, coefficients);
+	Transform::Transpose(transposed.data(), height, plane, width, height, width);
+}
+
+void SeparableFilters::ConvolveRows(const float* src, float* dst, const int& width, const int& height, const std::vector<float>& kernel)
+{
+	int kernel_size = (int)kernel.size();
+	int krad = kernel_size / 2;
+
+	for (int row = 0; row < height; ++row)
+	{
+		const float* src_row = src + (size_t)row * width;
+		float* dst_row = dst + (size_t)row * width;
+
+		for (int col = 0; col < width; ++col)
+		{
+			float sum = 0.0f;
+
+			if (col >= krad && col + krad < width)
+			{
+				const float* window = src_row + col - krad;
+
+				for (int k = 0; k < kernel_size; ++k)
+				{
+					sum += kernel[k] * window[k];
+				}
+			}
+			else
+			{
+				for (int k = 0; k < kernel_size; ++k)
+				{
+					int target_col = col + k - krad;
+
+					if (target_col >= 0 && target_col < width)
+					{
+						sum += kernel[k] * src_row[target_col];
+					}
+				}
+			}
+
+			dst_row[col] = sum;
+		}
+	}
+}
+
+void SeparableFilters::RecursiveGaussianRows(float* plane, const int& width, const int& height, const double coefficients[4])
+{
+	const double B = coefficients[0];
+	const double b1 = coefficients[1];
+	const double b2 = coefficients[2];
+	const double b3 = coefficients[3];
+
+	ParallelFor(0, height, 16, [&](const int& first, const int& last)
+	{
+		std::vector<double> forward(width);
+
+		for (int row = first; row < last; ++row)
+		{
+			float* line = plane + (size_t)row * width;
+
+			/* Constant input is a fixed point of the recursion, so the edge value seeds both passes */
+			double w1 = line[0], w2 = line[0], w3 = line[0];
+
+			for (int col = 0; col < width; ++col)
+			{
+				double w = B * line[col] + b1 * w1 + b2 * w2 + b3 * w3;
+
+				forward[col] = w;
+
+				w3 = w2;
+				w2 = w1;
+				w1 = w;
+			}
+
+			double o1 = forward[width - 1], o2 = forward[width - 1], o3 = forward[width - 1];
+
+			for (int col = width - 1; col >= 0; --col)
+			{
+				double o = B * forward[col] + b1 * o1 + b2 * o2 + b3 * o3;
+
+				line[col] = (float)o;
+
+				o3 = o2;
+				o2 = o1;
+				o1 = o;
+			}
+		}
+	});
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#ifndef __SEPARABLE_FILTERS_H__
+#define __SEPARABLE_FILTERS_H__
+
+#include <vector>
+
+class SeparableFilters
+{
+public:
+	/* Row pass, transpose, row pass, transpose back. Samples outside the plane count as zero */
+	static void Convolve(float* plane, const int& width, const int& height, const std::vector<float>& kernel);
+
+	/* Young-van Vliet recursive Gaussian, the cost does not depend on sigma. Borders are extended with the edge value */
+	static void RecursiveGaussian(float* plane, const int& width, const int& height, const float& sigma);
+
+private:
+	static void ConvolveRows(const float* src, float* dst, const int& width, const int& height, const std::vector<float>& kernel);
+	static void RecursiveGaussianRows(float* plane, const int& width, const int& height, const double coefficients[4]);
+};
+
+#endif /* __SEPARABLE_FILTERS_H__ */
\ No newline at end of file
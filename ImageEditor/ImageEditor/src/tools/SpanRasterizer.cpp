@@ -0,0 +1,33 @@
+#include <cmath>
+
+#include "SDL.h"
+
+#include "SpanRasterizer.h"
+
+void SpanRasterizer::Circle(const int& x, const int& y, const int& radius, std::vector<Span>& spans)
+{
+	spans.clear();
+
+	if (radius < 0)
+		return;
+
+	spans.reserve((size_t)radius * 2 + 1);
+
+	Sint64 radius_squared = (Sint64)radius * radius;
+
+	for (int dy = -radius; dy <= radius; ++dy)
+	{
+		Sint64 remaining = radius_squared - (Sint64)dy * dy;
+
+		/* Floor of the square root, corrected for the rounding of the floating point one */
+		int half = (int)std::sqrt((double)remaining);
+
+		while ((Sint64)half * half > remaining)
+			--half;
+
+		while ((Sint64)(half + 1) * (half + 1) <= remaining)
+			++half;
+
+		spans.push_back({ y + dy, x - half, x + half + 1 });
+	}
+}
\ No newline at end of file
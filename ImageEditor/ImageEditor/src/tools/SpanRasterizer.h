@@ -0,0 +1,22 @@
+#ifndef __SPAN_RASTERIZER_H__
+#define __SPAN_RASTERIZER_H__
+
+#include <vector>
+
+/* One horizontal run of covered pixels, [x0, x1) on row y */
+struct Span
+{
+	int y;
+	int x0;
+	int x1;
+};
+
+/* Shapes are emitted as one span per scanline, top to bottom, so a fill costs one call per row instead of one per pixel */
+class SpanRasterizer
+{
+public:
+	/* Every pixel whose offset from the center satisfies dx^2 + dy^2 <= radius^2 */
+	static void Circle(const int& x, const int& y, const int& radius, std::vector<Span>& spans);
+};
+
+#endif /* __SPAN_RASTERIZER_H__ */
\ No newline at end of file
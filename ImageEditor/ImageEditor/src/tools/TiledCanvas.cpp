@@ -0,0 +1,1077 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+#include "modules/Renderer.h"
+#include "utils/Parallel.h"
+#include "Application.h"
+#include "TiledCanvas.h"
+
+TiledCanvas::TiledCanvas()
+	: width(0), height(0), background(0xFFFFFFFF), damage({ 0, 0, 0, 0 }), original_background(0xFFFFFFFF), pending(false), history_enabled(true), frame(0), texture_count(0)
+{
+
+}
+
+TiledCanvas::~TiledCanvas()
+{
+	this->Clear();
+}
+
+void TiledCanvas::Resize(const int& width, const int& height, const Uint32& background)
+{
+	/* A canvas that already had content keeps what it looked like for the history */
+	std::shared_ptr<CanvasState> from = this->resized_from;
+
+	if (from == nullptr && this->width > 0 && this->history_enabled)
+	{
+		from = this->Snapshot(true);
+	}
+
+	this->Clear();
+
+	this->background = background;
+	this->Build(width, height);
+
+	this->resized_from = from;
+	this->pending = from != nullptr;
+}
+
+void TiledCanvas::Build(const int& width, const int& height)
+{
+	this->width = SDL_max(width, 0);
+	this->height = SDL_max(height, 0);
+
+	int level_width = this->width;
+	int level_height = this->height;
+
+	/* Halve until a single tile holds the whole level */
+	do
+	{
+		Level level;
+		level.width = level_width;
+		level.height = level_height;
+		level.tiles_x = (level_width + CANVAS_TILE_SIZE - 1) / CANVAS_TILE_SIZE;
+		level.tiles_y = (level_height + CANVAS_TILE_SIZE - 1) / CANVAS_TILE_SIZE;
+		level.tiles.resize((size_t)level.tiles_x * level.tiles_y);
+		level.stale.assign((size_t)level.tiles_x * level.tiles_y, 0);
+
+		this->levels.push_back(std::move(level));
+
+		level_width = (level_width + 1) / 2;
+		level_height = (level_height + 1) / 2;
+	} while (this->levels.back().tiles_x > 1 || this->levels.back().tiles_y > 1);
+
+	this->damage = { 0, 0, this->width, this->height };
+	this->changed.assign(this->levels[0].tiles.size(), 1);
+
+	this->originals.assign(this->levels[0].tiles.size(), nullptr);
+	this->edited.assign(this->levels[0].tiles.size(), 0);
+	this->original_background = this->background;
+}
+
+void TiledCanvas::Clear()
+{
+	this->ReleaseTextures();
+
+	this->levels.clear();
+	this->levels.shrink_to_fit();
+	this->changed.clear();
+
+	this->originals.clear();
+	this->edited.clear();
+	this->resized_from.reset();
+	this->pending = false;
+
+	this->width = 0;
+	this->height = 0;
+}
+
+void TiledCanvas::ReadRegion(Uint32* pixels, const int& stride, const SDL_Rect& region) const
+{
+	SDL_Rect clipped, range;
+	if (!this->GetTileRange(0, region, clipped, range))
+		return;
+
+	const Level& base = this->levels[0];
+
+	ParallelFor(range.y, range.y + range.h, 1, [&](const int& first, const int& last)
+	{
+		for (int tile_y = first; tile_y < last; ++tile_y)
+		{
+			for (int tile_x = range.x; tile_x < range.x + range.w; ++tile_x)
+			{
+				SDL_Rect tile_rect = this->GetTileRect(0, tile_x, tile_y);
+				SDL_Rect part;
+				SDL_IntersectRect(&tile_rect, &clipped, &part);
+
+				const Tile* tile = base.tiles[(size_t)tile_y * base.tiles_x + tile_x].get();
+
+				for (int row = part.y; row < part.y + part.h; ++row)
+				{
+					Uint32* destination = pixels + (size_t)(row - region.y) * stride + (part.x - region.x);
+
+					if (tile)
+					{
+						memcpy(destination, tile->pixels->data() + (size_t)(row - tile_rect.y) * CANVAS_TILE_SIZE + (part.x - tile_rect.x), part.w * sizeof(Uint32));
+					}
+					else
+					{
+						std::fill(destination, destination + part.w, this->background);
+					}
+				}
+			}
+		}
+	});
+}
+
+void TiledCanvas::WriteRegion(const Uint32* pixels, const int& stride, const SDL_Rect& region)
+{
+	SDL_Rect clipped, range;
+	if (!this->GetTileRange(0, region, clipped, range))
+		return;
+
+	Level& base = this->levels[0];
+	std::vector<Uint8> released((size_t)range.w * range.h, 0);
+
+	this->pending = true;
+
+	ParallelFor(range.y, range.y + range.h, 1, [&](const int& first, const int& last)
+	{
+		for (int tile_y = first; tile_y < last; ++tile_y)
+		{
+			for (int tile_x = range.x; tile_x < range.x + range.w; ++tile_x)
+			{
+				SDL_Rect tile_rect = this->GetTileRect(0, tile_x, tile_y);
+				SDL_Rect part;
+				SDL_IntersectRect(&tile_rect, &clipped, &part);
+
+				Tile* tile = base.tiles[(size_t)tile_y * base.tiles_x + tile_x].get();
+
+				if (tile == nullptr)
+				{
+					bool empty = true;
+
+					for (int row = part.y; row < part.y + part.h && empty; ++row)
+					{
+						const Uint32* source = pixels + (size_t)(row - region.y) * stride + (part.x - region.x);
+						empty = std::all_of(source, source + part.w, [&](const Uint32& pixel) { return pixel == this->background; });
+					}
+
+					if (empty)
+						continue;
+				}
+
+				/* Each worker owns whole tile rows, so allocating or copying here never races */
+				tile = this->EditTile(tile_x, tile_y);
+
+				for (int row = part.y; row < part.y + part.h; ++row)
+				{
+					memcpy(
+						tile->pixels->data() + (size_t)(row - tile_rect.y) * CANVAS_TILE_SIZE + (part.x - tile_rect.x),
+						pixels + (size_t)(row - region.y) * stride + (part.x - region.x),
+						part.w * sizeof(Uint32)
+					);
+				}
+
+				tile->dirty = true;
+
+				if (SDL_RectEquals(&part, &tile_rect) && this->IsBackground(*tile, tile_rect))
+				{
+					released[(size_t)(tile_y - range.y) * range.w + (tile_x - range.x)] = 1;
+				}
+			}
+		}
+	});
+
+	/* Textures belong to the render thread, so tiles are only freed once the workers are done */
+	for (int tile_y = range.y; tile_y < range.y + range.h; ++tile_y)
+	{
+		for (int tile_x = range.x; tile_x < range.x + range.w; ++tile_x)
+		{
+			if (released[(size_t)(tile_y - range.y) * range.w + (tile_x - range.x)])
+			{
+				this->ReleaseTile(0, tile_x, tile_y);
+			}
+
+			this->Invalidate(tile_x, tile_y);
+		}
+	}
+}
+
+void TiledCanvas::TransformPixels(const CanvasPixelFunction& function)
+{
+	if (this->levels.empty())
+		return;
+
+	Level& base = this->levels[0];
+	std::vector<int> allocated;
+
+	for (int i = 0; i < (int)base.tiles.size(); ++i)
+	{
+		if (base.tiles[i])
+		{
+			allocated.push_back(i);
+		}
+	}
+
+	this->pending = true;
+
+	ParallelFor(0, (int)allocated.size(), 1, [&](const int& first, const int& last)
+	{
+		for (int i = first; i < last; ++i)
+		{
+			Tile* tile = this->EditTile(allocated[i] % base.tiles_x, allocated[i] / base.tiles_x);
+
+			function(tile->pixels->data(), CANVAS_TILE_SIZE * CANVAS_TILE_SIZE);
+
+			tile->dirty = true;
+		}
+	});
+
+	/* Tiles that are not stored still show the background, so it goes through the same function */
+	function(&this->background, 1);
+
+	/* Tiles that now equal the new background are released. Only the comparison runs in parallel, releasing destroys textures */
+	std::vector<Uint8> flat(allocated.size(), 0);
+
+	ParallelFor(0, (int)allocated.size(), 1, [&](const int& first, const int& last)
+	{
+		for (int i = first; i < last; ++i)
+		{
+			int tile_x = allocated[i] % base.tiles_x;
+			int tile_y = allocated[i] / base.tiles_x;
+
+			flat[i] = this->IsBackground(*base.tiles[allocated[i]], this->GetTileRect(0, tile_x, tile_y)) ? 1 : 0;
+		}
+	});
+
+	for (int i = 0; i < (int)allocated.size(); ++i)
+	{
+		if (flat[i])
+		{
+			this->ReleaseTile(0, allocated[i] % base.tiles_x, allocated[i] / base.tiles_x);
+		}
+	}
+
+	this->InvalidateAll();
+}
+
+void TiledCanvas::Draw(const SDL_Rect& bounds, const CanvasDrawFunction& draw)
+{
+	SDL_Rect clipped, range;
+	if (!this->GetTileRange(0, bounds, clipped, range))
+		return;
+
+	SDL_Renderer* renderer = App->renderer->renderer;
+	SDL_Texture* previous_target = SDL_GetRenderTarget(renderer);
+
+	this->pending = true;
+
+	for (int tile_y = range.y; tile_y < range.y + range.h; ++tile_y)
+	{
+		for (int tile_x = range.x; tile_x < range.x + range.w; ++tile_x)
+		{
+			Tile* tile = this->EditTile(tile_x, tile_y);
+
+			this->UploadTile(*tile, SDL_TEXTUREACCESS_TARGET);
+
+			if (tile->texture == nullptr)
+				continue;
+
+			SDL_SetRenderTarget(renderer, tile->texture);
+
+			draw(tile_x * CANVAS_TILE_SIZE, tile_y * CANVAS_TILE_SIZE);
+			App->renderer->FlushPrimitives();
+
+			SDL_RenderReadPixels(
+				renderer,
+				nullptr,
+				App->renderer->texture_format,
+				tile->pixels->data(),
+				CANVAS_TILE_SIZE * sizeof(Uint32)
+			);
+
+			tile->last_frame = this->frame;
+
+			if (this->IsBackground(*tile, this->GetTileRect(0, tile_x, tile_y)))
+			{
+				this->ReleaseTile(0, tile_x, tile_y);
+			}
+
+			this->Invalidate(tile_x, tile_y);
+		}
+	}
+
+	SDL_SetRenderTarget(renderer, previous_target);
+
+	/* Canvases that are never shown only get here, so their draw targets are evicted the same way */
+	++this->frame;
+	this->EvictTextures();
+}
+
+void TiledCanvas::FillSpans(const std::vector<Span>& spans, const Uint32& color)
+{
+	if (this->levels.empty())
+		return;
+
+	Level& base = this->levels[0];
+	std::vector<size_t> touched;
+
+	this->pending = true;
+
+	for (const Span& span : spans)
+	{
+		if (span.y < 0 || span.y >= this->height)
+			continue;
+
+		int x0 = SDL_max(span.x0, 0);
+		int x1 = SDL_min(span.x1, this->width);
+
+		int tile_y = span.y / CANVAS_TILE_SIZE;
+		int row = span.y - tile_y * CANVAS_TILE_SIZE;
+
+		while (x0 < x1)
+		{
+			int tile_x = x0 / CANVAS_TILE_SIZE;
+			int end = SDL_min(x1, (tile_x + 1) * CANVAS_TILE_SIZE);
+
+			size_t index = (size_t)tile_y * base.tiles_x + tile_x;
+			Tile* tile = base.tiles[index].get();
+
+			/* Painting the background over a tile that is not stored changes nothing */
+			if (tile != nullptr || color != this->background)
+			{
+				tile = this->EditTile(tile_x, tile_y);
+			}
+
+			if (tile != nullptr)
+			{
+				Uint32* line = tile->pixels->data() + (size_t)row * CANVAS_TILE_SIZE;
+				std::fill(line + (x0 - tile_x * CANVAS_TILE_SIZE), line + (end - tile_x * CANVAS_TILE_SIZE), color);
+
+				tile->dirty = true;
+				touched.push_back(index);
+			}
+
+			x0 = end;
+		}
+	}
+
+	std::sort(touched.begin(), touched.end());
+	touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+	for (const size_t& index : touched)
+	{
+		int tile_x = (int)(index % base.tiles_x);
+		int tile_y = (int)(index / base.tiles_x);
+
+		if (color == this->background && this->IsBackground(*base.tiles[index], this->GetTileRect(0, tile_x, tile_y)))
+		{
+			this->ReleaseTile(0, tile_x, tile_y);
+		}
+
+		this->Invalidate(tile_x, tile_y);
+	}
+}
+
+void TiledCanvas::BlendMask(const Uint8* mask, const int& stride, const SDL_Rect& region, const Uint32& color)
+{
+	SDL_Rect clipped, range;
+	if (!this->GetTileRange(0, region, clipped, range))
+		return;
+
+	Level& base = this->levels[0];
+	Uint32 color_alpha = color & 0xFF;
+
+	if (color_alpha == 0)
+		return;
+
+	this->pending = true;
+
+	for (int tile_y = range.y; tile_y < range.y + range.h; ++tile_y)
+	{
+		for (int tile_x = range.x; tile_x < range.x + range.w; ++tile_x)
+		{
+			SDL_Rect tile_rect = this->GetTileRect(0, tile_x, tile_y);
+			SDL_Rect part;
+			SDL_IntersectRect(&tile_rect, &clipped, &part);
+
+			Tile* tile = base.tiles[(size_t)tile_y * base.tiles_x + tile_x].get();
+
+			if (tile == nullptr)
+			{
+				/* Blending the background over itself changes nothing */
+				if (color == this->background)
+					continue;
+			}
+
+			tile = this->EditTile(tile_x, tile_y);
+
+			for (int row = part.y; row < part.y + part.h; ++row)
+			{
+				const Uint8* coverage = mask + (size_t)(row - region.y) * stride + (part.x - region.x);
+				Uint32* line = tile->pixels->data() + (size_t)(row - tile_rect.y) * CANVAS_TILE_SIZE + (part.x - tile_rect.x);
+
+				for (int x = 0; x < part.w; ++x)
+				{
+					Uint32 alpha = (coverage[x] * color_alpha + 127) / 255;
+
+					if (alpha == 0)
+						continue;
+
+					Uint32 pixel = line[x];
+					Uint32 inverse = 255 - alpha;
+
+					Uint32 r = ((color >> 24) * alpha + (pixel >> 24) * inverse + 127) / 255;
+					Uint32 g = (((color >> 16) & 0xFF) * alpha + ((pixel >> 16) & 0xFF) * inverse + 127) / 255;
+					Uint32 b = (((color >> 8) & 0xFF) * alpha + ((pixel >> 8) & 0xFF) * inverse + 127) / 255;
+					Uint32 a = alpha + ((pixel & 0xFF) * inverse + 127) / 255;
+
+					line[x] = (r << 24) | (g << 16) | (b << 8) | a;
+				}
+			}
+
+			tile->dirty = true;
+
+			if (color == this->background && this->IsBackground(*tile, tile_rect))
+			{
+				this->ReleaseTile(0, tile_x, tile_y);
+			}
+
+			this->Invalidate(tile_x, tile_y);
+		}
+	}
+}
+
+void TiledCanvas::Render(const SDL_Rect& destination, const SDL_Rect& clip)
+{
+	SDL_Renderer* renderer = App->renderer->renderer;
+
+	SDL_Rect visible;
+
+	if (this->width > 0 && SDL_IntersectRect(&clip, &destination, &visible))
+	{
+		Uint8 r, g, b, a;
+		SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+
+		SDL_SetRenderDrawColor(renderer, this->background >> 24, (this->background >> 16) & 0xFF, (this->background >> 8) & 0xFF, this->background & 0xFF);
+		SDL_RenderFillRect(renderer, &visible);
+		SDL_SetRenderDrawColor(renderer, r, g, b, a);
+
+		/* Screen pixels per pixel of the chosen level, kept in (0.5, 1] while minifying */
+		double scale = (double)destination.w / this->width;
+		int level_index = 0;
+
+		while (level_index + 1 < (int)this->levels.size() && scale * 2.0 <= 1.0)
+		{
+			++level_index;
+			scale *= 2.0;
+		}
+
+		Level& level = this->levels[level_index];
+
+		int first_x = (int)std::floor((visible.x - destination.x) / scale);
+		int first_y = (int)std::floor((visible.y - destination.y) / scale);
+		int last_x = (int)std::ceil((visible.x + visible.w - destination.x) / scale);
+		int last_y = (int)std::ceil((visible.y + visible.h - destination.y) / scale);
+
+		SDL_Rect region = { first_x, first_y, last_x - first_x, last_y - first_y };
+		SDL_Rect clipped, range;
+
+		if (this->GetTileRange(level_index, region, clipped, range))
+		{
+			for (int tile_y = range.y; tile_y < range.y + range.h; ++tile_y)
+			{
+				for (int tile_x = range.x; tile_x < range.x + range.w; ++tile_x)
+				{
+					size_t index = (size_t)tile_y * level.tiles_x + tile_x;
+
+					if (level.stale[index])
+					{
+						this->BuildMipTile(level_index, tile_x, tile_y);
+					}
+
+					Tile* tile = level.tiles[index].get();
+
+					if (tile == nullptr)
+						continue;
+
+					this->UploadTile(*tile, level_index == 0 ? SDL_TEXTUREACCESS_TARGET : SDL_TEXTUREACCESS_STATIC);
+
+					if (tile->texture == nullptr)
+						continue;
+
+					tile->last_frame = this->frame;
+
+					/* Both edges are rounded from level coordinates so neighbouring tiles never leave a gap */
+					SDL_Rect tile_rect = this->GetTileRect(level_index, tile_x, tile_y);
+					int x0 = destination.x + (int)std::floor(tile_rect.x * scale + 0.5);
+					int y0 = destination.y + (int)std::floor(tile_rect.y * scale + 0.5);
+					int x1 = destination.x + (int)std::floor((tile_rect.x + tile_rect.w) * scale + 0.5);
+					int y1 = destination.y + (int)std::floor((tile_rect.y + tile_rect.h) * scale + 0.5);
+
+					SDL_Rect source = { 0, 0, tile_rect.w, tile_rect.h };
+					SDL_Rect target = { x0, y0, x1 - x0, y1 - y0 };
+
+					SDL_RenderCopy(renderer, tile->texture, &source, &target);
+				}
+			}
+		}
+	}
+
+	++this->frame;
+
+	this->EvictTextures();
+}
+
+void TiledCanvas::ReleaseTextures()
+{
+	for (Level& level : this->levels)
+	{
+		for (std::unique_ptr<Tile>& tile : level.tiles)
+		{
+			if (tile && tile->texture)
+			{
+				SDL_DestroyTexture(tile->texture);
+
+				tile->texture = nullptr;
+				tile->dirty = true;
+			}
+		}
+	}
+
+	this->texture_count = 0;
+}
+
+bool TiledCanvas::TakeDamage(SDL_Rect& region)
+{
+	if (SDL_RectEmpty(&this->damage))
+		return false;
+
+	region = this->damage;
+	this->damage = { 0, 0, 0, 0 };
+
+	return true;
+}
+
+void TiledCanvas::CollectChangedTiles(std::vector<Uint8>& changed)
+{
+	for (size_t i = 0; i < this->changed.size() && i < changed.size(); ++i)
+	{
+		changed[i] |= this->changed[i];
+	}
+
+	std::fill(this->changed.begin(), this->changed.end(), 0);
+}
+
+const Uint32* TiledCanvas::GetTile(const int& tile_x, const int& tile_y) const
+{
+	const Tile* tile = this->levels[0].tiles[(size_t)tile_y * this->levels[0].tiles_x + tile_x].get();
+
+	return tile ? tile->pixels->data() : nullptr;
+}
+
+void TiledCanvas::SetBackground(const Uint32& background)
+{
+	if (background == this->background)
+		return;
+
+	this->background = background;
+
+	/* Tiles that are not stored change color, so everything is reported */
+	this->InvalidateAll();
+}
+
+bool TiledCanvas::TakeChange(CanvasChange& change)
+{
+	change = CanvasChange();
+
+	if (!this->pending)
+		return false;
+
+	if (this->resized_from)
+	{
+		change.resized_from = this->resized_from;
+		change.resized_to = this->Snapshot(false);
+	}
+	else
+	{
+		const Level& base = this->levels[0];
+
+		for (int i = 0; i < (int)this->edited.size(); ++i)
+		{
+			if (!this->edited[i])
+				continue;
+
+			const TilePixels& before = this->originals[i];
+			const TilePixels& after = base.tiles[i] ? base.tiles[i]->pixels : nullptr;
+
+			/* Tiles written with what they already had, e.g. a cancelled preview, are left out */
+			if (before == after || (before && after && memcmp(before->data(), after->data(), before->size() * sizeof(Uint32)) == 0))
+				continue;
+
+			change.tiles.push_back(i);
+			change.before.push_back(before);
+			change.after.push_back(after);
+		}
+	}
+
+	change.background_before = this->original_background;
+	change.background_after = this->background;
+
+	this->DiscardChange();
+
+	return change.resized_from || !change.tiles.empty() || change.background_before != change.background_after;
+}
+
+void TiledCanvas::ApplyChange(const CanvasChange& change, const bool& undo)
+{
+	if (change.resized_from)
+	{
+		this->Restore(undo ? *change.resized_from : *change.resized_to);
+		return;
+	}
+
+	const std::vector<TilePixels>& pixels = undo ? change.before : change.after;
+	Uint32 background = undo ? change.background_before : change.background_after;
+
+	if (this->levels.empty())
+		return;
+
+	for (size_t i = 0; i < change.tiles.size(); ++i)
+	{
+		if (change.tiles[i] >= (int)this->levels[0].tiles.size())
+			continue;
+
+		int tile_x = change.tiles[i] % this->levels[0].tiles_x;
+		int tile_y = change.tiles[i] / this->levels[0].tiles_x;
+
+		this->SetTilePixels(tile_x, tile_y, pixels[i]);
+		this->Invalidate(tile_x, tile_y);
+	}
+
+	if (background != this->background)
+	{
+		this->background = background;
+		this->InvalidateAll();
+	}
+
+	this->DiscardChange();
+}
+
+void TiledCanvas::DiscardChange()
+{
+	std::fill(this->originals.begin(), this->originals.end(), nullptr);
+	std::fill(this->edited.begin(), this->edited.end(), 0);
+
+	this->resized_from.reset();
+	this->original_background = this->background;
+	this->pending = false;
+}
+
+void TiledCanvas::SetHistoryEnabled(const bool& enabled)
+{
+	this->history_enabled = enabled;
+
+	this->DiscardChange();
+}
+
+int TiledCanvas::GetWidth() const
+{
+	return this->width;
+}
+
+int TiledCanvas::GetHeight() const
+{
+	return this->height;
+}
+
+Uint32 TiledCanvas::GetBackground() const
+{
+	return this->background;
+}
+
+int TiledCanvas::GetTilesX() const
+{
+	return this->levels.empty() ? 0 : this->levels[0].tiles_x;
+}
+
+int TiledCanvas::GetTilesY() const
+{
+	return this->levels.empty() ? 0 : this->levels[0].tiles_y;
+}
+
+size_t TiledCanvas::GetAllocatedTiles() const
+{
+	if (this->levels.empty())
+		return 0;
+
+	return (size_t)std::count_if(this->levels[0].tiles.begin(), this->levels[0].tiles.end(), [](const std::unique_ptr<Tile>& tile) { return tile != nullptr; });
+}
+
+TiledCanvas::Tile* TiledCanvas::AllocateTile(const int& level, const int& tile_x, const int& tile_y)
+{
+	std::unique_ptr<Tile>& tile = this->levels[level].tiles[(size_t)tile_y * this->levels[level].tiles_x + tile_x];
+
+	tile.reset(new Tile());
+	tile->pixels = std::make_shared<std::vector<Uint32>>(CANVAS_TILE_SIZE * CANVAS_TILE_SIZE, this->background);
+	tile->texture = nullptr;
+	tile->last_frame = 0;
+	tile->dirty = true;
+
+	return tile.get();
+}
+
+TiledCanvas::Tile* TiledCanvas::EditTile(const int& tile_x, const int& tile_y)
+{
+	size_t index = (size_t)tile_y * this->levels[0].tiles_x + tile_x;
+	std::unique_ptr<Tile>& tile = this->levels[0].tiles[index];
+
+	if (this->history_enabled && !this->edited[index])
+	{
+		this->originals[index] = tile ? tile->pixels : nullptr;
+		this->edited[index] = 1;
+	}
+
+	if (tile == nullptr)
+		return this->AllocateTile(0, tile_x, tile_y);
+
+	/* Copy-on-write, the history or a snapshot still holds these pixels */
+	if (tile->pixels.use_count() > 1)
+	{
+		tile->pixels = std::make_shared<std::vector<Uint32>>(*tile->pixels);
+	}
+
+	return tile.get();
+}
+
+void TiledCanvas::SetTilePixels(const int& tile_x, const int& tile_y, const TilePixels& pixels)
+{
+	if (pixels == nullptr)
+	{
+		this->ReleaseTile(0, tile_x, tile_y);
+		return;
+	}
+
+	std::unique_ptr<Tile>& tile = this->levels[0].tiles[(size_t)tile_y * this->levels[0].tiles_x + tile_x];
+
+	if (tile == nullptr)
+	{
+		tile.reset(new Tile());
+		tile->texture = nullptr;
+		tile->last_frame = 0;
+	}
+
+	tile->pixels = pixels;
+	tile->dirty = true;
+}
+
+void TiledCanvas::ReleaseTile(const int& level, const int& tile_x, const int& tile_y)
+{
+	std::unique_ptr<Tile>& tile = this->levels[level].tiles[(size_t)tile_y * this->levels[level].tiles_x + tile_x];
+
+	if (tile && tile->texture)
+	{
+		SDL_DestroyTexture(tile->texture);
+		--this->texture_count;
+	}
+
+	tile.reset();
+}
+
+bool TiledCanvas::IsBackground(const Tile& tile, const SDL_Rect& rect) const
+{
+	for (int row = 0; row < rect.h; ++row)
+	{
+		const Uint32* line = tile.pixels->data() + (size_t)row * CANVAS_TILE_SIZE;
+
+		if (!std::all_of(line, line + rect.w, [&](const Uint32& pixel) { return pixel == this->background; }))
+			return false;
+	}
+
+	return true;
+}
+
+SDL_Rect TiledCanvas::GetTileRect(const int& level, const int& tile_x, const int& tile_y) const
+{
+	int x = tile_x * CANVAS_TILE_SIZE;
+	int y = tile_y * CANVAS_TILE_SIZE;
+
+	return { x, y, SDL_min(CANVAS_TILE_SIZE, this->levels[level].width - x), SDL_min(CANVAS_TILE_SIZE, this->levels[level].height - y) };
+}
+
+bool TiledCanvas::GetTileRange(const int& level, const SDL_Rect& region, SDL_Rect& clipped, SDL_Rect& range) const
+{
+	if (level >= (int)this->levels.size())
+		return false;
+
+	SDL_Rect bounds = { 0, 0, this->levels[level].width, this->levels[level].height };
+
+	if (!SDL_IntersectRect(&bounds, &region, &clipped))
+		return false;
+
+	int first_x = clipped.x / CANVAS_TILE_SIZE;
+	int first_y = clipped.y / CANVAS_TILE_SIZE;
+	int last_x = (clipped.x + clipped.w - 1) / CANVAS_TILE_SIZE;
+	int last_y = (clipped.y + clipped.h - 1) / CANVAS_TILE_SIZE;
+
+	range = { first_x, first_y, last_x - first_x + 1, last_y - first_y + 1 };
+
+	return true;
+}
+
+void TiledCanvas::Invalidate(const int& tile_x, const int& tile_y)
+{
+	for (int level = 1; level < (int)this->levels.size(); ++level)
+	{
+		Level& mip = this->levels[level];
+
+		mip.stale[(size_t)(tile_y >> level) * mip.tiles_x + (tile_x >> level)] = 1;
+	}
+
+	this->changed[(size_t)tile_y * this->levels[0].tiles_x + tile_x] = 1;
+
+	/* Whole tiles are reported, a mip pixel never straddles two of them */
+	SDL_Rect tile_rect = this->GetTileRect(0, tile_x, tile_y);
+
+	if (SDL_RectEmpty(&this->damage))
+	{
+		this->damage = tile_rect;
+	}
+	else
+	{
+		SDL_UnionRect(&this->damage, &tile_rect, &this->damage);
+	}
+}
+
+void TiledCanvas::InvalidateAll()
+{
+	for (int level = 1; level < (int)this->levels.size(); ++level)
+	{
+		std::fill(this->levels[level].stale.begin(), this->levels[level].stale.end(), 1);
+	}
+
+	this->damage = { 0, 0, this->width, this->height };
+	std::fill(this->changed.begin(), this->changed.end(), 1);
+}
+
+void TiledCanvas::BuildMipTile(const int& level, const int& tile_x, const int& tile_y)
+{
+	Level& mip = this->levels[level];
+	Level& children = this->levels[level - 1];
+
+	/* Every child tile maps to one quadrant of the mip tile */
+	const Tile* quadrants[4] = { nullptr, nullptr, nullptr, nullptr };
+	bool any = false;
+
+	for (int quadrant = 0; quadrant < 4; ++quadrant)
+	{
+		int child_x = tile_x * 2 + (quadrant & 1);
+		int child_y = tile_y * 2 + (quadrant >> 1);
+
+		if (child_x >= children.tiles_x || child_y >= children.tiles_y)
+			continue;
+
+		size_t child_index = (size_t)child_y * children.tiles_x + child_x;
+
+		if (level > 1 && children.stale[child_index])
+		{
+			this->BuildMipTile(level - 1, child_x, child_y);
+		}
+
+		quadrants[quadrant] = children.tiles[child_index].get();
+		any = any || quadrants[quadrant] != nullptr;
+	}
+
+	size_t index = (size_t)tile_y * mip.tiles_x + tile_x;
+	mip.stale[index] = 0;
+
+	if (!any)
+	{
+		this->ReleaseTile(level, tile_x, tile_y);
+		return;
+	}
+
+	Tile* tile = mip.tiles[index].get();
+
+	if (tile == nullptr)
+	{
+		tile = this->AllocateTile(level, tile_x, tile_y);
+	}
+	else
+	{
+		std::fill(tile->pixels->begin(), tile->pixels->end(), this->background);
+	}
+
+	for (int quadrant = 0; quadrant < 4; ++quadrant)
+	{
+		if (quadrants[quadrant] == nullptr)
+			continue;
+
+		int child_x = tile_x * 2 + (quadrant & 1);
+		int child_y = tile_y * 2 + (quadrant >> 1);
+
+		this->DownsampleQuadrant(
+			*quadrants[quadrant],
+			this->GetTileRect(level - 1, child_x, child_y),
+			*tile,
+			(quadrant & 1) * CANVAS_TILE_SIZE / 2,
+			(quadrant >> 1) * CANVAS_TILE_SIZE / 2
+		);
+	}
+
+	tile->dirty = true;
+}
+
+void TiledCanvas::DownsampleQuadrant(const Tile& source, const SDL_Rect& source_rect, Tile& destination, const int& offset_x, const int& offset_y) const
+{
+	/* 2x2 box filter, the last row and column are repeated when the source size is odd */
+	int output_width = (source_rect.w + 1) / 2;
+	int output_height = (source_rect.h + 1) / 2;
+	int paired_width = source_rect.w / 2;
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rounding = _mm_set1_epi16(2);
+
+	for (int y = 0; y < output_height; ++y)
+	{
+		const Uint32* row0 = source.pixels->data() + (size_t)(2 * y) * CANVAS_TILE_SIZE;
+		const Uint32* row1 = source.pixels->data() + (size_t)SDL_min(2 * y + 1, source_rect.h - 1) * CANVAS_TILE_SIZE;
+		Uint32* output = destination.pixels->data() + (size_t)(offset_y + y) * CANVAS_TILE_SIZE + offset_x;
+
+		int x = 0;
+
+		for (; x + 4 <= paired_width; x += 4)
+		{
+			__m128i a0 = _mm_loadu_si128((const __m128i*)(row0 + 2 * x));
+			__m128i a1 = _mm_loadu_si128((const __m128i*)(row0 + 2 * x + 4));
+			__m128i b0 = _mm_loadu_si128((const __m128i*)(row1 + 2 * x));
+			__m128i b1 = _mm_loadu_si128((const __m128i*)(row1 + 2 * x + 4));
+
+			/* Vertical sums in 16 bits, two pixels per register */
+			__m128i p01 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+			__m128i p23 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+			__m128i p45 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+			__m128i p67 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+			__m128i q01 = _mm_add_epi16(_mm_unpacklo_epi64(p01, p23), _mm_unpackhi_epi64(p01, p23));
+			__m128i q23 = _mm_add_epi16(_mm_unpacklo_epi64(p45, p67), _mm_unpackhi_epi64(p45, p67));
+
+			q01 = _mm_srli_epi16(_mm_add_epi16(q01, rounding), 2);
+			q23 = _mm_srli_epi16(_mm_add_epi16(q23, rounding), 2);
+
+			_mm_storeu_si128((__m128i*)(output + x), _mm_packus_epi16(q01, q23));
+		}
+
+		for (; x < output_width; ++x)
+		{
+			int x0 = 2 * x;
+			int x1 = SDL_min(2 * x + 1, source_rect.w - 1);
+
+			Uint32 a = row0[x0], b = row0[x1], c = row1[x0], d = row1[x1];
+
+			Uint32 low = ((a & 0x00FF00FF) + (b & 0x00FF00FF) + (c & 0x00FF00FF) + (d & 0x00FF00FF) + 0x00020002) >> 2;
+			Uint32 high = (((a >> 8) & 0x00FF00FF) + ((b >> 8) & 0x00FF00FF) + ((c >> 8) & 0x00FF00FF) + ((d >> 8) & 0x00FF00FF) + 0x00020002) >> 2;
+
+			output[x] = (low & 0x00FF00FF) | ((high & 0x00FF00FF) << 8);
+		}
+	}
+}
+
+std::shared_ptr<CanvasState> TiledCanvas::Snapshot(const bool& original) const
+{
+	std::shared_ptr<CanvasState> state = std::make_shared<CanvasState>();
+
+	state->width = this->width;
+	state->height = this->height;
+	state->background = original ? this->original_background : this->background;
+
+	if (this->levels.empty())
+		return state;
+
+	const Level& base = this->levels[0];
+	state->tiles.resize(base.tiles.size());
+
+	for (size_t i = 0; i < base.tiles.size(); ++i)
+	{
+		if (original && this->edited[i])
+		{
+			state->tiles[i] = this->originals[i];
+		}
+		else if (base.tiles[i])
+		{
+			state->tiles[i] = base.tiles[i]->pixels;
+		}
+	}
+
+	return state;
+}
+
+void TiledCanvas::Restore(const CanvasState& state)
+{
+	this->Clear();
+
+	this->background = state.background;
+	this->Build(state.width, state.height);
+
+	for (int i = 0; i < (int)state.tiles.size() && i < (int)this->levels[0].tiles.size(); ++i)
+	{
+		if (state.tiles[i])
+		{
+			this->SetTilePixels(i % this->levels[0].tiles_x, i / this->levels[0].tiles_x, state.tiles[i]);
+		}
+	}
+
+	this->InvalidateAll();
+}
+
+void TiledCanvas::UploadTile(Tile& tile, const int& access)
+{
+	if (tile.texture == nullptr)
+	{
+		tile.texture = SDL_CreateTexture(App->renderer->renderer, App->renderer->texture_format, access, CANVAS_TILE_SIZE, CANVAS_TILE_SIZE);
+
+		if (tile.texture == nullptr)
+		{
+			printf("Canvas tile texture can't be created. SDL_GetError: %s\n", SDL_GetError());
+			return;
+		}
+
+		++this->texture_count;
+		tile.dirty = true;
+	}
+
+	if (tile.dirty)
+	{
+		SDL_UpdateTexture(tile.texture, nullptr, tile.pixels->data(), CANVAS_TILE_SIZE * sizeof(Uint32));
+		tile.dirty = false;
+	}
+}
+
+void TiledCanvas::EvictTextures()
+{
+	if (this->texture_count <= CANVAS_TEXTURE_BUDGET)
+		return;
+
+	/* Only textures that were not shown last frame go, the CPU copy stays */
+	for (Level& level : this->levels)
+	{
+		for (std::unique_ptr<Tile>& tile : level.tiles)
+		{
+			if (this->texture_count <= CANVAS_TEXTURE_BUDGET)
+				return;
+
+			if (tile && tile->texture && tile->last_frame + 1 < this->frame)
+			{
+				SDL_DestroyTexture(tile->texture);
+
+				tile->texture = nullptr;
+				tile->dirty = true;
+
+				--this->texture_count;
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,168 @@
+#ifndef __TILED_CANVAS_H__
+#define __TILED_CANVAS_H__
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "SDL.h"
+
+#include "SpanRasterizer.h"
+
+#define CANVAS_TILE_SIZE 256
+#define CANVAS_TEXTURE_BUDGET 512
+
+struct SDL_Texture;
+
+/* Receives the canvas position of the tile's top-left pixel, so canvas coordinates minus the origin land inside the tile */
+typedef std::function<void(const int& origin_x, const int& origin_y)> CanvasDrawFunction;
+/* Must only depend on the pixel values, it also runs on the single background pixel */
+typedef std::function<void(Uint32* pixels, const int& count)> CanvasPixelFunction;
+/* Tile pixels are shared with the history and copied before the first write, null is a tile showing the background */
+typedef std::shared_ptr<std::vector<Uint32>> TilePixels;
+
+struct CanvasState
+{
+	int width;
+	int height;
+	Uint32 background;
+	std::vector<TilePixels> tiles;
+};
+
+/* Everything written to a canvas between two TakeChange calls */
+struct CanvasChange
+{
+	std::vector<int> tiles;
+	std::vector<TilePixels> before;
+	std::vector<TilePixels> after;
+
+	Uint32 background_before;
+	Uint32 background_after;
+
+	/* Set when the canvas was resized, the whole states replace the tile lists then */
+	std::shared_ptr<CanvasState> resized_from;
+	std::shared_ptr<CanvasState> resized_to;
+};
+
+/* The CPU tiles are authoritative. Tiles equal to the background are never stored and every tile gets its own texture when it is shown */
+class TiledCanvas
+{
+public:
+	TiledCanvas();
+	~TiledCanvas();
+
+	void Resize(const int& width, const int& height, const Uint32& background);
+	void Clear();
+
+	/* Regions are clipped to the canvas, pixels outside it are left untouched */
+	void ReadRegion(Uint32* pixels, const int& stride, const SDL_Rect& region) const;
+	void WriteRegion(const Uint32* pixels, const int& stride, const SDL_Rect& region);
+
+	void TransformPixels(const CanvasPixelFunction& function);
+
+	/* Runs draw once per tile touched by bounds with that tile's texture as render target, then reads the tiles back */
+	void Draw(const SDL_Rect& bounds, const CanvasDrawFunction& draw);
+
+	/* Overwrites the spans with color straight in the CPU tiles, only the touched tiles are uploaded again */
+	void FillSpans(const std::vector<Span>& spans, const Uint32& color);
+
+	/* Source-over blends color into the region, the mask scales its alpha. Masks are row-major with the given stride */
+	void BlendMask(const Uint8* mask, const int& stride, const SDL_Rect& region, const Uint32& color);
+
+	/* Destination is where the whole canvas lands on screen, its size sets the zoom. Minified views draw from the mip level closest above the zoom. Only tiles inside clip are drawn */
+	void Render(const SDL_Rect& destination, const SDL_Rect& clip);
+	void ReleaseTextures();
+
+	/* Canvas area changed since the last call, in whole tiles */
+	bool TakeDamage(SDL_Rect& region);
+	/* Ors the tiles changed since the last call into changed, one flag per tile, and clears them */
+	void CollectChangedTiles(std::vector<Uint8>& changed);
+
+	/* Hands out the tiles written since the last call with their old and new pixels, no pixels are copied. False when nothing changed */
+	bool TakeChange(CanvasChange& change);
+	/* Puts back the old pixels of a change, or the new ones when redoing. Only the tiles in it are touched */
+	void ApplyChange(const CanvasChange& change, const bool& undo);
+	/* Forgets what was written since the last TakeChange */
+	void DiscardChange();
+	/* Canvases without history, like a cache, keep no old pixels at all */
+	void SetHistoryEnabled(const bool& enabled);
+
+	/* Pixels of a stored tile, row stride CANVAS_TILE_SIZE. Null when the tile shows the background */
+	const Uint32* GetTile(const int& tile_x, const int& tile_y) const;
+	/* Tiles that are not stored show the new background from now on */
+	void SetBackground(const Uint32& background);
+
+	int GetWidth() const;
+	int GetHeight() const;
+	Uint32 GetBackground() const;
+	size_t GetAllocatedTiles() const;
+	int GetTilesX() const;
+	int GetTilesY() const;
+
+private:
+	struct Tile
+	{
+		TilePixels pixels;
+		SDL_Texture* texture;
+		Uint64 last_frame;
+		bool dirty;
+	};
+
+	/* Level 0 is the image. Every other level halves the previous one and is rebuilt lazily, tile by tile, when it is shown */
+	struct Level
+	{
+		std::vector<std::unique_ptr<Tile>> tiles;
+		std::vector<Uint8> stale;
+
+		int width;
+		int height;
+		int tiles_x;
+		int tiles_y;
+	};
+
+	void Build(const int& width, const int& height);
+	Tile* AllocateTile(const int& level, const int& tile_x, const int& tile_y);
+	/* Writable base tile, records its old pixels for the history and unshares them */
+	Tile* EditTile(const int& tile_x, const int& tile_y);
+	void SetTilePixels(const int& tile_x, const int& tile_y, const TilePixels& pixels);
+	void ReleaseTile(const int& level, const int& tile_x, const int& tile_y);
+	bool IsBackground(const Tile& tile, const SDL_Rect& rect) const;
+	SDL_Rect GetTileRect(const int& level, const int& tile_x, const int& tile_y) const;
+	bool GetTileRange(const int& level, const SDL_Rect& region, SDL_Rect& clipped, SDL_Rect& range) const;
+
+	/* Marks the mips above a changed tile stale and adds it to the damage */
+	void Invalidate(const int& tile_x, const int& tile_y);
+	void InvalidateAll();
+	void BuildMipTile(const int& level, const int& tile_x, const int& tile_y);
+	void DownsampleQuadrant(const Tile& source, const SDL_Rect& source_rect, Tile& destination, const int& offset_x, const int& offset_y) const;
+
+	/* The state as of the last TakeChange when original is set, otherwise as it is now */
+	std::shared_ptr<CanvasState> Snapshot(const bool& original) const;
+	void Restore(const CanvasState& state);
+
+	void UploadTile(Tile& tile, const int& access);
+	void EvictTextures();
+
+private:
+	std::vector<Level> levels;
+
+	int width;
+	int height;
+
+	Uint32 background;
+	SDL_Rect damage;
+	std::vector<Uint8> changed;
+
+	/* Pixels of every tile before its first write since the last TakeChange */
+	std::vector<TilePixels> originals;
+	std::vector<Uint8> edited;
+	std::shared_ptr<CanvasState> resized_from;
+	Uint32 original_background;
+	bool pending;
+	bool history_enabled;
+
+	Uint64 frame;
+	int texture_count;
+};
+
+#endif /* __TILED_CANVAS_H__ */
\ No newline at end of file
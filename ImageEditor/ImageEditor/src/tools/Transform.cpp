@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <emmintrin.h>
+
+#include "modules/Editor.h"
+#include "Application.h"
+#include "Transform.h"
+
+#define TRANSPOSE_TILE_SIZE 64
+
+void Transform::ApplyTransform(const TRANSFORM_TYPE& type)
+{
+	std::vector<Uint32> pixels;
+	int width, height;
+
+	App->editor->ReadCanvasPixels(pixels, width, height);
+
+	switch (type)
+	{
+		case TRANSFORM_TYPE::ROTATE_90:
+		{
+			std::vector<Uint32> rotated(pixels.size());
+
+			Transform::Transpose(
+				pixels.data() + (ptrdiff_t)(height - 1) * width, -(ptrdiff_t)width,
+				rotated.data(), height,
+				width, height
+			);
+
+			App->editor->WriteCanvasPixels(rotated, height, width);
+
+			break;
+		}
+		case TRANSFORM_TYPE::ROTATE_180:
+		{
+			Transform::FlipHorizontal(pixels.data(), width, height);
+			Transform::FlipVertical(pixels.data(), width, height);
+
+			App->editor->WriteCanvasPixels(pixels, width, height);
+
+			break;
+		}
+		case TRANSFORM_TYPE::ROTATE_270:
+		{
+			std::vector<Uint32> rotated(pixels.size());
+
+			Transform::Transpose(
+				pixels.data(), width,
+				rotated.data() + (ptrdiff_t)(width - 1) * height, -(ptrdiff_t)height,
+				width, height
+			);
+
+			App->editor->WriteCanvasPixels(rotated, height, width);
+
+			break;
+		}
+		case TRANSFORM_TYPE::FLIP_HORIZONTAL:
+		{
+			Transform::FlipHorizontal(pixels.data(), width, height);
+
+			App->editor->WriteCanvasPixels(pixels, width, height);
+
+			break;
+		}
+		case TRANSFORM_TYPE::FLIP_VERTICAL:
+		{
+			Transform::FlipVertical(pixels.data(), width, height);
+
+			App->editor->WriteCanvasPixels(pixels, width, height);
+
+			break;
+		}
+		case TRANSFORM_TYPE::TRANSPOSE:
+		{
+			std::vector<Uint32> transposed(pixels.size());
+
+			Transform::Transpose(pixels.data(), width, transposed.data(), height, width, height);
+
+			App->editor->WriteCanvasPixels(transposed, height, width);
+
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
+}
+
+void Transform::Transpose(const Uint32* src, const ptrdiff_t& src_stride, Uint32* dst, const ptrdiff_t& dst_stride, const int& width, const int& height)
+{
+	for (int tile_row = 0; tile_row < height; tile_row += TRANSPOSE_TILE_SIZE)
+	{
+		int tile_height = SDL_min(TRANSPOSE_TILE_SIZE, height - tile_row);
+
+		for (int tile_col = 0; tile_col < width; tile_col += TRANSPOSE_TILE_SIZE)
+		{
+			int tile_width = SDL_min(TRANSPOSE_TILE_SIZE, width - tile_col);
+
+			int block_rows = tile_height & ~7;
+			int block_cols = tile_width & ~7;
+
+			for (int row = 0; row < block_rows; row += 8)
+			{
+				for (int col = 0; col < block_cols; col += 8)
+				{
+					Transform::TransposeBlock8x8(
+						src + (tile_row + row) * src_stride + (tile_col + col), src_stride,
+						dst + (tile_col + col) * dst_stride + (tile_row + row), dst_stride
+					);
+				}
+			}
+
+			for (int row = 0; row < tile_height; ++row)
+			{
+				const Uint32* src_row = src + (tile_row + row) * src_stride + tile_col;
+				int first_col = row < block_rows ? block_cols : 0;
+
+				for (int col = first_col; col < tile_width; ++col)
+				{
+					dst[(tile_col + col) * dst_stride + (tile_row + row)] = src_row[col];
+				}
+			}
+		}
+	}
+}
+
+void Transform::Transpose(const float* src, const ptrdiff_t& src_stride, float* dst, const ptrdiff_t& dst_stride, const int& width, const int& height)
+{
+	static_assert(sizeof(float) == sizeof(Uint32), "Transpose kernel moves 32-bit lanes");
+
+	Transform::Transpose((const Uint32*)src, src_stride, (Uint32*)dst, dst_stride, width, height);
+}
+
+void Transform::FlipHorizontal(Uint32* pixels, const int& width, const int& height)
+{
+	for (int row = 0; row < height; ++row)
+	{
+		Transform::ReverseRow(pixels + (ptrdiff_t)row * width, width);
+	}
+}
+
+void Transform::FlipVertical(Uint32* pixels, const int& width, const int& height)
+{
+	std::vector<Uint32> swap_row(width);
+
+	for (int row = 0; row < height / 2; ++row)
+	{
+		Uint32* top = pixels + (ptrdiff_t)row * width;
+		Uint32* bottom = pixels + (ptrdiff_t)(height - 1 - row) * width;
+
+		memcpy(swap_row.data(), top, width * sizeof(Uint32));
+		memcpy(top, bottom, width * sizeof(Uint32));
+		memcpy(bottom, swap_row.data(), width * sizeof(Uint32));
+	}
+}
+
+void Transform::TransposeBlock8x8(const Uint32* src, const ptrdiff_t& src_stride, Uint32* dst, const ptrdiff_t& dst_stride)
+{
+	for (int block_row = 0; block_row < 8; block_row += 4)
+	{
+		for (int block_col = 0; block_col < 8; block_col += 4)
+		{
+			const Uint32* s = src + block_row * src_stride + block_col;
+			Uint32* d = dst + block_col * dst_stride + block_row;
+
+			__m128i r0 = _mm_loadu_si128((const __m128i*)(s));
+			__m128i r1 = _mm_loadu_si128((const __m128i*)(s + src_stride));
+			__m128i r2 = _mm_loadu_si128((const __m128i*)(s + 2 * src_stride));
+			__m128i r3 = _mm_loadu_si128((const __m128i*)(s + 3 * src_stride));
+
+			__m128i t0 = _mm_unpacklo_epi32(r0, r1);
+			__m128i t1 = _mm_unpacklo_epi32(r2, r3);
+			__m128i t2 = _mm_unpackhi_epi32(r0, r1);
+			__m128i t3 = _mm_unpackhi_epi32(r2, r3);
+
+			_mm_storeu_si128((__m128i*)(d), _mm_unpacklo_epi64(t0, t1));
+			_mm_storeu_si128((__m128i*)(d + dst_stride), _mm_unpackhi_epi64(t0, t1));
+			_mm_storeu_si128((__m128i*)(d + 2 * dst_stride), _mm_unpacklo_epi64(t2, t3));
+			_mm_storeu_si128((__m128i*)(d + 3 * dst_stride), _mm_unpackhi_epi64(t2, t3));
+		}
+	}
+}
+
+void Transform::ReverseRow(Uint32* row, const int& width)
+{
+	int left = 0;
+	int right = width - 4;
+
+	for (; left + 4 <= right; left += 4, right -= 4)
+	{
+		__m128i l = _mm_loadu_si128((const __m128i*)(row + left));
+		__m128i r = _mm_loadu_si128((const __m128i*)(row + right));
+
+		_mm_storeu_si128((__m128i*)(row + left), _mm_shuffle_epi32(r, _MM_SHUFFLE(0, 1, 2, 3)));
+		_mm_storeu_si128((__m128i*)(row + right), _mm_shuffle_epi32(l, _MM_SHUFFLE(0, 1, 2, 3)));
+	}
+
+	std::reverse(row + left, row + right + 4);
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef __TRANSFORM_H__
+#define __TRANSFORM_H__
+
+#include <cstddef>
+
+#include "SDL.h"
+
+enum class TRANSFORM_TYPE
+{
+	ROTATE_90 = 0,
+	ROTATE_180,
+	ROTATE_270,
+	FLIP_HORIZONTAL,
+	FLIP_VERTICAL,
+	TRANSPOSE
+};
+
+class Transform
+{
+public:
+	static void ApplyTransform(const TRANSFORM_TYPE& type);
+
+	/* Strides are expressed in elements and may be negative to walk rows backwards */
+	static void Transpose(const Uint32* src, const ptrdiff_t& src_stride, Uint32* dst, const ptrdiff_t& dst_stride, const int& width, const int& height);
+	static void Transpose(const float* src, const ptrdiff_t& src_stride, float* dst, const ptrdiff_t& dst_stride, const int& width, const int& height);
+
+	static void FlipHorizontal(Uint32* pixels, const int& width, const int& height);
+	static void FlipVertical(Uint32* pixels, const int& width, const int& height);
+
+private:
+	static void TransposeBlock8x8(const Uint32* src, const ptrdiff_t& src_stride, Uint32* dst, const ptrdiff_t& dst_stride);
+	static void ReverseRow(Uint32* row, const int& width);
+};
+
+#endif /* __TRANSFORM_H__ */
\ No newline at end of file
@@ -0,0 +1,169 @@
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Helper threads started once and shared by every ParallelFor, so frequent small jobs don't pay thread creation */
+class ThreadPool
+{
+public:
+	static ThreadPool& Get()
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->stop = true;
+		}
+
+		this->wake.notify_all();
+
+		for (std::thread& thread : this->threads)
+		{
+			thread.join();
+		}
+	}
+
+	/* Helpers plus the calling thread */
+	int GetThreadCount() const
+	{
+		return (int)this->threads.size() + 1;
+	}
+
+	/* Runs task on up to helpers pool threads and on the calling thread, returns once every copy has finished.
+	   Returns false without running anything when the pool is already in use, e.g. by a nested call */
+	bool Run(const std::function<void()>& task, const int& helpers)
+	{
+		bool expected = false;
+		if (!this->busy.compare_exchange_strong(expected, true))
+			return false;
+
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+
+			this->task = &task;
+			this->slots = std::min(helpers, (int)this->threads.size());
+			this->running = this->slots;
+			++this->generation;
+		}
+
+		this->wake.notify_all();
+
+		task();
+
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+
+			this->done.wait(lock, [&]() { return this->running == 0; });
+			this->task = nullptr;
+		}
+
+		this->busy = false;
+
+		return true;
+	}
+
+private:
+	ThreadPool()
+	{
+		int count = (int)std::max(std::thread::hardware_concurrency(), 1u) - 1;
+
+		for (int i = 0; i < count; ++i)
+		{
+			this->threads.emplace_back(&ThreadPool::Work, this);
+		}
+	}
+
+	void Work()
+	{
+		size_t seen = 0;
+		std::unique_lock<std::mutex> lock(this->mutex);
+
+		while (true)
+		{
+			this->wake.wait(lock, [&]() { return this->stop || this->generation != seen; });
+
+			if (this->stop)
+				return;
+
+			seen = this->generation;
+
+			if (this->slots == 0)
+				continue;
+
+			--this->slots;
+
+			const std::function<void()>* current = this->task;
+
+			lock.unlock();
+			(*current)();
+			lock.lock();
+
+			if (--this->running == 0)
+			{
+				this->done.notify_one();
+			}
+		}
+	}
+
+private:
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	std::atomic<bool> busy = { false };
+
+	const std::function<void()>* task = nullptr;
+	size_t generation = 0;
+	int slots = 0;
+	int running = 0;
+	bool stop = false;
+};
+
+/* Splits [begin, end) in chunks of grain elements and calls function(first, last) on every chunk from the shared thread pool.
+   A single chunk, or a call made while the pool is busy, runs on the calling thread */
+template<typename Function>
+void ParallelFor(const int& begin, const int& end, const int& grain, const Function& function)
+{
+	int count = end - begin;
+	if (count <= 0)
+		return;
+
+	int chunk_size = std::max(grain, 1);
+	int chunk_count = (count + chunk_size - 1) / chunk_size;
+	int thread_count = std::min(ThreadPool::Get().GetThreadCount(), chunk_count);
+
+	if (thread_count <= 1)
+	{
+		function(begin, end);
+		return;
+	}
+
+	std::atomic<int> next_chunk(0);
+
+	std::function<void()> worker = [&]()
+	{
+		for (int chunk = next_chunk++; chunk < chunk_count; chunk = next_chunk++)
+		{
+			int first = begin + chunk * chunk_size;
+			function(first, std::min(first + chunk_size, end));
+		}
+	};
+
+	if (!ThreadPool::Get().Run(worker, thread_count - 1))
+	{
+		worker();
+	}
+}
+
+#endif /* __PARALLEL_H__ */
\ No newline at end of file